@@ -0,0 +1,386 @@
+#include <benchmark/benchmark.h>
+#include "json_parser/json.hpp"
+#include "json_parser/parser_context.hpp"
+#include "json_parser/path.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+    the standard corpus, through the operations every perf change touches:
+        BM_Corpus_{Parse, ParseContext, Dump, Dump2, Copy, Lookup}/{twitter, canada, citm_catalog, deep_nesting, numbers, rpc_message}
+    - twitter, canada and citm_catalog are the well known files (search results with lots of unicode and
+      escapes / GeoJSON, almost all doubles / numeric ids and objects with hundreds of members). they are
+      not in the repo: with JSON_BENCH_CORPUS=<dir> the real <dir>/<name>.json is used, otherwise a
+      generated document of the same shape, about the size of the original without its whitespace
+    - deep_nesting is 500 values nested 128 deep, numbers one flat array of ints and doubles,
+      rpc_message one ~300 byte request - the small message path, where per parse setup dominates
+    - ParseContext parses with one json::ParserContext reused across the iterations
+    - MB/s is against the size of the JSON text for every operation (dump included), so the rows of a
+      document compare directly. allocs_per_doc counts every operator new on the benchmark thread -
+      pmr nodes from the default resource and the parser's scratch buffers alike
+    - the generators are seeded, the documents are the same on every run
+*/
+
+// allocation counting -----------------------------------------------------
+namespace {
+thread_local std::size_t t_allocations = 0;
+}
+
+/*
+    replaces the global operator new for the whole json_bench binary, a thread_local increment per
+    allocation. the aligned forms too: std::pmr::new_delete_resource() (the default resource, so every
+    JsonValue node) allocates through them
+*/
+void* operator new(std::size_t size) {
+    ++t_allocations;
+    if(void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    ++t_allocations;
+    auto align = static_cast<std::size_t>(alignment);
+    //aligned_alloc wants a non zero multiple of the alignment
+    std::size_t rounded = size ? (size + align - 1) / align * align : align;
+    if(void* p = std::aligned_alloc(align, rounded)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete(void* p, std::size_t) noexcept {std::free(p);}
+void operator delete(void* p, std::align_val_t) noexcept {std::free(p);}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {std::free(p);}
+
+namespace {
+
+// generators --------------------------------------------------------------
+std::string fixed(double d, int decimals) {
+    char buf[48];
+    int n = std::snprintf(buf, sizeof(buf), "%.*f", decimals, d);
+    return std::string(buf, static_cast<std::size_t>(n));
+}
+
+//search results: nested users / entities, japanese text (raw utf-8 and \u escapes), "\/" in urls, 64 bit ids
+std::string make_twitter() {
+    std::mt19937_64 rng(1);
+    const char* texts[] = {
+        "@aym0566x \\n\\n名前:前田あゆみ\\n第一印象:なんか怖っ！\\nほんとうに：めっちゃおもろい(^^)",
+        "RT @KATANA77: えっそれは・・・（一同） http:\\/\\/t.co\\/PkCJAcSuYK",
+        "\\u3010\\u7d76\\u5bfe\\u3084\\u3063\\u3066\\u306f\\u3044\\u3051\\u306a\\u3044\\u3011 #\\u30c4\\u30a4\\u30c3\\u30bf\\u30fc",
+        "\\\"quoted\\\" and a tab\\there, plus an emoji \\ud83d\\ude00 and some plain ascii text to round it off",
+    };
+    const char* names[] = {"前田あゆみ", "KATANA", "\\u30e6\\u30fc\\u30b6\\u30fc", "plain user name"};
+    auto user = [&](int i) {
+        std::uint64_t id = 1186275104 + static_cast<std::uint64_t>(i) * 104729;
+        std::string s = "{\"id\":" + std::to_string(id) + ",\"id_str\":\"" + std::to_string(id) + "\",";
+        s += "\"name\":\"" + std::string(names[i % 4]) + "\",\"screen_name\":\"user_" + std::to_string(i) + "\",";
+        s += R"("location":"埼玉県","description":"湯の街の美味しいものを紹介します。フォローお気軽にどうぞ ♪",)";
+        s += R"("url":null,"entities":{"description":{"urls":[]}},"protected":false,)";
+        s += "\"followers_count\":" + std::to_string(rng() % 100000) + ",\"friends_count\":" + std::to_string(rng() % 5000) + ",";
+        s += R"("listed_count":0,"created_at":"Fri Feb 24 16:33:25 +0000 2013",)";
+        s += "\"favourites_count\":" + std::to_string(rng() % 10000) + ",";
+        s += i % 3 ? R"("utc_offset":32400,"time_zone":"Tokyo",)" : R"("utc_offset":null,"time_zone":null,)";
+        s += R"("geo_enabled":false,"verified":false,"statuses_count":)" + std::to_string(rng() % 50000) + ",";
+        s += R"("lang":"ja","contributors_enabled":false,"is_translator":false,"is_translation_enabled":false,)"
+             R"("profile_background_color":"C0DEED","profile_background_image_url":"http:\/\/abs.twimg.com\/images\/themes\/theme1\/bg.png",)"
+             R"("profile_background_image_url_https":"https:\/\/abs.twimg.com\/images\/themes\/theme1\/bg.png","profile_background_tile":false,)"
+             R"("profile_image_url":"http:\/\/pbs.twimg.com\/profile_images\/497760886795153410\/LDjAwR_y_normal.jpeg",)"
+             R"("profile_link_color":"0084B4","profile_sidebar_border_color":"C0DEED","profile_sidebar_fill_color":"DDEEF6",)"
+             R"("profile_text_color":"333333","profile_use_background_image":true,"default_profile":true,)"
+             R"("default_profile_image":false,"following":false,"follow_request_sent":false,"notifications":false})";
+        return s;
+    };
+    auto status = [&](int i, bool retweet, auto& self) -> std::string {
+        std::uint64_t id = 505874924095815681ULL + static_cast<std::uint64_t>(i) * 7919;
+        std::string s = R"({"metadata":{"result_type":"recent","iso_language_code":"ja"},"created_at":"Sun Aug 31 00:29:15 +0000 2014",)";
+        s += "\"id\":" + std::to_string(id) + ",\"id_str\":\"" + std::to_string(id) + "\",";
+        s += "\"text\":\"" + std::string(texts[i % 4]) + "\",";
+        s += R"("source":"<a href=\"http:\/\/twitter.com\/download\/iphone\" rel=\"nofollow\">Twitter for iPhone<\/a>",)";
+        s += R"("truncated":false,"in_reply_to_status_id":null,"in_reply_to_status_id_str":null,"in_reply_to_user_id":null,)"
+             R"("in_reply_to_user_id_str":null,"in_reply_to_screen_name":null,"user":)" + user(i) + ",";
+        s += R"("geo":null,"coordinates":null,"place":null,"contributors":null,)";
+        if(retweet) s += "\"retweeted_status\":" + self(i + 1000, false, self) + ",";
+        s += "\"retweet_count\":" + std::to_string(rng() % 100) + ",\"favorite_count\":" + std::to_string(rng() % 100) + ",";
+        s += R"("entities":{"hashtags":[{"text":"ツイッター","indices":[12,18]}],"symbols":[],"urls":[],)"
+             R"("user_mentions":[{"screen_name":"aym0566x","name":"前田あゆみ","id":866260188,"id_str":"866260188","indices":[0,9]}]},)";
+        s += R"("favorited":false,"retweeted":false,"lang":"ja"})";
+        return s;
+    };
+    std::string out = R"({"statuses":[)";
+    for(int i = 0; i < 160; ++i) {
+        if(i) out += ',';
+        out += status(i, i % 3 == 0, status);
+    }
+    out += R"(],"search_metadata":{"completed_in":0.087,"max_id":505874924095815681,"max_id_str":"505874924095815681",)"
+           R"("next_results":"?max_id=505874847260352512&q=%E4%B8%80&count=100&include_entities=1","query":"%E4%B8%80",)"
+           R"("refresh_url":"?since_id=505874924095815681&q=%E4%B8%80&include_entities=1","count":100,"since_id":0,"since_id_str":"0"}})";
+    return out;
+}
+
+//one GeoJSON polygon, rings of coordinate pairs printed with 15 decimals like the original
+std::string make_canada() {
+    std::mt19937_64 rng(2);
+    std::uniform_real_distribution<double> step(-0.05, 0.05);
+    std::uniform_int_distribution<int> ring_size(16, 220);
+    std::string out = R"({"type":"FeatureCollection","features":[{"type":"Feature","properties":{"name":"Canada"},)"
+                      R"("geometry":{"type":"Polygon","coordinates":[)";
+    double lon = -65.613616999999977, lat = 43.420273000000009;
+    for(int r = 0; r < 480; ++r) {
+        if(r) out += ',';
+        out += '[';
+        int n = ring_size(rng);
+        for(int i = 0; i < n; ++i) {
+            lon += step(rng);
+            lat += step(rng);
+            if(i) out += ',';
+            out += '[' + fixed(lon, 15) + ',' + fixed(lat, 15) + ']';
+        }
+        out += ']';
+    }
+    out += "]}}]}";
+    return out;
+}
+
+//ticketing catalog: maps keyed by numeric ids (hundreds of members, the hashed lookup path), int arrays, nulls
+std::string make_citm() {
+    std::mt19937 rng(3);
+    auto id_map = [&](const char* key, int count, std::uint32_t base, const char* prefix) {
+        std::string s = std::string("\"") + key + "\":{";
+        for(int i = 0; i < count; ++i) {
+            if(i) s += ',';
+            s += '"' + std::to_string(base + static_cast<std::uint32_t>(i) * 7) + "\":\"" + prefix + ' ' + std::to_string(i) + '"';
+        }
+        return s + '}';
+    };
+    std::string out = "{";
+    out += id_map("areaNames", 17, 205705993, "Arrière-scène central") + ',';
+    out += id_map("audienceSubCategoryNames", 1, 337100890, "Abonné") + ',';
+    out += R"("blockNames":{},"events":{)";
+    for(int i = 0; i < 184; ++i) {
+        std::uint32_t id = 138586341 + static_cast<std::uint32_t>(i) * 1000;
+        if(i) out += ',';
+        out += '"' + std::to_string(id) + R"(":{"description":null,"id":)" + std::to_string(id) + ",";
+        out += i % 2 ? R"("logo":"\/images\/UE0AAAAACEKo6QAAAAZDSVRN",)" : R"("logo":null,)";
+        out += R"("name":"Orchestre Philharmonique de Radio France )" + std::to_string(i) + R"(","subTopicIds":[337184269,337184283],)";
+        out += R"("subjectCode":null,"subtitle":null,"topicIds":[324846099,107888604]})";
+    }
+    out += R"(},"performances":[)";
+    for(int i = 0; i < 370; ++i) {
+        if(i) out += ',';
+        out += "{\"eventId\":" + std::to_string(138586341 + (i % 184) * 1000) + ",\"id\":" + std::to_string(339887544 + i * 13);
+        out += R"(,"logo":null,"name":null,"prices":[)";
+        int prices = 1 + static_cast<int>(rng() % 6);
+        for(int p = 0; p < prices; ++p) {
+            if(p) out += ',';
+            out += "{\"amount\":" + std::to_string(9000 + rng() % 90000) + R"(,"audienceSubCategoryId":337100890,"seatCategoryId":)" +
+                   std::to_string(338937295 + p) + '}';
+        }
+        out += R"(],"seatCategories":[)";
+        for(int c = 0; c < prices; ++c) {
+            if(c) out += ',';
+            out += R"({"areas":[)";
+            int areas = 1 + static_cast<int>(rng() % 10);
+            for(int a = 0; a < areas; ++a) {
+                if(a) out += ',';
+                out += "{\"areaId\":" + std::to_string(205705993 + a * 7) + ",\"blockIds\":[]}";
+            }
+            out += "],\"seatCategoryId\":" + std::to_string(338937295 + c) + '}';
+        }
+        out += R"(],"seatMapImage":null,"start":)" + std::to_string(1372701600000ULL + static_cast<std::uint64_t>(i) * 86400000ULL);
+        out += R"(,"venueCode":"PLEYEL_PLEYEL"})";
+    }
+    out += "],";
+    out += id_map("seatCategoryNames", 64, 338937235, "1ère catégorie") + ',';
+    out += id_map("subTopicNames", 19, 337184262, "Musique classique") + ',';
+    out += R"("subjectNames":{},)";
+    out += id_map("topicNames", 4, 107888604, "Genre") + ',';
+    out += R"("topicSubTopics":{"107888604":[337184283,337184263],"324846099":[337184269,337184273,337184277]},)";
+    out += R"("venueNames":{"PLEYEL_PLEYEL":"Salle Pleyel"}})";
+    return out;
+}
+
+//the level below an object is its one member "n", below an array its element 0
+constexpr int kNestingDepth = 128;
+
+std::string make_deep_nesting() {
+    std::string element;
+    for(int d = 0; d < kNestingDepth; ++d) element += d % 2 ? "[" : "{\"n\":";
+    element += "\"leaf\"";
+    for(int d = kNestingDepth - 1; d >= 0; --d) element += d % 2 ? "]" : "}";
+    std::string out = "[";
+    for(int i = 0; i < 500; ++i) {
+        if(i) out += ',';
+        out += element;
+    }
+    return out + "]";
+}
+
+std::string deep_nesting_path() {
+    std::string path = "/250";
+    for(int d = 0; d < kNestingDepth; ++d) path += d % 2 ? "/0" : "/n";
+    return path;
+}
+
+std::string make_numbers() {
+    std::mt19937_64 rng(5);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    std::string out = "[";
+    char buf[32];
+    for(int i = 0; i < 150'000; ++i) {
+        if(i) out += ',';
+        if(i % 3 == 0) {
+            out += std::to_string(static_cast<std::int64_t>(rng() % 2'000'000) - 1'000'000);
+        } else {
+            int n = std::snprintf(buf, sizeof(buf), "%.17g", real(rng));
+            out.append(buf, static_cast<std::size_t>(n));
+        }
+    }
+    return out + "]";
+}
+
+//a json-rpc style request, one of the millions a service parses
+std::string make_rpc_message() {
+    return R"({"jsonrpc":"2.0","id":184467,"method":"inventory.reserve_items","params":{"order_id":"ord-2024-000918273",)"
+           R"("customer":{"id":55012,"tier":"gold"},"items":[{"sku":"sku-100234-standard","quantity":2,"price":19.99},)"
+           R"({"sku":"sku-100871-express","quantity":1,"price":4.5}],"warehouse":"eu-central-1","dry_run":false}})";
+}
+
+// corpus --------------------------------------------------------------------
+struct Corpus {
+    const char* name;
+    std::string (*generate)();
+    std::string lookup;  //a JSON pointer that exists in the generated document (and in the real file)
+    benchmark::TimeUnit unit = benchmark::kMillisecond;
+};
+
+const std::vector<Corpus>& corpus_list() {
+    static const std::vector<Corpus> list = {
+        {"twitter", make_twitter, "/statuses/42/user/screen_name"},
+        {"canada", make_canada, "/features/0/geometry/coordinates/100/10/0"},
+        {"citm_catalog", make_citm, "/events/138586341/name"},
+        {"deep_nesting", make_deep_nesting, deep_nesting_path()},
+        {"numbers", make_numbers, "/1000"},
+        {"rpc_message", make_rpc_message, "/params/items/1/sku", benchmark::kMicrosecond},
+    };
+    return list;
+}
+
+std::string load_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if(!in) return {};
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+//generated (or read) on first use, so filtering the other benchmarks does not pay for it
+const std::string& corpus_text(std::size_t i) {
+    static std::vector<std::string> texts(corpus_list().size());
+    std::string& text = texts[i];
+    if(text.empty()) {
+        if(const char* dir = std::getenv("JSON_BENCH_CORPUS")) text = load_file(std::string(dir) + "/" + corpus_list()[i].name + ".json");
+        if(text.empty()) text = corpus_list()[i].generate();
+    }
+    return text;
+}
+
+// benchmarks ----------------------------------------------------------------
+class AllocationCounter {
+public:
+    explicit AllocationCounter(benchmark::State& state) : state_(state), start_(t_allocations) {}
+    ~AllocationCounter() {
+        double docs = static_cast<double>(state_.iterations());
+        state_.counters["allocs_per_doc"] = docs ? static_cast<double>(t_allocations - start_) / docs : 0;
+    }
+private:
+    benchmark::State& state_;
+    std::size_t start_;
+};
+
+void bytes_processed(benchmark::State& state, const std::string& text) {
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+}
+
+void corpus_parse(benchmark::State& state, std::size_t i) {
+    const std::string& text = corpus_text(i);
+    {
+        AllocationCounter counter(state);
+        for(auto _ : state) {
+            auto v = json::parse(text);
+            benchmark::DoNotOptimize(v);
+        }
+    }
+    bytes_processed(state, text);
+}
+
+void corpus_parse_context(benchmark::State& state, std::size_t i) {
+    const std::string& text = corpus_text(i);
+    json::ParserContext context;
+    (void)context.parse(text);  //warm up: the arena and the stacks grow to fit once
+    {
+        AllocationCounter counter(state);
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(context.parse(text));
+        }
+    }
+    bytes_processed(state, text);
+}
+
+void corpus_dump(benchmark::State& state, std::size_t i, int indent) {
+    const std::string& text = corpus_text(i);
+    const json::JsonValue v = json::parse(text);
+    {
+        AllocationCounter counter(state);
+        for(auto _ : state) {
+            auto out = v.dump(indent);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+    bytes_processed(state, text);
+}
+
+void corpus_copy(benchmark::State& state, std::size_t i) {
+    const std::string& text = corpus_text(i);
+    const json::JsonValue v = json::parse(text);
+    {
+        AllocationCounter counter(state);
+        for(auto _ : state) {
+            json::JsonValue copy = v;
+            benchmark::DoNotOptimize(copy);
+        }
+    }
+    bytes_processed(state, text);
+}
+
+void corpus_lookup(benchmark::State& state, std::size_t i) {
+    const json::JsonValue v = json::parse(corpus_text(i));
+    const json::Path path(corpus_list()[i].lookup);
+    if(!path.find(v)) {
+        state.SkipWithError("lookup path not in the document");
+        return;
+    }
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(path.find(v));
+    }
+}
+
+const int registered = [] {
+    for(std::size_t i = 0; i < corpus_list().size(); ++i) {
+        const std::string name = corpus_list()[i].name;
+        const benchmark::TimeUnit unit = corpus_list()[i].unit;
+        benchmark::RegisterBenchmark(("BM_Corpus_Parse/" + name).c_str(), corpus_parse, i)->Unit(unit);
+        benchmark::RegisterBenchmark(("BM_Corpus_ParseContext/" + name).c_str(), corpus_parse_context, i)->Unit(unit);
+        benchmark::RegisterBenchmark(("BM_Corpus_Dump/" + name).c_str(), corpus_dump, i, -1)->Unit(unit);
+        benchmark::RegisterBenchmark(("BM_Corpus_Dump2/" + name).c_str(), corpus_dump, i, 2)->Unit(unit);
+        benchmark::RegisterBenchmark(("BM_Corpus_Copy/" + name).c_str(), corpus_copy, i)->Unit(unit);
+        benchmark::RegisterBenchmark(("BM_Corpus_Lookup/" + name).c_str(), corpus_lookup, i);
+    }
+    return 0;
+}();
+
+}
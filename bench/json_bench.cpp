@@ -0,0 +1,912 @@
+#include <benchmark/benchmark.h>
+#include "json_parser/json.hpp"
+#include "json_parser/bind.hpp"
+#include "json_parser/builder.hpp"
+#include "json_parser/document.hpp"
+#include "json_parser/key_pool.hpp"
+#include "json_parser/ndjson.hpp"
+#include "json_parser/patch.hpp"
+#include "json_parser/path.hpp"
+#include "json_parser/sax.hpp"
+#include "json_parser/validate.hpp"
+#include "json_parser/writer.hpp"
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// number serialization ----------------------------------------------------------
+/*
+    note: 1M doubles with a full 17 significant digits (worst case for shortest round trip) plus
+    1M integers. the *_Ostringstream benchmarks reproduce the old dump_impl number branch
+    (a fresh std::ostringstream per value) so the difference can be read straight off the output.
+*/
+namespace {
+
+json::JsonValue make_double_array(std::size_t n) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    json::JsonArray arr;
+    arr.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) arr.emplace_back(dist(rng));
+    return json::JsonValue(std::move(arr));
+}
+
+json::JsonValue make_integer_array(std::size_t n) {
+    std::mt19937_64 rng(42);
+    json::JsonArray arr;
+    arr.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) arr.emplace_back(static_cast<std::int64_t>(rng() >> 1));
+    return json::JsonValue(std::move(arr));
+}
+
+//the number formatting dump_impl used before (stream per value, default 6 significant digits)
+std::string dump_with_ostringstream(const json::JsonValue& arr) {
+    std::string out = "[";
+    bool first = true;
+    for(const auto& item : arr.as_array()) {
+        if(!first) out += ',';
+        std::ostringstream oss;
+        oss << item.as_number();
+        out += oss.str();
+        first = false;
+    }
+    out += ']';
+    return out;
+}
+
+constexpr std::size_t kNumbers = 1'000'000;
+
+}
+
+static void BM_DumpDoubles(benchmark::State& state) {
+    auto arr = make_double_array(kNumbers);
+    std::size_t bytes = 0;
+    for(auto _ : state) {
+        auto out = arr.dump();
+        bytes += out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kNumbers));
+}
+BENCHMARK(BM_DumpDoubles)->Unit(benchmark::kMillisecond);
+
+static void BM_DumpDoubles_Ostringstream(benchmark::State& state) {
+    auto arr = make_double_array(kNumbers);
+    std::size_t bytes = 0;
+    for(auto _ : state) {
+        auto out = dump_with_ostringstream(arr);
+        bytes += out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kNumbers));
+}
+BENCHMARK(BM_DumpDoubles_Ostringstream)->Unit(benchmark::kMillisecond);
+
+static void BM_DumpIntegers(benchmark::State& state) {
+    auto arr = make_integer_array(kNumbers);
+    std::size_t bytes = 0;
+    for(auto _ : state) {
+        auto out = arr.dump();
+        bytes += out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kNumbers));
+}
+BENCHMARK(BM_DumpIntegers)->Unit(benchmark::kMillisecond);
+
+static void BM_DumpIntegers_Ostringstream(benchmark::State& state) {
+    auto arr = make_integer_array(kNumbers);
+    std::size_t bytes = 0;
+    for(auto _ : state) {
+        auto out = dump_with_ostringstream(arr);
+        bytes += out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kNumbers));
+}
+BENCHMARK(BM_DumpIntegers_Ostringstream)->Unit(benchmark::kMillisecond);
+
+// ndjson ----------------------------------------------------------
+/*
+    note: 200k log-like records (~30MB). BM_Ndjson_SerialParse is what callers did before
+    parse_ndjson existed: split on '\n' themselves and json::parse each line. the Arg is the thread count.
+*/
+namespace {
+
+std::string make_log_lines(std::size_t n) {
+    std::mt19937_64 rng(7);
+    std::string out;
+    for(std::size_t i = 0; i < n; ++i) {
+        out.append(R"({"ts": )").append(std::to_string(1700000000000 + i))
+           .append(R"(, "level": "info", "service": "api-gateway", "latency_ms": )").append(std::to_string(rng() % 5000 / 10.0))
+           .append(R"(, "path": "/v1/users/)").append(std::to_string(rng() % 100000))
+           .append(R"(", "tags": ["http", "edge", "prod"], "ok": true, "user": {"id": )").append(std::to_string(rng() % 1000000))
+           .append(R"(, "region": "eu-west-1"}})").append("\n");
+    }
+    return out;
+}
+
+const std::string& log_lines() {
+    static const std::string lines = make_log_lines(200'000);
+    return lines;
+}
+
+}
+
+static void BM_Ndjson(benchmark::State& state) {
+    const std::string& input = log_lines();
+    json::NdjsonOptions options{static_cast<unsigned>(state.range(0))};
+    for(auto _ : state) {
+        std::size_t n = json::parse_ndjson(input, [](json::JsonValue&& v, std::size_t) {
+            benchmark::DoNotOptimize(v);
+            return true;
+        }, options);
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+}
+BENCHMARK(BM_Ndjson)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_Ndjson_SerialParse(benchmark::State& state) {
+    std::string_view input = log_lines();
+    for(auto _ : state) {
+        std::size_t pos = 0;
+        while(pos < input.size()) {
+            std::size_t end = input.find('\n', pos);
+            if(end == std::string_view::npos) end = input.size();
+            auto v = json::parse(input.substr(pos, end - pos));
+            benchmark::DoNotOptimize(v);
+            pos = end + 1;
+        }
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+}
+BENCHMARK(BM_Ndjson_SerialParse)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// parse engines ----------------------------------------------------------
+/*
+    note: one ~20MB document (array of api-response-like objects, pretty printed) parsed by both
+    engines. the *_Sax variants use a handler that ignores every event, i.e. they time the grammar
+    alone without building a JsonValue.
+*/
+namespace {
+
+const std::string& large_document() {
+    static const std::string doc = [] {
+        std::mt19937_64 rng(11);
+        std::string out = "[\n";
+        for(int i = 0; i < 40000; ++i) {
+            if(i) out += ",\n";
+            out.append("  {\n    \"id\": ").append(std::to_string(rng() % 100000000))
+               .append(",\n    \"user\": {\"name\": \"user_").append(std::to_string(i))
+               .append("\", \"verified\": ").append(i % 3 ? "false" : "true")
+               .append(", \"followers\": ").append(std::to_string(rng() % 50000)).append("},\n")
+               .append("    \"text\": \"Lorem ipsum dolor sit amet, consectetur \\\"adipiscing\\\" elit, sed do eiusmod tempor\",\n")
+               .append("    \"score\": ").append(std::to_string((rng() % 100000) / 1000.0)).append(",\n")
+               .append("    \"tags\": [\"alpha\", \"beta\", \"gamma\"],\n")
+               .append("    \"location\": null\n  }");
+        }
+        out += "\n]";
+        return out;
+    }();
+    return doc;
+}
+
+struct IgnoreAll : json::SaxHandler {};
+
+}
+
+static void BM_Parse_RecursiveDescent(benchmark::State& state) {
+    const std::string& doc = large_document();
+    for(auto _ : state) {
+        auto v = json::parse(doc);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_Parse_RecursiveDescent)->Unit(benchmark::kMillisecond);
+
+static void BM_Parse_StructuralIndex(benchmark::State& state) {
+    const std::string& doc = large_document();
+    json::ParseOptions options{json::ParseEngine::StructuralIndex};
+    for(auto _ : state) {
+        auto v = json::parse(doc, options);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_Parse_StructuralIndex)->Unit(benchmark::kMillisecond);
+
+static void BM_Sax_RecursiveDescent(benchmark::State& state) {
+    const std::string& doc = large_document();
+    IgnoreAll handler;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(json::parse_sax(doc, handler));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_Sax_RecursiveDescent)->Unit(benchmark::kMillisecond);
+
+static void BM_Sax_StructuralIndex(benchmark::State& state) {
+    const std::string& doc = large_document();
+    IgnoreAll handler;
+    json::ParseOptions options{json::ParseEngine::StructuralIndex};
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(json::parse_sax(doc, handler, options));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_Sax_StructuralIndex)->Unit(benchmark::kMillisecond);
+
+// lazy document ----------------------------------------------------------
+/*
+    note: the consumer pattern the lazy Document is for - read 3 fields out of a 200 field object
+    (the fields are spread over the object, the last one near the end).
+*/
+namespace {
+
+const std::string& wide_object() {
+    static const std::string doc = [] {
+        std::string out = "{";
+        for(int i = 0; i < 200; ++i) {
+            if(i) out += ", ";
+            out.append("\"field_").append(std::to_string(i)).append("\": ");
+            switch(i % 4) {
+                case 0: out.append(std::to_string(i * 1000003)); break;
+                case 1: out.append("\"some string value number ").append(std::to_string(i)).append("\""); break;
+                case 2: out.append("[1.5, 2.5, {\"nested\": [true, false, null]}]"); break;
+                default: out.append("{\"a\": \"x\", \"b\": [1, 2, 3], \"c\": {\"d\": \"e\"}}"); break;
+            }
+        }
+        out += "}";
+        return out;
+    }();
+    return doc;
+}
+
+}
+
+static void BM_ReadThreeFields_Parse(benchmark::State& state) {
+    const std::string& doc = wide_object();
+    for(auto _ : state) {
+        auto v = json::parse(doc);
+        benchmark::DoNotOptimize(v["field_8"].as_int64() + v["field_101"].as_string().size() + v["field_196"].as_int64());
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_ReadThreeFields_Parse);
+
+static void BM_ReadThreeFields_Document(benchmark::State& state) {
+    const std::string& doc = wide_object();
+    for(auto _ : state) {
+        json::Document d(doc);
+        json::LazyValue root = d.root();  //one memo for the three lookups, they go in document order
+        benchmark::DoNotOptimize(root["field_8"].as_int64() + root["field_101"].as_string().size() + root["field_196"].as_int64());
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_ReadThreeFields_Document);
+
+// object storage ----------------------------------------------------------
+/*
+    note: lookup of every key of an object of Arg members - below the hash index threshold (16) it is a
+    linear scan, above it the index. BM_ParseLogLinesIntoArena parses the ndjson records (small objects)
+    one by one into one arena and reports the arena bytes used per input byte.
+*/
+static void BM_ObjectLookup(benchmark::State& state) {
+    json::JsonObject obj;
+    std::vector<std::string> keys;
+    for(std::int64_t i = 0; i < state.range(0); ++i) {
+        keys.push_back("member_name_" + std::to_string(i));
+        obj.insert_or_assign(json::JsonString(keys.back()), i);
+    }
+    for(auto _ : state) {
+        std::int64_t sum = 0;
+        for(const auto& key : keys) sum += obj.at(key).as_int64();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * keys.size()));
+}
+BENCHMARK(BM_ObjectLookup)->Arg(4)->Arg(16)->Arg(64)->Arg(1024);
+
+/*
+    note: BM_ObjectLookup through JsonValue::find with a json::Key per member - the hash is computed
+    once up front instead of per lookup (objects below 16 members do not hash in either)
+*/
+static void BM_ObjectLookup_Key(benchmark::State& state) {
+    json::JsonObject obj;
+    std::vector<std::string> names;
+    for(std::int64_t i = 0; i < state.range(0); ++i) {
+        names.push_back("member_name_" + std::to_string(i));
+        obj.insert_or_assign(json::JsonString(names.back()), i);
+    }
+    const json::JsonValue val(std::move(obj));
+    std::vector<json::Key> keys(names.begin(), names.end());
+    for(auto _ : state) {
+        std::int64_t sum = 0;
+        for(const auto& key : keys) sum += val.find(key)->as_int64();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * keys.size()));
+}
+BENCHMARK(BM_ObjectLookup_Key)->Arg(4)->Arg(16)->Arg(64)->Arg(1024);
+
+static void BM_ParseLogLinesIntoArena(benchmark::State& state) {
+    const std::string& lines = log_lines();
+    std::size_t used = 0;
+    for(auto _ : state) {
+        json::Arena arena;
+        std::size_t start = 0;
+        while(start < lines.size()) {
+            std::size_t end = lines.find('\n', start);
+            auto v = json::parse(std::string_view(lines).substr(start, end - start), arena);
+            benchmark::DoNotOptimize(v);
+            start = end + 1;
+        }
+        used = arena.bytes_used();
+    }
+    state.counters["arena_bytes_per_input_byte"] = static_cast<double>(used) / static_cast<double>(lines.size());
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * lines.size()));
+}
+BENCHMARK(BM_ParseLogLinesIntoArena)->Unit(benchmark::kMillisecond);
+
+// key pool ----------------------------------------------------------
+/*
+    note: the same-schema message stream the pool is for - 100k small messages whose field names are
+    mostly too long to be stored inline, each parsed on its own with json::parse, with and without a
+    shared KeyPool. BM_ObjectLookup_PooledKey repeats BM_ObjectLookup with keys from the pool
+    (pointer compare, stored hash).
+*/
+namespace {
+
+const std::vector<std::string>& messages() {
+    static const std::vector<std::string> out = [] {
+        std::mt19937_64 rng(11);
+        std::vector<std::string> v;
+        for(int i = 0; i < 100'000; ++i) {
+            v.push_back(R"({"event_timestamp_ms": )" + std::to_string(1700000000000 + i) +
+                        R"(, "request_duration_us": )" + std::to_string(rng() % 100000) +
+                        R"(, "upstream_service_name": "billing", "http_status_code": 200, "id": )" + std::to_string(i) +
+                        R"(, "client_address": {"ip_address_string": "10.0.0.1", "geo_region_code": "eu"}})");
+        }
+        return v;
+    }();
+    return out;
+}
+
+}
+
+static void BM_ParseMessages(benchmark::State& state) {
+    json::KeyPool pool;
+    json::ParseOptions options;
+    if(state.range(0)) options.key_pool = &pool;
+    std::size_t bytes = 0;
+    for(const auto& m : messages()) bytes += m.size();
+    for(auto _ : state) {
+        for(const auto& m : messages()) {
+            auto v = json::parse(m, options);
+            benchmark::DoNotOptimize(v);
+        }
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes));
+}
+BENCHMARK(BM_ParseMessages)->ArgName("pool")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+static void BM_ObjectLookup_PooledKey(benchmark::State& state) {
+    json::KeyPool pool;
+    json::JsonObject obj;
+    std::vector<json::JsonKey> keys;
+    for(std::int64_t i = 0; i < state.range(0); ++i) {
+        keys.push_back(pool.intern("member_name_" + std::to_string(i)));
+        obj.insert_or_assign(keys.back(), i);
+    }
+    for(auto _ : state) {
+        std::int64_t sum = 0;
+        for(const auto& key : keys) sum += obj.find(key)->second.as_int64();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * keys.size()));
+}
+BENCHMARK(BM_ObjectLookup_PooledKey)->Arg(4)->Arg(16)->Arg(64)->Arg(1024);
+
+// string storage ----------------------------------------------------------
+/*
+    note: the ndjson records from above as one big array (mostly short, escape free strings), parsed
+    with strings copied vs in situ. allocs_per_doc counts what reaches the memory resource.
+*/
+namespace {
+
+const std::string& records_array() {
+    static const std::string doc = [] {
+        std::string out = "[";
+        const std::string& lines = log_lines();
+        for(std::size_t start = 0; start < lines.size();) {
+            std::size_t end = lines.find('\n', start);
+            if(start) out += ',';
+            out.append(lines, start, end - start);
+            start = end + 1;
+        }
+        return out + "]";
+    }();
+    return doc;
+}
+
+struct CountingResource : std::pmr::memory_resource {
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        this->bytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this == &other;}
+};
+
+}
+
+static void BM_ParseStrings(benchmark::State& state) {
+    const std::string& doc = records_array();
+    json::ParseOptions options;
+    options.in_situ_strings = state.range(0) != 0;
+    CountingResource counter;
+    std::size_t docs = 0;
+    for(auto _ : state) {
+        auto v = json::parse(doc, counter, options);
+        benchmark::DoNotOptimize(v);
+        ++docs;
+    }
+    state.counters["allocs_per_doc"] = static_cast<double>(counter.allocations) / static_cast<double>(docs);
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_ParseStrings)->ArgName("in_situ")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// streaming dump ----------------------------------------------------------
+/*
+    note: the records array parsed once, then serialized compact / pretty (Arg = indent, -1 compact).
+    BM_Dump builds the whole string, BM_DumpTo streams it through a 64KB CallbackWriter whose sink
+    only counts bytes - the cost of producing the output without holding all of it.
+*/
+static void BM_Dump(benchmark::State& state) {
+    auto v = json::parse(records_array());
+    int indent = static_cast<int>(state.range(0));
+    std::size_t bytes = 0;
+    for(auto _ : state) {
+        auto out = v.dump(indent);
+        bytes += out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+}
+BENCHMARK(BM_Dump)->ArgName("indent")->Arg(-1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+static void BM_DumpTo(benchmark::State& state) {
+    auto v = json::parse(records_array());
+    int indent = static_cast<int>(state.range(0));
+    std::size_t bytes = 0;
+    json::CallbackWriter writer([&](std::string_view chunk) {bytes += chunk.size();});
+    for(auto _ : state) {
+        v.dump_to(writer, indent);
+        writer.flush();
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+}
+BENCHMARK(BM_DumpTo)->ArgName("indent")->Arg(-1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+// string escaping ----------------------------------------------------------
+/*
+    note: 100k strings of 16-200 bytes of text. Arg is how many of them carry escapes (a quote, a
+    newline and a control byte) per 1000 - prose / log messages are mostly clean, 1000 is the worst case.
+*/
+namespace {
+
+json::JsonValue make_string_array(std::size_t n, std::size_t escaped_per_1000) {
+    std::mt19937_64 rng(11);
+    const std::string text = "The quick brown fox jumps over the lazy dog; caf\xC3\xA9, na\xC3\xAFve, 0123456789. ";
+    json::JsonArray arr;
+    arr.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        std::size_t len = 16 + rng() % 185;
+        std::string s;
+        while(s.size() < len) s += text;
+        s.resize(len);
+        if(rng() % 1000 < escaped_per_1000) {
+            s[rng() % len] = '"';
+            s[rng() % len] = '\n';
+            s[rng() % len] = '\x01';
+        }
+        arr.emplace_back(s);
+    }
+    return json::JsonValue(std::move(arr));
+}
+
+}
+
+static void BM_DumpStrings(benchmark::State& state) {
+    auto v = make_string_array(100'000, static_cast<std::size_t>(state.range(0)));
+    std::size_t bytes = 0;
+    for(auto _ : state) {
+        auto out = v.dump();
+        bytes += out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+}
+BENCHMARK(BM_DumpStrings)->ArgName("escaped_per_1000")->Arg(0)->Arg(50)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+// nesting ----------------------------------------------------------
+/*
+    note: 20k records nested Arg levels deep ({"a": [{"a": [... 1 ...]}]}), through the SAX path so only
+    the parser's own cost per level is timed.
+*/
+namespace {
+
+std::string make_nested_records(std::size_t records, std::size_t depth) {
+    std::string out = "[";
+    for(std::size_t i = 0; i < records; ++i) {
+        if(i) out += ',';
+        for(std::size_t d = 0; d < depth; ++d) out += d % 2 ? "[" : "{\"a\":";
+        out += std::to_string(i);
+        for(std::size_t d = depth; d-- > 0;) out += d % 2 ? "]" : "}";
+    }
+    return out + "]";
+}
+
+}
+
+static void BM_ParseNested(benchmark::State& state) {
+    std::string doc = make_nested_records(20'000, static_cast<std::size_t>(state.range(0)));
+    IgnoreAll handler;
+    for(auto _ : state) {
+        bool ok = json::parse_sax(doc, handler);
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_ParseNested)->ArgName("depth")->Arg(4)->Arg(64)->Arg(512)->Unit(benchmark::kMillisecond);
+
+// parallel parse ----------------------------------------------------------
+/*
+    note: the ~30MB records array from above as one document, parsed with ParseOptions::threads = Arg
+    (1 is the plain serial parse). UseRealTime, the work happens on the pool's threads.
+*/
+static void BM_ParseParallel(benchmark::State& state) {
+    const std::string& doc = records_array();
+    json::ParseOptions options;
+    options.threads = static_cast<unsigned>(state.range(0));
+    for(auto _ : state) {
+        auto v = json::parse(doc, options);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_ParseParallel)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// cbor --------------------------------------------------------------------
+/*
+    note: the records array again, encoded / decoded as CBOR. bytes processed is the size of the JSON
+    text in both, so MB/s compares directly with BM_Dump/-1 and BM_ParseStrings (same Arg = in_situ).
+    cbor_bytes is the encoded size.
+*/
+static void BM_ToCbor(benchmark::State& state) {
+    auto v = json::parse(records_array());
+    std::size_t size = 0;
+    for(auto _ : state) {
+        auto out = v.to_cbor();
+        size = out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * records_array().size()));
+    state.counters["cbor_bytes"] = static_cast<double>(size);
+}
+BENCHMARK(BM_ToCbor)->Unit(benchmark::kMillisecond);
+
+static void BM_FromCbor(benchmark::State& state) {
+    const std::string encoded = json::parse(records_array()).to_cbor();
+    json::ParseOptions options;
+    options.in_situ_strings = state.range(0) != 0;
+    for(auto _ : state) {
+        auto v = json::from_cbor(encoded, options);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * records_array().size()));
+    state.counters["cbor_bytes"] = static_cast<double>(encoded.size());
+}
+BENCHMARK(BM_FromCbor)->ArgName("in_situ")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// json pointer ------------------------------------------------------------
+/*
+    note: the same 4 level lookup on one parsed message, Arg 0 = the path exists, 1 = the last key is
+    missing. chained operator[] throws std::out_of_range on the miss (caught here), Path returns null.
+*/
+namespace {
+
+const json::JsonValue& path_message() {
+    static const json::JsonValue doc = json::parse(
+        R"({"id": 42, "type": "order", "payload": {"customer": {"id": 7, "tier": "gold"}, "currency": "EUR",)"
+        R"( "items": [{"sku": "a-1", "qty": 2, "price": 9.5, "tags": ["new"]}, {"sku": "b-2", "qty": 1, "price": 3}]},)"
+        R"( "meta": {"trace": "abc", "retries": 0}})");
+    return doc;
+}
+
+}
+
+static void BM_ChainedLookup(benchmark::State& state) {
+    const json::JsonValue& doc = path_message();
+    const char* last = state.range(0) ? "cost" : "price";
+    double sum = 0;
+    for(auto _ : state) {
+        try {
+            sum += doc["payload"]["items"][0][last].as_number();
+        } catch(const std::out_of_range&) {
+            sum -= 1;
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_ChainedLookup)->ArgName("miss")->Arg(0)->Arg(1);
+
+static void BM_PathLookup(benchmark::State& state) {
+    const json::JsonValue& doc = path_message();
+    const json::Path path(state.range(0) ? "/payload/items/0/cost" : "/payload/items/0/price");
+    double sum = 0;
+    for(auto _ : state) {
+        const json::JsonValue* v = path.find(doc);
+        sum += v ? v->as_number() : -1;
+    }
+    benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_PathLookup)->ArgName("miss")->Arg(0)->Arg(1);
+
+// typed binding -----------------------------------------------------------
+/*
+    note: the records array into std::vector<LogRecord>. BM_BindRecords goes straight from the text
+    (from_json), BM_ParseThenCopyRecords is the parse + copy the fields out of the JsonValue it replaces.
+*/
+namespace {
+
+struct LogUser {
+    std::int64_t id = 0;
+    std::string region;
+};
+JSON_FIELDS(LogUser, id, region)
+
+struct LogRecord {
+    std::int64_t ts = 0;
+    std::string level;
+    std::string service;
+    double latency_ms = 0;
+    std::string path;
+    std::vector<std::string> tags;
+    bool ok = false;
+    LogUser user;
+};
+JSON_FIELDS(LogRecord, ts, level, service, latency_ms, path, tags, ok, user)
+
+}
+
+static void BM_BindRecords(benchmark::State& state) {
+    const std::string& doc = records_array();
+    for(auto _ : state) {
+        auto records = json::from_json<std::vector<LogRecord>>(doc);
+        benchmark::DoNotOptimize(records);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_BindRecords)->Unit(benchmark::kMillisecond);
+
+static void BM_ParseThenCopyRecords(benchmark::State& state) {
+    const std::string& doc = records_array();
+    for(auto _ : state) {
+        auto v = json::parse(doc);
+        std::vector<LogRecord> records;
+        records.reserve(v.size());
+        for(const auto& r : v.as_array()) {
+            LogRecord& out = records.emplace_back();
+            out.ts = r["ts"].as_int64();
+            out.level = r["level"].as_string();
+            out.service = r["service"].as_string();
+            out.latency_ms = r["latency_ms"].as_number();
+            out.path = r["path"].as_string();
+            for(const auto& tag : r["tags"].as_array()) out.tags.emplace_back(tag.as_string());
+            out.ok = r["ok"].as_bool();
+            out.user.id = r["user"]["id"].as_int64();
+            out.user.region = r["user"]["region"].as_string();
+        }
+        benchmark::DoNotOptimize(records);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_ParseThenCopyRecords)->Unit(benchmark::kMillisecond);
+
+// shared values -----------------------------------------------------------
+/*
+    note: copying the parsed records array, Arg 0 = a plain value (deep copy), 1 = after share()
+    (refcount increment). BM_ReadSharedCopy is a copy + one const lookup, what a worker thread does
+    with a handed out config.
+*/
+static void BM_CopyValue(benchmark::State& state) {
+    json::JsonValue v = json::parse(records_array());
+    if(state.range(0)) v = std::move(v).share();
+    for(auto _ : state) {
+        json::JsonValue copy = v;
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_CopyValue)->ArgName("shared")->Arg(0)->Arg(1);
+
+static void BM_ReadSharedCopy(benchmark::State& state) {
+    const json::JsonValue v = json::parse(records_array()).share();
+    std::size_t sum = 0;
+    for(auto _ : state) {
+        const json::JsonValue copy = v;
+        sum += copy[100].size();
+    }
+    benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_ReadSharedCopy);
+
+// builder -----------------------------------------------------------------
+/*
+    note: 10k order records built in code, Arg 0 = JsonArray / JsonObject filled by hand the usual way
+    (no reserve, containers moved into their parent), 1 = json::Builder (reused, so its stacks are warm).
+    allocs_per_doc / bytes_per_doc count what reaches the memory resource - the grown buffers left behind
+    by the hand built version are the difference. every value goes to its container with one move with
+    the Builder, growth moves the elements built by hand again each time a buffer is outgrown
+*/
+static void BM_BuildRecords(benchmark::State& state) {
+    constexpr int kRecords = 10'000;
+    const bool use_builder = state.range(0) != 0;
+    CountingResource counter;
+    json::Builder builder(counter);
+    std::size_t docs = 0;
+    for(auto _ : state) {
+        json::JsonValue doc;
+        if(use_builder) {
+            builder.begin_array();
+            for(int i = 0; i < kRecords; ++i) {
+                builder.begin_object();
+                builder.key("id").value(i);
+                builder.key("sku").value("sku-000000000-standard");
+                builder.key("qty").value(i % 7);
+                builder.key("price").value(i * 0.25);
+                builder.key("tags").begin_array().value("clearance-sale").value("in-stock-item").value("new").end_array();
+                builder.key("meta").begin_object().key("warehouse").value("eu-central-1").key("priority").value(true).end_object();
+                builder.end_object();
+            }
+            builder.end_array();
+            doc = builder.take();
+        } else {
+            json::JsonArray records(&counter);
+            for(int i = 0; i < kRecords; ++i) {
+                json::JsonObject rec(&counter);
+                rec.insert_or_assign("id", i);
+                rec.insert_or_assign("sku", json::JsonValue("sku-000000000-standard", counter));
+                rec.insert_or_assign("qty", i % 7);
+                rec.insert_or_assign("price", i * 0.25);
+                json::JsonArray tags(&counter);
+                tags.emplace_back("clearance-sale", counter);
+                tags.emplace_back("in-stock-item", counter);
+                tags.emplace_back("new", counter);
+                rec.insert_or_assign("tags", std::move(tags));
+                json::JsonObject meta(&counter);
+                meta.insert_or_assign("warehouse", json::JsonValue("eu-central-1", counter));
+                meta.insert_or_assign("priority", true);
+                rec.insert_or_assign("meta", std::move(meta));
+                records.push_back(std::move(rec));
+            }
+            doc = json::JsonValue(std::move(records));
+        }
+        benchmark::DoNotOptimize(doc);
+        ++docs;
+    }
+    state.counters["allocs_per_doc"] = static_cast<double>(counter.allocations) / static_cast<double>(docs);
+    state.counters["bytes_per_doc"] = static_cast<double>(counter.bytes) / static_cast<double>(docs);
+}
+BENCHMARK(BM_BuildRecords)->ArgName("builder")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// parse stats -------------------------------------------------------------
+/*
+    note: the large document parsed without stats (0), with counts (1) and with phase timings (2).
+    0 is the plain parse - the counting handler is a separate instantiation, so it should match
+    BM_Parse_RecursiveDescent. the phase split of the last run is reported as counters (ms)
+*/
+static void BM_ParseStats(benchmark::State& state) {
+    const std::string& doc = large_document();
+    json::ParseStats stats;
+    json::ParseOptions options;
+    if(state.range(0) > 0) options.stats = &stats;
+    options.time_phases = state.range(0) > 1;
+    for(auto _ : state) {
+        auto v = json::parse(doc, options);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+    if(options.time_phases) {
+        auto ms = [](std::chrono::nanoseconds t) {return static_cast<double>(t.count()) / 1e6;};
+        state.counters["whitespace_ms"] = ms(stats.time.whitespace);
+        state.counters["strings_ms"] = ms(stats.time.strings);
+        state.counters["numbers_ms"] = ms(stats.time.numbers);
+        state.counters["build_ms"] = ms(stats.time.build);
+        state.counters["other_ms"] = ms(stats.time.other);
+    }
+}
+BENCHMARK(BM_ParseStats)->ArgName("stats")->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+// validation -------------------------------------------------------------
+/*
+    note: the large document checked by validate() with utf-8 (0) and without (1), against the fastest
+    way to check it before: a sax parse that ignores every event (2). utf-8 on an ascii document is
+    one block scan. BM_ValidateText checks a document of mostly non-ascii strings, where every
+    multi byte character goes through the scalar sequence check
+*/
+static void BM_Validate(benchmark::State& state) {
+    const std::string& doc = large_document();
+    json::ValidationLimits limits;
+    limits.utf8 = state.range(0) == 0;
+    IgnoreAll handler;
+    for(auto _ : state) {
+        if(state.range(0) == 2) {
+            benchmark::DoNotOptimize(json::parse_sax(doc, handler));
+        } else {
+            json::validate(doc, limits);
+        }
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_Validate)->ArgName("mode")->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+static void BM_ValidateText(benchmark::State& state) {
+    static const std::string doc = [] {
+        std::string out = "[";
+        for(int i = 0; i < 100000; ++i) {
+            if(i) out += ", ";
+            out += "\"Grüße aus Köln, здравствуй мир, こんにちは世界 \xF0\x9F\x98\x80\"";
+        }
+        return out + "]";
+    }();
+    for(auto _ : state) json::validate(doc);
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * doc.size()));
+}
+BENCHMARK(BM_ValidateText)->Unit(benchmark::kMillisecond);
+
+// patches -------------------------------------------------------------
+/*
+    note: the large document is kept and gets one small patch (a counter in one record) before every
+    dump, as for a cached response. 0 applies the patch and calls dump(), 1 does the same through a
+    DumpCache, which serializes the patched record and its parents and copies the rest
+*/
+static void BM_PatchAndDump(benchmark::State& state) {
+    const bool cached = state.range(0) == 1;
+    json::JsonValue doc = json::parse(large_document());
+    json::DumpCache cache(doc);
+    (void)cache.dump();
+    std::size_t bytes = 0, serialized = 0, round = 0;
+    for(auto _ : state) {
+        json::JsonValue patch = json::parse(R"([{"op": "replace", "path": "/)" + std::to_string(round * 7919 % 40000) +
+                                            R"(/user/followers", "value": )" + std::to_string(round) + "}]");
+        ++round;
+        if(cached) {
+            cache.apply_patch(patch);
+            const std::string& out = cache.dump();
+            bytes += out.size();
+            serialized += cache.serialized_bytes();
+        } else {
+            json::apply_patch(doc, patch);
+            std::string out = doc.dump();
+            bytes += out.size();
+            serialized += out.size();
+        }
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+    state.counters["serialized_per_dump"] = static_cast<double>(serialized) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_PatchAndDump)->ArgName("cached")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
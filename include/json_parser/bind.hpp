@@ -0,0 +1,276 @@
+#ifndef JSON_BIND_HPP
+#define JSON_BIND_HPP
+
+#include "json_parser/json.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace json {
+
+/*
+    typed deserialization: JSON text straight into your own structs, without a JsonValue in between.
+
+        struct Item {std::string sku; int qty = 0; double price = 0;};
+        struct Order {std::uint64_t id = 0; std::vector<Item> items; std::optional<std::string> note;};
+        JSON_FIELDS(Item, sku, qty, price)
+        JSON_FIELDS(Order, id, items, note)
+
+        Order order = json::from_json<Order>(body);
+
+    - JSON_FIELDS(Type, members...) goes in Type's namespace (it is found by ADL), up to 32 members.
+      the key of each member is its name
+    - member types: bool, integers (range checked), float / double, std::string, std::vector<T>,
+      std::optional<T> (null resets it) and other JSON_FIELDS types, nested as deep as max_depth allows
+    - unknown keys are skipped. missing keys leave the member alone (value initialized by
+      from_json<T>(), whatever it was for from_json(json, out)). duplicate keys: the last one wins
+    - the Parser's events go straight into the members: a key is matched with one probe into a perfect
+      hash that is built at compile time from the member names, strings are assigned from the
+      parser's views. nothing is allocated apart from what the members themselves hold
+    - input that does not fit the type (a string for a number, 300 for a std::uint8_t, 1.5 for an int,
+      null for a member that is not optional) throws ParseError like a syntax error does.
+      position() is where the offending value starts, a scalar as well as an array / object
+*/
+
+namespace detail {
+
+enum class BindKind : std::uint8_t {Bool, Signed, Unsigned, Float, String, Array, Optional, Struct};
+
+struct TypeDesc;
+//a function rather than a pointer to the descriptor, so types can refer to themselves (and to types
+//whose JSON_FIELDS comes later) and the tables below stay constant expressions
+using TypeOf = const TypeDesc& (*)();
+
+struct FieldDesc {
+    std::string_view name;
+    void* (*member)(void* object);
+    TypeOf type;
+};
+
+/*
+    everything src/bind.cpp needs to know about one bindable type, as type erased operations on a void*.
+    one constexpr instance per type, only the entries of its kind are set.
+*/
+struct TypeDesc {
+    BindKind kind = BindKind::Bool;
+    //scalars
+    void (*set_bool)(void* target, bool value) = nullptr;
+    void (*set_signed)(void* target, std::int64_t value) = nullptr;
+    void (*set_unsigned)(void* target, std::uint64_t value) = nullptr;
+    void (*set_double)(void* target, double value) = nullptr;
+    void (*set_string)(void* target, std::string_view value) = nullptr;
+    std::int64_t min = 0;   //Signed
+    std::uint64_t max = 0;  //Signed / Unsigned
+    //Array: clear + append an element. Optional: reset + emplace the value
+    void (*clear)(void* target) = nullptr;
+    void* (*append)(void* target) = nullptr;
+    TypeOf element = nullptr;
+    //Struct: the members and the perfect hash over their names (slots hold field index + 1, 0 = empty)
+    const FieldDesc* fields = nullptr;
+    std::size_t field_count = 0;
+    std::uint64_t seed = 0;
+    std::size_t mask = 0;
+    const std::uint8_t* slots = nullptr;
+};
+
+//fnv-1a with a seed and a final mix, so the low bits (the slot) depend on every byte
+constexpr std::uint64_t key_hash(std::string_view key, std::uint64_t seed) noexcept {
+    std::uint64_t h = 0xcbf29ce484222325ull ^ (seed * 0x9e3779b97f4a7c15ull);
+    for(char c : key) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ull;
+    return h ^ (h >> 32);
+}
+
+//4x the field count: a collision free seed then turns up after a few dozen tries even for 32 fields
+constexpr std::size_t key_slots(std::size_t fields) noexcept {
+    std::size_t slots = 4;
+    while(slots < 4 * fields) slots *= 2;
+    return slots;
+}
+
+template <std::size_t N>
+struct KeyTable {
+    std::uint64_t seed = 0;
+    std::array<std::uint8_t, key_slots(N)> slots{};
+};
+
+//tries seeds until every name lands in its own slot. runs at compile time (JSON_FIELDS)
+template <std::size_t N>
+constexpr KeyTable<N> make_key_table(const FieldDesc (&fields)[N]) {
+    static_assert(N < 256, "too many fields");
+    KeyTable<N> table;
+    for(std::uint64_t seed = 0;; ++seed) {
+        table.slots = {};
+        bool perfect = true;
+        for(std::size_t i = 0; i < N && perfect; ++i) {
+            std::uint8_t& slot = table.slots[key_hash(fields[i].name, seed) & (table.slots.size() - 1)];
+            if(slot) {
+                perfect = false;
+            } else {
+                slot = static_cast<std::uint8_t>(i + 1);
+            }
+        }
+        if(perfect) {
+            table.seed = seed;
+            return table;
+        }
+    }
+}
+
+template <std::size_t N>
+constexpr TypeDesc struct_desc(const FieldDesc (&fields)[N], const KeyTable<N>& table) {
+    TypeDesc desc;
+    desc.kind = BindKind::Struct;
+    desc.fields = fields;
+    desc.field_count = N;
+    desc.seed = table.seed;
+    desc.mask = table.slots.size() - 1;
+    desc.slots = table.slots.data();
+    return desc;
+}
+
+template <typename T> struct is_vector : std::false_type {};
+template <typename T, typename A> struct is_vector<std::vector<T, A>> : std::true_type {};
+template <typename T> struct is_optional : std::false_type {};
+template <typename T> struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+const TypeDesc& type_of();
+
+//descriptors of everything but JSON_FIELDS structs
+template <typename T>
+constexpr TypeDesc make_desc() {
+    TypeDesc desc;
+    if constexpr (std::is_same_v<T, bool>) {
+        desc.kind = BindKind::Bool;
+        desc.set_bool = [](void* p, bool v) {*static_cast<T*>(p) = v;};
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        desc.kind = BindKind::Signed;
+        desc.set_signed = [](void* p, std::int64_t v) {*static_cast<T*>(p) = static_cast<T>(v);};
+        desc.min = std::numeric_limits<T>::min();
+        desc.max = static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+    } else if constexpr (std::is_integral_v<T>) {
+        desc.kind = BindKind::Unsigned;
+        desc.set_unsigned = [](void* p, std::uint64_t v) {*static_cast<T*>(p) = static_cast<T>(v);};
+        desc.max = std::numeric_limits<T>::max();
+    } else if constexpr (std::is_floating_point_v<T>) {
+        desc.kind = BindKind::Float;
+        desc.set_double = [](void* p, double v) {*static_cast<T*>(p) = static_cast<T>(v);};
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        desc.kind = BindKind::String;
+        desc.set_string = [](void* p, std::string_view v) {static_cast<T*>(p)->assign(v);};
+    } else if constexpr (is_vector<T>::value) {
+        desc.kind = BindKind::Array;
+        desc.clear = [](void* p) {static_cast<T*>(p)->clear();};
+        desc.append = [](void* p) -> void* {return &static_cast<T*>(p)->emplace_back();};
+        desc.element = &type_of<typename T::value_type>;
+    } else {
+        desc.kind = BindKind::Optional;
+        desc.clear = [](void* p) {static_cast<T*>(p)->reset();};
+        desc.append = [](void* p) -> void* {return &static_cast<T*>(p)->emplace();};
+        desc.element = &type_of<typename T::value_type>;
+    }
+    return desc;
+}
+
+template <typename T>
+inline constexpr TypeDesc builtin_desc = make_desc<T>();
+
+template <typename T>
+const TypeDesc& type_of() {
+    static_assert(!std::is_same_v<T, std::vector<bool>>, "std::vector<bool> has no element references, use std::vector<char>");
+    static_assert(!std::is_same_v<T, char> && !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char8_t> &&
+                  !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>, "characters are not bindable");
+    if constexpr (std::is_arithmetic_v<T> || std::is_same_v<T, std::string> || is_vector<T>::value || is_optional<T>::value) {
+        return builtin_desc<T>;
+    } else if constexpr (requires {json_type_desc(static_cast<const T*>(nullptr));}) {
+        return json_type_desc(static_cast<const T*>(nullptr));
+    } else {
+        static_assert(sizeof(T) == 0, "no binding for this type - add JSON_FIELDS(Type, members...)");
+    }
+}
+
+//the runtime side (src/bind.cpp): drives the Parser into 'out', which is a 'type'
+void bind_json(std::string_view json, void* out, const TypeDesc& type, std::size_t max_depth);
+
+}
+
+//fills 'out' from an existing value: members whose keys are missing keep what they had
+template <typename T>
+void from_json(std::string_view json, T& out, const ParseOptions& options = {}) {
+    detail::bind_json(json, &out, detail::type_of<T>(), options.max_depth);
+}
+
+template <typename T>
+[[nodiscard]] T from_json(std::string_view json, const ParseOptions& options = {}) {
+    T out{};
+    from_json(json, out, options);
+    return out;
+}
+
+}
+
+//preprocessor for-each over the member names of JSON_FIELDS
+#define JSON_DETAIL_EXPAND(x) x
+#define JSON_DETAIL_FE_1(F, T, x) F(T, x)
+#define JSON_DETAIL_FE_2(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_1(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_3(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_2(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_4(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_3(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_5(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_4(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_6(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_5(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_7(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_6(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_8(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_7(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_9(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_8(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_10(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_9(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_11(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_10(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_12(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_11(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_13(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_12(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_14(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_13(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_15(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_14(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_16(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_15(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_17(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_16(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_18(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_17(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_19(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_18(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_20(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_19(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_21(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_20(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_22(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_21(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_23(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_22(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_24(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_23(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_25(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_24(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_26(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_25(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_27(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_26(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_28(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_27(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_29(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_28(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_30(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_29(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_31(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_30(F, T, __VA_ARGS__))
+#define JSON_DETAIL_FE_32(F, T, x, ...) F(T, x) JSON_DETAIL_EXPAND(JSON_DETAIL_FE_31(F, T, __VA_ARGS__))
+#define JSON_DETAIL_PICK_FE(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, NAME, ...) NAME
+#define JSON_DETAIL_FOR_EACH(F, T, ...) \
+    JSON_DETAIL_EXPAND(JSON_DETAIL_PICK_FE(__VA_ARGS__, JSON_DETAIL_FE_32, JSON_DETAIL_FE_31, JSON_DETAIL_FE_30, JSON_DETAIL_FE_29, JSON_DETAIL_FE_28, JSON_DETAIL_FE_27, JSON_DETAIL_FE_26, JSON_DETAIL_FE_25, JSON_DETAIL_FE_24, JSON_DETAIL_FE_23, JSON_DETAIL_FE_22, JSON_DETAIL_FE_21, JSON_DETAIL_FE_20, JSON_DETAIL_FE_19, JSON_DETAIL_FE_18, JSON_DETAIL_FE_17, JSON_DETAIL_FE_16, JSON_DETAIL_FE_15, JSON_DETAIL_FE_14, JSON_DETAIL_FE_13, JSON_DETAIL_FE_12, JSON_DETAIL_FE_11, JSON_DETAIL_FE_10, JSON_DETAIL_FE_9, JSON_DETAIL_FE_8, JSON_DETAIL_FE_7, JSON_DETAIL_FE_6, JSON_DETAIL_FE_5, JSON_DETAIL_FE_4, JSON_DETAIL_FE_3, JSON_DETAIL_FE_2, JSON_DETAIL_FE_1, unused)(F, T, __VA_ARGS__))
+
+#define JSON_DETAIL_FIELD(T, m) \
+    ::json::detail::FieldDesc{#m, [](void* object) -> void* {return &static_cast<T*>(object)->m;}, \
+                              &::json::detail::type_of<decltype(T::m)>},
+
+//binds the listed members of Type, see from_json(). use in Type's namespace
+#define JSON_FIELDS(Type, ...) \
+    [[maybe_unused]] inline const ::json::detail::TypeDesc& json_type_desc(const Type*) { \
+        static constexpr ::json::detail::FieldDesc fields[] = { \
+            JSON_DETAIL_FOR_EACH(JSON_DETAIL_FIELD, Type, __VA_ARGS__) \
+        }; \
+        static constexpr auto table = ::json::detail::make_key_table(fields); \
+        static constexpr ::json::detail::TypeDesc desc = ::json::detail::struct_desc(fields, table); \
+        return desc; \
+    }
+
+#endif
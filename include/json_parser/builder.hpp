@@ -0,0 +1,71 @@
+#ifndef JSON_BUILDER_HPP
+#define JSON_BUILDER_HPP
+
+#include "json_parser/json.hpp"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace json {
+
+/*
+    builds a document one event at a time, the way the parser does - it is the same builder json::parse()
+    runs, driven by calls instead of by the grammar:
+
+        json::Builder b;
+        b.begin_object();
+        b.key("id").value(42);
+        b.key("tags").begin_array().value("new").value("sale").end_array();
+        b.end_object();
+        json::JsonValue doc = b.take();
+
+    - values wait on a stack until their container ends. then the container is allocated once, at its
+      exact size, and every value is moved into it once. building JsonArray / JsonObject by hand grows
+      them instead (every outgrown buffer is an allocation, and in an Arena memory that is never reused)
+      and moves the finished container into the JsonValue
+    - keys are copied straight into their object (or interned in key_pool, for long ones), with a
+      duplicate key the last value wins like in parse()
+    - strings are copied into 'resource' (must outlive the result), so are the containers. value(JsonValue)
+      takes a finished value (a subtree, a shared value) as it is
+    - the stacks are kept by take(), a Builder reused for the next document allocates nothing but the
+      document itself
+    - calls that do not make a document throw std::logic_error: a value where a key is expected, a key
+      outside an object, closing the wrong container, a second root, take() with containers still open
+*/
+class Builder {
+public:
+    explicit Builder(std::pmr::memory_resource& resource = *std::pmr::get_default_resource(), KeyPool* key_pool = nullptr);
+    ~Builder();
+    Builder(Builder&&) noexcept;
+    Builder& operator=(Builder&&) noexcept;
+
+    Builder& begin_array();
+    Builder& end_array();
+    Builder& begin_object();
+    Builder& end_object();
+    Builder& key(std::string_view k);
+
+    Builder& value(JsonValue v);
+    //strings are copied into the builder's resource (JsonValue(const char*) would use the default one)
+    Builder& value(std::string_view s);
+    Builder& value(const char* s) {return value(std::string_view(s));}
+    Builder& value(const std::string& s) {return value(std::string_view(s));}
+    //otherwise nullptr would pick const char*
+    Builder& value(std::nullptr_t) {return value(JsonValue());}
+
+    //room for n more values (and keys) before the stacks grow, for a first document of known size
+    Builder& reserve(std::size_t n);
+
+    //the finished document (null if nothing was added). the builder is ready for the next one
+    [[nodiscard]] JsonValue take();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef JSON_DOCUMENT_HPP
+#define JSON_DOCUMENT_HPP
+
+#include "json_parser/json.hpp"
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace json {
+
+/*
+    on demand (lazy) access to a json document - for reading a few fields out of a big input.
+
+    nothing is parsed up front. doc["a"]["b"] walks the raw text: members that do not match are
+    skipped by bracket matching (strings are skipped too, so brackets inside them do not count) and
+    nothing is allocated along the way. only the value that is finally read gets decoded.
+
+    - the input is not copied, it must outlive the Document and every LazyValue taken from it
+    - only the parts that are actually read are validated. a syntax error in a member that is skipped
+      goes unnoticed, an error in a member that is read throws ParseError like json::parse() would
+    - duplicate keys: a lookup finds the first occurrence from where the previous lookup on the same
+      LazyValue ended (see below), wrapping around - so the first one in the object unless an earlier
+      lookup already moved past it. Document's own lookups always find the first. json::parse keeps the last
+    - missing keys / indices throw std::out_of_range, wrong types std::runtime_error - same as the
+      const accessors of JsonValue
+    - each value remembers where its last lookup ended, so reading the fields of an object (or the
+      elements of an array) in document order costs one pass over it, not one pass per field.
+      because of that memo a LazyValue must not be used from two threads at once
+*/
+class LazyValue {
+public:
+    using Type = JsonValue::Type;
+
+    //only looks at the value itself (numbers are scanned to tell Int64 / Uint64 / Number apart)
+    [[nodiscard]] Type type() const;
+    [[nodiscard]] bool is_null() const {return type() == Type::Null;}
+    [[nodiscard]] bool is_bool() const {return type() == Type::Bool;}
+    [[nodiscard]] bool is_number() const;
+    [[nodiscard]] bool is_string() const {return type() == Type::String;}
+    [[nodiscard]] bool is_array() const {return type() == Type::Array;}
+    [[nodiscard]] bool is_object() const {return type() == Type::Object;}
+
+    //accessors (throw if wrong type), same conversions as JsonValue
+    [[nodiscard]] bool as_bool() const;
+    [[nodiscard]] double as_number() const;
+    [[nodiscard]] std::int64_t as_int64() const;
+    [[nodiscard]] std::uint64_t as_uint64() const;
+    [[nodiscard]] std::string as_string() const;  //decoded (escapes resolved)
+
+    [[nodiscard]] LazyValue operator[](std::string_view key) const;
+    [[nodiscard]] LazyValue operator[](std::size_t index) const;
+    [[nodiscard]] bool contains(std::string_view key) const;
+    //like operator[], but a missing key / index or a value of the wrong type gives nullopt instead of
+    //throwing. syntax errors in the input still throw ParseError
+    [[nodiscard]] std::optional<LazyValue> find(std::string_view key) const;
+    [[nodiscard]] std::optional<LazyValue> find(std::size_t index) const;
+    //number of members / elements - walks the whole container
+    [[nodiscard]] std::size_t size() const;
+
+    //the exact text of this value in the input
+    [[nodiscard]] std::string_view raw_json() const;
+    //parse this value (and everything under it) into a JsonValue
+    [[nodiscard]] JsonValue materialize(std::pmr::memory_resource& resource = *std::pmr::get_default_resource()) const;
+
+    //offset of the value in the input
+    [[nodiscard]] std::size_t offset() const noexcept {return pos_;}
+
+private:
+    friend class Document;
+    LazyValue(std::string_view input, std::size_t pos) noexcept : input_(input), pos_(pos) {}
+
+    std::string_view input_;
+    std::size_t pos_;
+    //where the last lookup ended: start of the member / element that was found (0 = nothing yet)
+    mutable std::size_t cursor_pos_ = 0;
+    mutable std::size_t cursor_index_ = 0;
+
+    //position of the member value for key / of the element, or npos
+    std::size_t find_member(std::string_view key) const;
+    std::size_t find_element(std::size_t index) const;
+    JsonValue scalar() const;
+};
+
+/*
+    a const Document can be read from several threads: its lookups start from a fresh copy of the
+    root, so they keep no memo. keep a LazyValue (auto root = doc.root()) to read fields in order
+*/
+class Document {
+public:
+    //throws ParseError if the input is empty / only whitespace, nothing else is checked here
+    explicit Document(std::string_view json);
+
+    //a copy, with a memo of its own
+    [[nodiscard]] LazyValue root() const noexcept {return LazyValue(root_.input_, root_.pos_);}
+    [[nodiscard]] LazyValue operator[](std::string_view key) const {return root()[key];}
+    [[nodiscard]] LazyValue operator[](std::size_t index) const {return root()[index];}
+
+private:
+    LazyValue root_;
+};
+
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef JSON_INCREMENTAL_HPP
+#define JSON_INCREMENTAL_HPP
+
+#include "json_parser/json.hpp"
+#include "json_parser/sax.hpp"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+
+namespace json {
+
+/*
+    push (incremental) parsing - for input that arrives in pieces, e.g. an http body in 16KB chunks.
+    feed() each chunk as it is received and call finish() once the input is complete; the document is
+    parsed while the rest of it is still on the way, and the chunks never have to be joined.
+
+    - chunks can be split anywhere: mid-string, mid-number, mid-literal, even inside a \uXXXX escape
+    - a chunk only has to live for the duration of its feed() call. the parser keeps just the state it
+      needs (open containers + the token in progress), so it never holds a copy of the whole input
+    - syntax errors throw ParseError as soon as the offending byte is fed (a number: once the byte after
+      it is, or at finish()). position() is the offset in the whole input, not in the chunk
+    - the result is the same as json::parse() on the concatenated input, and so is any ParseError:
+      the same message at the same position, wherever the chunks were cut
+    - feed() after finish() or after an error throws std::logic_error
+*/
+class IncrementalParser {
+public:
+    // every string, array and object of the result is allocated from 'resource' (must outlive the result)
+    explicit IncrementalParser(std::pmr::memory_resource& resource = *std::pmr::get_default_resource());
+    ~IncrementalParser();
+    IncrementalParser(IncrementalParser&&) noexcept;
+    IncrementalParser& operator=(IncrementalParser&&) noexcept;
+
+    void feed(std::string_view chunk);
+    void feed(const char* data, std::size_t size) {feed(std::string_view(data, size));}
+
+    // end of input - throws ParseError if the document is incomplete
+    [[nodiscard]] JsonValue finish();
+
+    // total number of bytes fed so far
+    [[nodiscard]] std::size_t bytes_consumed() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/*
+    the same push parser reporting to a SaxHandler instead of building a JsonValue.
+    string_views handed to the handler are only valid during the call (they may point into the
+    current chunk or into the parser's own buffer when a string spans chunks).
+*/
+class IncrementalSaxParser {
+public:
+    explicit IncrementalSaxParser(SaxHandler& handler);
+    ~IncrementalSaxParser();
+    IncrementalSaxParser(IncrementalSaxParser&&) noexcept;
+    IncrementalSaxParser& operator=(IncrementalSaxParser&&) noexcept;
+
+    // false once the handler has stopped the parse (later chunks are ignored)
+    bool feed(std::string_view chunk);
+    bool feed(const char* data, std::size_t size) {return feed(std::string_view(data, size));}
+
+    // end of input - true if the whole document was parsed, false if the handler stopped early
+    bool finish();
+
+    [[nodiscard]] std::size_t bytes_consumed() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}
+
+#endif
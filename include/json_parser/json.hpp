@@ -2,118 +2,218 @@
 #define JSON_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
-#include <variant>
+#include <initializer_list>
+#include <utility>
+#include <cstdint>
+#include <concepts>
+#include <type_traits>
 #include <stdexcept>
 #include <memory>
+#include <memory_resource>
+#include <cstring>
+#include <chrono>
 
 namespace json {
 
+/*
+    bump allocator for a whole document.
+    - allocation is a pointer bump inside the current block; blocks grow geometrically
+    - deallocate is a no-op, everything is handed back to upstream at once in release() / dtor,
+      or all but one block in reset()
+    - not thread safe (one arena per parse / request)
+
+    it is a std::pmr::memory_resource so the pmr containers & strings in JsonValue can use it directly.
+    note: destroying a JsonValue tree that lives in an arena still runs the destructors, but none of them
+    reach the global heap - freeing the memory itself is O(number of blocks) when the arena goes away.
+*/
+class Arena : public std::pmr::memory_resource {
+public:
+    explicit Arena(std::size_t initial_block_size = 4096,
+                   std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() override;
+
+    // hand every block back to upstream. anything allocated from the arena is invalid afterwards
+    void release() noexcept;
+    // start over for the next document but keep the largest block, so an arena reused for documents
+    // of similar size stops allocating from upstream. anything allocated from it is invalid afterwards
+    void reset() noexcept;
+
+    // bytes handed out to callers (not counting alignment padding / unused block tails)
+    [[nodiscard]] std::size_t bytes_used() const noexcept {return bytes_used_;}
+    [[nodiscard]] std::size_t block_count() const noexcept {return block_count_;}
+
+private:
+    struct Block {
+        Block* next;
+        std::size_t size; //usable bytes following the header
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+    void add_block(std::size_t min_size);
+
+    std::pmr::memory_resource* upstream_;
+    Block* head_ = nullptr;
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+    std::size_t next_block_size_;
+    std::size_t bytes_used_ = 0;
+    std::size_t block_count_ = 0;
+};
+
+class JsonObject;
+class Key;
+class Writer;
+
 class JsonValue {
 public:
     
     /*
-        notes on variants:
+        notes on the layout (this used to be a std::variant):
+        - the variant version was
+            std::variant<nullptr_t, bool, double, std::string, unique_ptr<JsonArray>, unique_ptr<JsonObject>>
+          so sizeof(JsonValue) was dictated by the inline string (+ tag), ~40-48 bytes per value.
+          an array of numbers paid that for every 8 byte double.
+        - now it is a C-style tagged union: 8 byte payload + 1 byte tag = 16 bytes.
+            null / bool / number live inline in the payload
+            string / array / object are pointers to out of line nodes
         - pros:
-            type safe at compile time
-            no heap allocation for variant itself
-            no manual memory management
-            std::visit for exhaustive handling
-        - cons:
-            size is largest member + tag (JsonObject is big)
-            recursive type requires forward declaration tricks
-            compile times can be slower, error msgs can be ugly
-
-        alternatives:
-        1. tagged union (C-style)
-            - full control over memory layout, smaller size (ptr instead of inline storage)
-            - faster compile time
-            BUT
-            - manual memory management (dtor, cpy, mv)
-            - increased complexity (easy to mess up - read wrong union member = UB) + more boilerplate
-        2. inheritance + polymorphism
-            - familar pattern, easy to extend with new types, visitor pattern works naturally
-            BUT
+            dense arrays (a JsonArray of numbers is 16 bytes/element), fewer cache misses on traversal
+            moves are a 16 byte copy + resetting the source, no variant visitation
+            full control over memory layout for later additions
+        - cons (same list as we had for the alternative before):
+            manual memory management (dtor, cpy, mv) - all in json.cpp
+            reading the wrong union member is UB, so every accessor checks type_ first
+            long strings cost one node allocation (the node stays in whichever memory resource the
+            string uses, see Arena). strings of up to kSmallString bytes are stored in the value itself,
+            and with ParseOptions::in_situ_strings escape free strings can point into the input instead
+
+        other alternatives we considered before (still not worth it):
+        1. inheritance + polymorphism
             - heap alloc for every value + virtual call overhead
-            - dynamic_cast or visitor for type access & more indirection
-        3. std::any
-            - simple, can hold anything
-            BUT
-            - no compile time type checking
-            - std::any_cast throws if wrong type, no exhaustive matching
-            - slower (type erased)
-
-        for production json libraries (nlohmann/json) they often used tagged unions for performance & control
+        2. std::any
+            - no compile time type checking, slower (type erased)
     */
 
+    /*
+        strings & containers are the std::pmr flavours so a whole tree can be allocated from one
+        memory resource (e.g. an Arena). default constructed ones use std::pmr::get_default_resource(),
+        which is plain new/delete unless the user changes it, so nothing changes for non arena users.
+    */
     using JsonNull = std::nullptr_t;
     using JsonBool = bool;
     using JsonNumber = double;
-    using JsonString = std::string;
-    using JsonArray = std::vector<JsonValue>;
-    using JsonObject = std::unordered_map<std::string, JsonValue>;
-
-    using Value = std::variant<
-        JsonNull, 
-        JsonBool, 
-        JsonNumber, 
-        JsonString, 
-        std::unique_ptr<JsonArray>, 
-        std::unique_ptr<JsonObject>
-    >;
-    /*
-        some notes on this particular variant implementation:
-        - std::vector<JsonValue> needs to know sizeof(JsonValue) to allocate storage
-        - std::unordered_map<...> needs complete JsonValue for its internal std::pair
-        - std::variant<> needs complete types to determine its size
-        
-        - so if we try to alias value = std::variant<..., JsonArray, JsonObject> we get a circular definition:
-            - JsonValue contains variant, variant contains JsonArray, JsonArray contains JsonValue, JsonValue is not complete yet.
-        
-        - wrapping in std::unique_ptr fixes this:
-            - compiler knows its size (its jsut a pointer)
-            - it only needs 'T' to be complete when you call -> or * or when the dtor runs (needs to call delete)
-            - note that both these happen in the source file (.cpp) where JsonValue is complete.
+    using JsonString = std::pmr::string;
+    using JsonArray = std::pmr::vector<JsonValue>;
+    //insertion ordered flat map, defined below (it stores JsonValues, so it needs the complete type)
+    using JsonObject = json::JsonObject;
 
-        - however, the trade off is that arrays and objects are now heap allocated.
-        
+    /*
+        - std::vector<JsonValue> needs to know sizeof(JsonValue) to allocate storage, and JsonValue isnt
+          complete inside its own definition, so containers can only be held by pointer.
+        - pointers are fine - the pointee only has to be complete where it is created / destroyed,
+          which is in member functions (class is complete there) and json.cpp.
+        - out of line nodes are allocated from the same resource as the string / container they hold,
+          and freed through p->get_allocator(), so heap and arena nodes can be mixed freely.
     */
+    /*
+        numbers come in three flavours:
+            Number - double (anything with a '.' or exponent, or an integer too big for 64 bits)
+            Int64  - integer literal that fits in std::int64_t
+            Uint64 - non negative integer literal above INT64_MAX that fits in std::uint64_t
+        is_number() is true for all three and as_number() converts integers to double, so code that
+        only cares about doubles keeps working. ids / timestamps use as_int64() / as_uint64() for the
+        exact value.
+        note: out of line types must stay last, the dtor checks type_ >= Type::String.
+    */
+    enum class Type : std::uint8_t {
+        Null,
+        Bool,
+        Number,
+        Int64,
+        Uint64,
+        String,
+        Array,
+        Object
+    };
     
     //constructors for each type
-    JsonValue() : value_(nullptr) {}
-    JsonValue(std::nullptr_t) : value_(nullptr) {}
-    JsonValue(bool b) : value_(b) {}
-    JsonValue(double n) : value_(n) {}
-    JsonValue(int n) : value_(static_cast<double>(n)) {}
-    JsonValue(const char* s) : value_(std::string(s)) {}
-    JsonValue(std::string s) : value_(std::move(s)) {}
-    JsonValue(JsonArray arr) : value_(std::make_unique<JsonArray>(std::move(arr))) {}
-    JsonValue(JsonObject obj) : value_(std::make_unique<JsonObject>(std::move(obj))) {}
-
-    //copy (unique ptr requires explicit copy)
+    JsonValue() noexcept : type_(Type::Null) {payload_.number = 0;}
+    JsonValue(std::nullptr_t) noexcept : JsonValue() {}
+    JsonValue(bool b) noexcept : type_(Type::Bool) {payload_.boolean = b;}
+    JsonValue(double n) noexcept : type_(Type::Number) {payload_.number = n;}
+    //any integer type (not bool / characters): signed -> Int64, unsigned -> Uint64
+    template <std::integral T>
+        requires (!std::same_as<T, bool> && !std::same_as<T, char> && !std::same_as<T, wchar_t> &&
+                  !std::same_as<T, char8_t> && !std::same_as<T, char16_t> && !std::same_as<T, char32_t>)
+    JsonValue(T n) noexcept {
+        if constexpr (std::is_signed_v<T>) {
+            type_ = Type::Int64;
+            payload_.int64 = static_cast<std::int64_t>(n);
+        } else {
+            type_ = Type::Uint64;
+            payload_.uint64 = static_cast<std::uint64_t>(n);
+        }
+    }
+    JsonValue(const char* s) : JsonValue(std::string_view(s), *std::pmr::get_default_resource()) {}
+    JsonValue(const std::string& s) : JsonValue(std::string_view(s), *std::pmr::get_default_resource()) {}
+    //copies s. strings longer than kSmallString are allocated from resource
+    JsonValue(std::string_view s, std::pmr::memory_resource& resource);
+    JsonValue(JsonString s);
+    /*
+        a string value that refers to s instead of copying it - s must outlive the value (and whatever
+        it is moved into). copying the value copies the string, like copying out of an arena.
+    */
+    [[nodiscard]] static JsonValue borrowed(std::string_view s);
+    //the node is allocated from the same resource as the container's own storage. an rvalue is moved
+    //into the node once (by value it was moved into the parameter first), an lvalue copied once
+    JsonValue(JsonArray&& arr) : type_(Type::Array) {payload_.array = make_node(std::move(arr));}
+    JsonValue(const JsonArray& arr) : JsonValue(JsonArray(arr)) {}
+    //defined after JsonObject
+    JsonValue(JsonObject&& obj);
+    JsonValue(const JsonObject& obj);
+
+    //copy (deep copy of the out of line nodes, O(1) for a shared value - see share())
     JsonValue(const JsonValue& other);
     JsonValue& operator=(const JsonValue& other);
 
-    //move (default is fine)
-    JsonValue(JsonValue&&) noexcept = default;
-    JsonValue& operator=(JsonValue&&) noexcept = default;
+    //move steals the payload and leaves other as null
+    JsonValue(JsonValue&& other) noexcept
+        : payload_(other.payload_), string_size_(other.string_size_), storage_(other.storage_), type_(other.type_) {
+        other.type_ = Type::Null;
+    }
+    JsonValue& operator=(JsonValue&& other) noexcept;
     
-    ~JsonValue() = default;
+    //scalars have nothing to free, keep that path inline so destroying a number array is cheap
+    ~JsonValue() {
+        if(type_ >= Type::String) destroy();
+    }
 
     //type checks
-    //noexcept because std::holds_alternative is noexcept (no alloc, no throw)
-    [[nodiscard]] bool is_null() const noexcept;
-    [[nodiscard]] bool is_bool() const noexcept;
-    [[nodiscard]] bool is_number() const noexcept;
-    [[nodiscard]] bool is_string() const noexcept;
-    [[nodiscard]] bool is_array() const noexcept;
-    [[nodiscard]] bool is_object() const noexcept;
+    //defined inline: they are a single compare and sit on every traversal path
+    [[nodiscard]] Type type() const noexcept {return type_;}
+    [[nodiscard]] bool is_null() const noexcept {return type_ == Type::Null;}
+    [[nodiscard]] bool is_bool() const noexcept {return type_ == Type::Bool;}
+    [[nodiscard]] bool is_number() const noexcept {return type_ >= Type::Number && type_ <= Type::Uint64;}
+    [[nodiscard]] bool is_integer() const noexcept {return type_ == Type::Int64 || type_ == Type::Uint64;}
+    [[nodiscard]] bool is_string() const noexcept {return type_ == Type::String;}
+    [[nodiscard]] bool is_array() const noexcept {return type_ == Type::Array;}
+    [[nodiscard]] bool is_object() const noexcept {return type_ == Type::Object;}
 
     //accessors (throw if wrong type)
     [[nodiscard]] bool as_bool() const;
-    [[nodiscard]] double as_number() const;
-    [[nodiscard]] const std::string& as_string() const;
+    [[nodiscard]] double as_number() const; //integers are converted (may round above 2^53)
+    [[nodiscard]] std::int64_t as_int64() const; //throws if not an integer or above INT64_MAX
+    [[nodiscard]] std::uint64_t as_uint64() const; //throws if not an integer or negative
+    //a view of the string, whichever way it is stored. valid until the value is changed or destroyed
+    [[nodiscard]] std::string_view as_string() const;
     [[nodiscard]] const JsonArray& as_array() const;
     [[nodiscard]] const JsonObject& as_object() const;
     //mutable accessors
@@ -125,28 +225,321 @@ public:
     [[nodiscard]] JsonValue& operator[](std::size_t index);
 
     //object access
-    [[nodiscard]] const JsonValue& operator[](const std::string& key) const;
-    [[nodiscard]] JsonValue& operator[](const std::string& key);
+    [[nodiscard]] const JsonValue& operator[](std::string_view key) const;
+    [[nodiscard]] JsonValue& operator[](std::string_view key);
+    //a key with its hash computed once (see Key), otherwise the same as with a string_view
+    [[nodiscard]] const JsonValue& operator[](const Key& key) const;
+    [[nodiscard]] JsonValue& operator[](const Key& key);
+    /*
+        the member 'key', or nullptr if there is none or this is not an object - for optional fields,
+        where at() / operator[] would throw (const) or insert (mutable). the mutable overloads unshare
+        like the other mutable accessors
+    */
+    [[nodiscard]] const JsonValue* find(std::string_view key) const noexcept;
+    [[nodiscard]] const JsonValue* find(const Key& key) const noexcept;
+    [[nodiscard]] JsonValue* find(std::string_view key);
+    [[nodiscard]] JsonValue* find(const Key& key);
 
     // size (for arrays and objs)
     [[nodiscard]] std::size_t size() const;
 
+    //deep equality, the one of JSON Patch's "test" (patch.hpp): numbers by value (an Int64 and a Uint64
+    //or double holding the same number are equal), objects regardless of member order
+    friend bool operator==(const JsonValue& a, const JsonValue& b) noexcept;
+
     //serialize back to JSON string
     [[nodiscard]] std::string dump(int indent = -1) const;
+    //same output, written to 'out' (writer.hpp) piece by piece instead of built up in one string
+    void dump_to(Writer& out, int indent = -1) const;
+
+    //the same value as CBOR (RFC 8949) - compact binary for service to service traffic, see from_cbor()
+    [[nodiscard]] std::string to_cbor() const;
+    void to_cbor(Writer& out) const;
+
+    /*
+        the value as an immutable, reference counted one: the string / array / object is moved (&&) or
+        deep copied (const&) into a node shared by every copy of the result, so copying it is a refcount
+        increment instead of a walk over the whole tree.
+            const json::JsonValue config = json::parse(text).share();
+            for(auto& w : workers) w.config = config;  //O(1) each
+        - const access reads the shared node. any number of threads can read and copy shared values, the
+          count is atomic and nothing else in the node is written while it is shared
+        - copy on write: a mutable accessor (as_array() / as_object() / non-const operator[], a mutable
+          Path::find) first gives this value its own deep copy of the node (or takes the node over if it
+          is the last reference), so writes never show through other copies
+        - it is one level: children of a shared value are plain values, copying one out of the tree is a
+          deep copy again. share() subtrees before putting them in a container to share them separately
+        - && keeps the memory resource the tree was built in (an Arena has to outlive every copy), const&
+          copies into the default resource. scalars have nothing to share, they come back as they are
+        - a borrowed() / in_situ string on its own is copied into the default resource by either one.
+          the strings inside an array / object are not: after && they still point into the input, which
+          has to outlive every copy
+    */
+    [[nodiscard]] JsonValue share() &&;
+    [[nodiscard]] JsonValue share() const&;
+    [[nodiscard]] bool is_shared() const noexcept {return type_ >= Type::String && storage_ == Storage::Shared;}
+
+    static constexpr std::size_t kSmallString = 8;
 
 
 private:  
-    Value value_;
-    void dump_impl(std::string& out, int indent, int current_indent) const;
+    struct SharedNode;  //json.cpp
+
+    union Payload {
+        bool boolean;
+        double number;
+        std::int64_t int64;
+        std::uint64_t uint64;
+        JsonString* string;
+        JsonArray* array;
+        JsonObject* object;
+        const char* view;
+        char small[kSmallString];
+        SharedNode* shared;
+    };
+    /*
+        how a String / Array / Object is stored:
+            Owned  - payload_.string / array / object, a node of its own
+            Small  - strings of up to kSmallString bytes in payload_.small, no allocation
+            View   - strings: payload_.view, string_size_ bytes owned by someone else (see borrowed())
+            Shared - payload_.shared, a refcounted node holding the Owned value (see share()). type_ is
+                     still the type of the value in it
+        string_size_ and storage_ sit in what used to be padding, so the value stays 16 bytes.
+    */
+    enum class Storage : std::uint8_t {Owned, Small, View, Shared};
+    Payload payload_;
+    std::uint32_t string_size_ = 0;  //Small / View strings
+    Storage storage_ = Storage::Owned;
+    Type type_;
+
+    void init_string(std::string_view s, std::pmr::memory_resource& resource);
+
+    template <typename T>
+    static T* make_node(T&& value) {
+        std::pmr::polymorphic_allocator<> alloc(value.get_allocator());
+        return alloc.new_object<T>(std::move(value));
+    }
+    //frees the out of line node (only called for string / array / object)
+    void destroy() noexcept;
+    //copy on write: makes a Shared value Owned before it is handed out mutably
+    void unshare();
+    void dump_impl(Writer& out, int indent, int current_indent) const;
 };
 
+static_assert(sizeof(JsonValue) <= 16, "JsonValue should stay a 16 byte tag + payload");
+
 // we alias in namespace for convenience
 using JsonNull = JsonValue::JsonNull;
 using JsonBool = JsonValue::JsonBool;
 using JsonNumber = JsonValue::JsonNumber;
 using JsonString = JsonValue::JsonString;
 using JsonArray = JsonValue::JsonArray;
-using JsonObject = JsonValue::JsonObject;
+
+class KeyPool;
+
+/*
+    an object key. 16 bytes, immutable, and one of:
+        Inline - up to 15 bytes, stored in the key itself (most keys are short)
+        Owned  - longer keys, the bytes are allocated from the owning object's memory resource
+        Pooled - a string interned in a KeyPool (see key_pool.hpp), shared by every object that uses it
+    - JsonKey does not free anything itself: owned keys are freed by their JsonObject. outside of the
+      object a JsonKey is a view, like std::string_view - it must not outlive the object it came from
+      (pooled keys: the pool)
+    - the only way to make one is through a JsonObject or KeyPool::intern(). it converts to
+      std::string_view for everything else.
+    - two pooled keys compare equal by pointer; pooled keys also carry the hash computed when they
+      were interned, so objects never rehash them
+*/
+class JsonKey {
+public:
+    static constexpr std::size_t kInlineCapacity = 15;
+
+    JsonKey() noexcept : bytes_{}, tag_(0) {}
+
+    [[nodiscard]] const char* data() const noexcept {
+        if(kind() == Kind::Inline) return bytes_;
+        const char* p;
+        std::memcpy(&p, bytes_, sizeof(p));
+        return p;
+    }
+    [[nodiscard]] std::size_t size() const noexcept {
+        if(kind() == Kind::Inline) return tag_ & kSizeMask;
+        std::uint32_t n;
+        std::memcpy(&n, bytes_ + sizeof(const char*), sizeof(n));
+        return n;
+    }
+    [[nodiscard]] bool empty() const noexcept {return size() == 0;}
+    [[nodiscard]] std::string_view view() const noexcept {return {data(), size()};}
+    operator std::string_view() const noexcept {return view();}
+
+    [[nodiscard]] bool is_pooled() const noexcept {return kind() == Kind::Pooled;}
+    //std::hash<std::string_view> of the key. stored for pooled keys, computed for the others
+    [[nodiscard]] std::size_t hash() const noexcept;
+
+    friend bool operator==(const JsonKey& a, const JsonKey& b) noexcept;
+    friend bool operator==(const JsonKey& a, std::string_view b) noexcept {return a.view() == b;}
+
+private:
+    friend class JsonObject;
+    friend class KeyPool;
+
+    enum class Kind : std::uint8_t {Inline, Owned, Pooled};
+    static constexpr std::uint8_t kSizeMask = 0x0f;
+
+    //inline: bytes_ holds the characters, tag_ the kind and the size.
+    //otherwise: bytes_ holds the pointer and a 32 bit size, tag_ only the kind
+    char bytes_[kInlineCapacity];
+    std::uint8_t tag_;
+
+    [[nodiscard]] Kind kind() const noexcept {return static_cast<Kind>(tag_ >> 4);}
+    static JsonKey make_inline(std::string_view s) noexcept;
+    static JsonKey make_external(Kind kind, const char* p, std::size_t n) noexcept;
+};
+
+static_assert(sizeof(JsonKey) == 16, "JsonKey should stay 16 bytes");
+
+/*
+    a key to look up, with its hash computed once - for the field names a hot path reads out of
+    every document:
+        static const json::Key kMethod("method");
+        if(const json::JsonValue* method = request.find(kMethod)) ...
+    - JsonKey is a key stored in an object, Key one that is looked up with. objects of kIndexThreshold
+      members and up are probed with the stored hash. smaller ones are scanned and never hash at all,
+      with a Key or without
+    - Key only views the characters: make it from a string literal, or a string that outlives it
+*/
+class Key {
+public:
+    explicit Key(std::string_view name) noexcept : name_(name), hash_(std::hash<std::string_view>{}(name)) {}
+
+    [[nodiscard]] std::string_view view() const noexcept {return name_;}
+    //std::hash<std::string_view> of the name, like JsonKey::hash()
+    [[nodiscard]] std::size_t hash() const noexcept {return hash_;}
+    operator std::string_view() const noexcept {return name_;}
+
+private:
+    std::string_view name_;
+    std::size_t hash_;
+};
+
+/*
+    object storage: the members in one contiguous vector, in insertion order.
+    - typical objects have 5-20 keys. std::unordered_map spent a node allocation per member plus a
+      bucket array on those, and dump() came out in hash order. here the parser reserves the exact
+      member count, so an object is one vector allocation (plus the index if it is large), and dump()
+      keeps the document order.
+    - lookup is a linear scan up to kIndexThreshold members. above that a hash index (open addressing,
+      slots hold position + 1, 0 = empty) is built next to the vector and kept up to date on insert.
+      erase is O(n) and rebuilds the index - objects are built far more often than they are edited.
+    - the interface is the part of std::unordered_map we used (find / at / [] / insert_or_assign /
+      emplace / erase / iteration over pair<key, value>), with std::string_view keys so looking up a
+      literal or std::string never builds a temporary string. a member is 32 bytes: JsonKey + JsonValue.
+    - keys given as a pooled JsonKey are shared, not copied, and lookups with one compare by pointer.
+    - allocator aware like the pmr containers: the vector, the index and every owned key use the
+      object's memory resource, and a copy goes back to the default resource (pooled keys stay shared,
+      so the pool has to outlive copies too).
+    - the members are pair<JsonKey, JsonValue>. the key is only non-const so the vector can move
+      members around - assigning to it through an iterator is not supported.
+*/
+class JsonObject {
+public:
+    using key_type = JsonKey;
+    using mapped_type = JsonValue;
+    using value_type = std::pair<JsonKey, JsonValue>;
+    using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+    using size_type = std::size_t;
+    using iterator = std::pmr::vector<value_type>::iterator;
+    using const_iterator = std::pmr::vector<value_type>::const_iterator;
+
+    static constexpr size_type kIndexThreshold = 16;
+
+    JsonObject() = default;
+    explicit JsonObject(const allocator_type& alloc) : entries_(alloc), index_(alloc) {}
+    JsonObject(std::initializer_list<std::pair<std::string_view, JsonValue>> init, const allocator_type& alloc = {});
+    //like the pmr containers, a plain copy uses the default resource
+    JsonObject(const JsonObject& other) : JsonObject(other, allocator_type()) {}
+    JsonObject(const JsonObject& other, const allocator_type& alloc);
+    JsonObject(JsonObject&& other) noexcept
+        : entries_(std::move(other.entries_)), index_(std::move(other.index_)) {
+        other.entries_.clear();
+        other.index_.clear();
+    }
+    //steals if alloc is other's allocator, copies otherwise
+    JsonObject(JsonObject&& other, const allocator_type& alloc);
+    JsonObject& operator=(const JsonObject& other);
+    JsonObject& operator=(JsonObject&& other);
+    ~JsonObject() {release_keys();}
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept {return entries_.get_allocator();}
+
+    [[nodiscard]] size_type size() const noexcept {return entries_.size();}
+    [[nodiscard]] bool empty() const noexcept {return entries_.empty();}
+    //also sizes the index when n reaches kIndexThreshold, so filling up to n never rehashes
+    void reserve(size_type n);
+    //slots (4 bytes each) of the index built for 'capacity' members, 0 below kIndexThreshold
+    [[nodiscard]] static size_type index_slots(size_type capacity) noexcept;
+    void clear() noexcept;
+
+    [[nodiscard]] iterator begin() noexcept {return entries_.begin();}
+    [[nodiscard]] iterator end() noexcept {return entries_.end();}
+    [[nodiscard]] const_iterator begin() const noexcept {return entries_.begin();}
+    [[nodiscard]] const_iterator end() const noexcept {return entries_.end();}
+    [[nodiscard]] const_iterator cbegin() const noexcept {return entries_.cbegin();}
+    [[nodiscard]] const_iterator cend() const noexcept {return entries_.cend();}
+
+    [[nodiscard]] iterator find(std::string_view key);
+    [[nodiscard]] const_iterator find(std::string_view key) const;
+    [[nodiscard]] iterator find(const JsonKey& key);
+    [[nodiscard]] const_iterator find(const JsonKey& key) const;
+    //key with its hash already computed (std::hash<std::string_view>, what JsonKey::hash() gives) -
+    //for keys that are looked up over and over, like the tokens of a Path (path.hpp)
+    [[nodiscard]] iterator find(std::string_view key, std::size_t hash);
+    [[nodiscard]] const_iterator find(std::string_view key, std::size_t hash) const;
+    [[nodiscard]] iterator find(const Key& key);
+    [[nodiscard]] const_iterator find(const Key& key) const;
+    [[nodiscard]] bool contains(std::string_view key) const;
+    [[nodiscard]] bool contains(const JsonKey& key) const;
+    [[nodiscard]] bool contains(const Key& key) const;
+    [[nodiscard]] size_type count(std::string_view key) const {return contains(key) ? 1 : 0;}
+    //throws std::out_of_range if missing
+    [[nodiscard]] JsonValue& at(std::string_view key);
+    [[nodiscard]] const JsonValue& at(std::string_view key) const;
+    [[nodiscard]] JsonValue& at(const Key& key);
+    [[nodiscard]] const JsonValue& at(const Key& key) const;
+    //inserts null if missing
+    JsonValue& operator[](std::string_view key);
+    JsonValue& operator[](const Key& key);
+
+    //overwrites an existing member (in place, it keeps its position). second is true if key was new
+    std::pair<iterator, bool> insert_or_assign(std::string_view key, JsonValue value);
+    std::pair<iterator, bool> insert_or_assign(const JsonKey& key, JsonValue value);
+    //leaves an existing member alone. second is true if key was new
+    std::pair<iterator, bool> emplace(std::string_view key, JsonValue value);
+    size_type erase(std::string_view key);
+    iterator erase(const_iterator pos);
+
+private:
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    std::pmr::vector<value_type> entries_;
+    std::pmr::vector<std::uint32_t> index_;
+
+    //K is std::string_view or JsonKey (pooled keys compare by pointer first)
+    template <typename K>
+    [[nodiscard]] size_type find_position(const K& key, std::size_t hash) const noexcept;
+    template <typename K>
+    [[nodiscard]] size_type find_position(const K& key) const noexcept;
+    [[nodiscard]] JsonKey make_key(std::string_view key);
+    [[nodiscard]] JsonKey copy_key(const JsonKey& key);
+    void release_key(const JsonKey& key) noexcept;
+    void release_keys() noexcept;
+    iterator append(JsonKey key, JsonValue&& value);
+    void index_slot(size_type position) noexcept;
+    void rebuild_index(size_type capacity);
+};
+
+inline JsonValue::JsonValue(JsonObject&& obj) : type_(Type::Object) {payload_.object = make_node(std::move(obj));}
+inline JsonValue::JsonValue(const JsonObject& obj) : JsonValue(JsonObject(obj)) {}
 
 // parser exception
 class ParseError : public std::runtime_error {
@@ -155,13 +548,157 @@ public:
         : std::runtime_error(msg + " at position " + std::to_string(pos)), position_(pos) {}
         
     [[nodiscard]] std::size_t position() const {return position_;}
-    
+
+protected:
+    //for derived errors that build their own message
+    struct Preformatted {};
+    ParseError(Preformatted, const std::string& what, std::size_t pos) : std::runtime_error(what), position_(pos) {}
+
 private:
     std::size_t position_;
 };
 
 // only expose public API of parser & hide implementation details in src file
-[[nodiscard]] JsonValue parse(const std::string& json);
+/*
+    parse takes a view so std::string, string literals and raw buffers all go through without a copy.
+    note: we dont keep a const std::string& overload alongside it - parse("...") would then be ambiguous
+    (const char* converts to both), and std::string already converts implicitly to std::string_view.
+*/
+[[nodiscard]] JsonValue parse(std::string_view json);
+// raw buffer (e.g. socket receive buffer, mmap'd file). does not need to be null terminated
+[[nodiscard]] JsonValue parse(const char* data, std::size_t size);
+/*
+    allocate every string / array / object of the document from 'resource' (typically an Arena).
+    the resource must outlive the returned value. copies of the value go back to the default resource,
+    so copying out of an arena is the way to keep something past the end of the request.
+*/
+[[nodiscard]] JsonValue parse(std::string_view json, std::pmr::memory_resource& resource);
+
+/*
+    knobs for parse(). the defaults are what the overloads without options do.
+    engine:
+        RecursiveDescent - one pass, byte at a time (with simd for whitespace / string bodies).
+                           the name is historical: the grammar is walked with an explicit stack now
+        StructuralIndex  - two passes: first a simd scan of the whole input in 64 byte blocks that
+                           records where every structural character / string / scalar starts, then a
+                           walk over that index that builds the document. needs 4 bytes of index per
+                           structural character; pays off on large inputs.
+    both engines accept exactly the same documents and build identical values.
+    in_situ_strings:
+        strings without escapes (and longer than JsonValue::kSmallString) are not copied - the values
+        point into the input, which then has to outlive the result. strings with escapes are still
+        decoded into the result's resource. copies of the result own all their strings.
+    key_pool:
+        intern object keys in this KeyPool (key_pool.hpp) instead of allocating them per object
+        (only keys too long to be stored inline).
+        the pool must outlive the result; it can be shared by parsers on other threads.
+    max_depth:
+        deepest nesting of arrays / objects accepted, one more level throws ParseError. neither engine
+        recurses, so parsing itself needs no stack per level. destroying, copying and dumping a
+        JsonValue do recurse though - the default keeps those safe on small (fiber / coroutine) stacks.
+    threads:
+        parse a document that is one big top-level array on this many threads (0: one per hardware
+        thread). a simd pre-scan finds the elements, chunks of them are parsed concurrently straight
+        into the result array. the result, and any ParseError, are the same as a serial parse.
+        inputs below kParallelMinBytes and other roots are parsed serially. so is every resource that is
+        not known to be thread safe: only new_delete_resource() (the default) and
+        std::pmr::synchronized_pool_resource are, unless thread_safe_resource says so. ignored by parse_sax.
+    thread_safe_resource:
+        the resource given to parse() can be used by several threads at once, so threads applies to it
+        too. an Arena, a monotonic_buffer_resource or an unsynchronized_pool_resource never is.
+    stats:
+        fill this ParseStats with what the parse did (see below). parses with stats run serially
+        (threads is ignored), parses without it do not run any of the counting code.
+    time_phases:
+        with stats, also time the phases of the parse. costs two clock reads per token, so it is for
+        sampled / diagnostic parses, not for every request.
+*/
+enum class ParseEngine : std::uint8_t {
+    RecursiveDescent,
+    StructuralIndex,
+};
+
+/*
+    what one parse() did, for metrics and for finding out where a slow parse spends its time.
+    - counts are of the input: keys counts every key, also duplicates that overwrote an earlier member
+    - allocations / bytes_allocated are what the document asked its memory resource for (nodes,
+      container buffers, long strings, owned keys). they are counted as the builder goes, so they are
+      the same whatever the resource is - an Arena serves them from its blocks
+    - after a ParseError the stats cover the input up to the error, bytes is the error position
+    - time is only measured with ParseOptions::time_phases. each clock read is charged to the phase
+      that was running, so the phases add up to the total:
+        whitespace - skipping whitespace between tokens
+        strings    - scanning (and unescaping) strings and keys
+        numbers    - scanning and converting numbers
+        build      - the document builder: values, containers, their allocations
+        index      - StructuralIndex only: the simd pass that builds the index (its second pass has
+                     no phases of its own and goes to build / other)
+        other      - the grammar itself: brackets, commas, literals
+*/
+struct ParseStats {
+    std::size_t bytes = 0;
+    std::size_t max_depth = 0;  //deepest nesting of arrays / objects, 0 for a scalar document
+    std::size_t nulls = 0;
+    std::size_t bools = 0;
+    std::size_t integers = 0;   //Int64 / Uint64
+    std::size_t doubles = 0;    //Number
+    std::size_t strings = 0;
+    std::size_t arrays = 0;
+    std::size_t objects = 0;
+    std::size_t keys = 0;
+    std::size_t allocations = 0;
+    std::size_t bytes_allocated = 0;
+
+    struct Phases {
+        std::chrono::nanoseconds whitespace{};
+        std::chrono::nanoseconds strings{};
+        std::chrono::nanoseconds numbers{};
+        std::chrono::nanoseconds build{};
+        std::chrono::nanoseconds index{};
+        std::chrono::nanoseconds other{};
+
+        [[nodiscard]] std::chrono::nanoseconds total() const noexcept {
+            return whitespace + strings + numbers + build + index + other;
+        }
+    } time;
+
+    [[nodiscard]] std::size_t values() const noexcept {
+        return nulls + bools + integers + doubles + strings + arrays + objects;
+    }
+};
+
+struct ParseOptions {
+    ParseEngine engine = ParseEngine::RecursiveDescent;
+    bool in_situ_strings = false;
+    KeyPool* key_pool = nullptr;
+    std::size_t max_depth = kDefaultMaxDepth;
+    unsigned threads = 1;
+    bool thread_safe_resource = false;
+    ParseStats* stats = nullptr;
+    bool time_phases = false;
+
+    static constexpr std::size_t kDefaultMaxDepth = 1024;
+    static constexpr std::size_t kParallelMinBytes = 1 << 20;
+};
+
+[[nodiscard]] JsonValue parse(std::string_view json, const ParseOptions& options);
+[[nodiscard]] JsonValue parse(std::string_view json, std::pmr::memory_resource& resource, const ParseOptions& options);
+
+/*
+    decode one CBOR (RFC 8949) item, e.g. from JsonValue::to_cbor(), into the same value parse() would
+    build from its JSON text. bytes is the encoded item and nothing else (trailing bytes are an error).
+    - JsonValue::to_cbor() writes every type so that it comes back as the same type (1.0 stays a Number,
+      1 an Int64), so from_cbor(v.to_cbor()).dump() == v.dump()
+    - from other encoders: indefinite lengths / chunked strings are fine, tags are ignored, undefined
+      becomes null. byte strings, non string keys and other simple values have no JSON equivalent and
+      throw ParseError (position() is the byte offset)
+    - options: key_pool, in_situ_strings (strings point into 'bytes') and max_depth as for parse().
+      engine and threads do not apply
+*/
+[[nodiscard]] JsonValue from_cbor(std::string_view bytes);
+[[nodiscard]] JsonValue from_cbor(std::string_view bytes, std::pmr::memory_resource& resource);
+[[nodiscard]] JsonValue from_cbor(std::string_view bytes, const ParseOptions& options);
+[[nodiscard]] JsonValue from_cbor(std::string_view bytes, std::pmr::memory_resource& resource, const ParseOptions& options);
 
 }
 
@@ -0,0 +1,51 @@
+#ifndef JSON_KEY_POOL_HPP
+#define JSON_KEY_POOL_HPP
+
+#include "json_parser/json.hpp"
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+namespace json {
+
+/*
+    shared intern table for object keys - for parsing many documents with the same schema.
+    with ParseOptions::key_pool set, every object key longer than JsonKey::kInlineCapacity is a
+    reference to the one pooled copy of that string, instead of "request_duration_ms" being allocated
+    again for every message. shorter keys are stored inside the key with no allocation at all, and
+    interning them would only add a lookup (they are still found by lookups with a pooled key).
+
+    - thread safe: any number of parsers on any number of threads can share one pool. a key that is
+      already in the pool costs a hash and a shared lock on one of kShards shards
+    - pooled strings never move and are only freed with the pool, so the pool must outlive every value
+      parsed with it - including copies (a copied object shares its pooled keys)
+    - the pool only grows. it is meant for the field names of a schema; interning unbounded data
+      (ids used as keys, ...) makes it grow forever
+    - pooled keys compare by pointer and carry their hash: looking up a key returned by intern()
+      (e.g. a static const JsonKey for a hot field) hashes nothing and compares no strings on a hit
+*/
+class KeyPool {
+public:
+    static constexpr std::size_t kShards = 16;
+
+    KeyPool();
+    KeyPool(const KeyPool&) = delete;
+    KeyPool& operator=(const KeyPool&) = delete;
+    ~KeyPool();
+
+    //the pooled copy of key (added if it is new)
+    [[nodiscard]] JsonKey intern(std::string_view key);
+
+    //number of distinct strings in the pool
+    [[nodiscard]] std::size_t size() const;
+    //bytes of string storage, including the per-string header
+    [[nodiscard]] std::size_t bytes_used() const;
+
+private:
+    struct Shard;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+}
+
+#endif
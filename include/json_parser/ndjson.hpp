@@ -0,0 +1,66 @@
+#ifndef JSON_NDJSON_HPP
+#define JSON_NDJSON_HPP
+
+#include "json_parser/json.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+/*
+    newline delimited json (ndjson / json lines): one document per line.
+
+    the input is cut into batches of whole lines which are parsed in parallel on a thread pool, one
+    reused parser per batch. results are still delivered strictly in input order, on the calling
+    thread, so the callback needs no locking.
+
+    - blank (whitespace only) lines are skipped, "\r\n" line endings are fine
+    - only a bounded number of batches is in flight at once, so memory stays proportional to
+      threads * batch_bytes rather than to the input size
+    - the first invalid line throws NdjsonError once every line before it has been delivered
+*/
+struct NdjsonOptions {
+    unsigned threads = 0;                   //0: one per hardware thread. 1: parse on the calling thread
+    std::size_t batch_bytes = 64 << 10;     //target size of a batch, rounded up to the end of a line.
+                                            //small enough that a batch is still in cache when it is delivered
+    KeyPool* key_pool = nullptr;            //intern keys of every record in this pool (see ParseOptions)
+    std::size_t max_depth = ParseOptions::kDefaultMaxDepth;  //nesting limit per record (see ParseOptions)
+};
+
+/*
+    a ParseError on one line of the input.
+    position() is the offset in the whole input, column() the offset within the line, line() is 1-based.
+    what() reads "line N: <parse error>" where the parse error's position is the column.
+*/
+class NdjsonError : public ParseError {
+public:
+    NdjsonError(const ParseError& error, std::size_t line, std::size_t line_offset)
+        : ParseError(Preformatted{}, "line " + std::to_string(line) + ": " + error.what(), line_offset + error.position()),
+          line_(line), column_(error.position()) {}
+
+    [[nodiscard]] std::size_t line() const {return line_;}
+    [[nodiscard]] std::size_t column() const {return column_;}
+
+private:
+    std::size_t line_;
+    std::size_t column_;
+};
+
+// gets each record and its 1-based line number; return false to stop (no further records are delivered)
+using NdjsonCallback = std::function<bool(JsonValue&& record, std::size_t line)>;
+
+// number of records delivered
+std::size_t parse_ndjson(std::string_view input, const NdjsonCallback& on_record, const NdjsonOptions& options = {});
+
+// all records, in order
+[[nodiscard]] std::vector<JsonValue> parse_ndjson(std::string_view input, const NdjsonOptions& options = {});
+
+// memory maps the file (reads it on platforms without mmap). throws std::runtime_error if it cannot be opened
+std::size_t parse_ndjson_file(const std::string& path, const NdjsonCallback& on_record, const NdjsonOptions& options = {});
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef JSON_PARSER_CONTEXT_HPP
+#define JSON_PARSER_CONTEXT_HPP
+
+#include "json_parser/json.hpp"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+
+namespace json {
+
+/*
+    parse state kept from one document to the next - for hot loops over many small documents (rpc
+    messages, queue entries), where json::parse() spends more on setting up than on the json:
+
+        json::ParserContext context;
+        for(const Message& m : messages) {
+            const json::JsonValue& doc = context.parse(m.body);
+            handle(doc["method"].as_string(), doc["params"]);
+        }
+
+    - json::parse() builds a new parser and builder per call, and with them their scratch string, the
+      stack of open containers and the builder's value / key stacks. a context keeps all of them (and
+      the structural index) with their capacity, once they have grown to fit the documents
+    - parse(json) builds the document in the context's own Arena, which is reset (keeping its largest
+      block) for every document, so once warmed up a parse allocates nothing at all. the document
+      belongs to the context: it is valid until the next parse(json) or the context's destruction.
+      copy it (or copy parts of it) to keep it longer - copies go to the default resource
+    - parse(json, resource) reuses the parser state only and returns an independent document
+      allocated from 'resource', like json::parse(json, resource, options)
+    - options: engine, in_situ_strings, key_pool and max_depth as for parse(). threads and stats do
+      not apply (the documents this is for are far below kParallelMinBytes)
+    - one context per thread: like an Arena it is not thread safe. a ParseError leaves it ready for
+      the next document
+*/
+class ParserContext {
+public:
+    explicit ParserContext(const ParseOptions& options = {}, std::pmr::memory_resource& upstream = *std::pmr::get_default_resource());
+    ~ParserContext();
+    ParserContext(ParserContext&&) noexcept;
+    ParserContext& operator=(ParserContext&&) noexcept;
+
+    JsonValue& parse(std::string_view json);
+    [[nodiscard]] JsonValue parse(std::string_view json, std::pmr::memory_resource& resource);
+
+    //the arena the documents of parse(json) live in (and get their memory from upstream)
+    [[nodiscard]] const Arena& arena() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}
+
+#endif
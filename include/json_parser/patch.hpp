@@ -0,0 +1,94 @@
+#ifndef JSON_PATCH_HPP
+#define JSON_PATCH_HPP
+
+#include "json_parser/json.hpp"
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace json {
+
+/*
+    an operation of a JSON Patch that could not be applied: a missing path, a failed "test", an
+    operation object without its members, ... operation() is the index of the operation in the patch
+*/
+class PatchError : public std::runtime_error {
+public:
+    PatchError(const std::string& msg, std::size_t operation)
+        : std::runtime_error("patch operation " + std::to_string(operation) + ": " + msg), operation_(operation) {}
+
+    [[nodiscard]] std::size_t operation() const {return operation_;}
+
+private:
+    std::size_t operation_;
+};
+
+/*
+    JSON Patch (RFC 6902): add, remove, replace, move, copy and test, applied to doc in place.
+    - paths are JSON Pointers (path.hpp). "-" is the end of an array for add (and for the target of
+      move / copy), an index may be at most the array's size there, otherwise it has to exist
+    - nothing is rebuilt or copied but what an operation changes: the containers on its path are
+      reached through the mutable accessors (so shared values are unshared along it, like Path::find),
+      "move" moves the value instead of copying it
+    - not atomic: when operation i throws a PatchError, operations 0 .. i-1 stay applied. patch a copy
+      (O(1) for a shared value) to get all or nothing
+    - patch must be an array (as_array() throws otherwise)
+*/
+void apply_patch(JsonValue& doc, const JsonValue& patch);
+
+/*
+    JSON Merge Patch (RFC 7386): members of an object patch are merged in recursively, null removes a
+    member, anything that is not an object replaces the target as a whole
+*/
+void apply_merge_patch(JsonValue& doc, const JsonValue& patch);
+
+/*
+    a document that is patched often and serialized after every change - a cached api response, a
+    config that is pushed to clients:
+
+        json::DumpCache cached(json::parse(text));
+        cached.apply_patch(json::parse(R"([{"op": "replace", "path": "/items/17/stock", "value": 3}])"));
+        send(cached.dump());  //only items/17, the items array and the root are serialized again
+
+    - the serialization is kept in fragments: a container whose text is at least fragment_bytes long
+      keeps its own text, its parent keeps the rest and where to splice it in. every byte is stored once
+    - changes go through the cache (apply_patch, apply_merge_patch, edit), which knows the containers
+      each one touches: those and the containers above them are serialized again by the next dump(),
+      every other fragment is appended as it is. a dump() with no change in between does nothing
+    - dump() is compact and byte for byte what value().dump() gives
+    - value() is read only: a change made around the cache is not seen by it
+*/
+class DumpCache {
+public:
+    static constexpr std::size_t kDefaultFragmentBytes = 512;
+
+    explicit DumpCache(JsonValue doc = JsonValue(), std::size_t fragment_bytes = kDefaultFragmentBytes);
+    ~DumpCache();
+    DumpCache(DumpCache&&) noexcept;
+    DumpCache& operator=(DumpCache&&) noexcept;
+
+    [[nodiscard]] const JsonValue& value() const noexcept;
+
+    //as the free functions, and with the same guarantee: on a PatchError the earlier operations stay
+    void apply_patch(const JsonValue& patch);
+    void apply_merge_patch(const JsonValue& patch);
+    //write access to the value at 'pointer' (throws std::out_of_range if there is none): it is
+    //serialized again as a whole. the reference is for this one change, the next call on the cache
+    //may not see changes made through it later
+    [[nodiscard]] JsonValue& edit(std::string_view pointer);
+
+    //the document, compact. valid until the next call that is not const
+    [[nodiscard]] const std::string& dump();
+    //bytes the last dump() serialized, not counting the fragments it reused
+    [[nodiscard]] std::size_t serialized_bytes() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}
+
+#endif
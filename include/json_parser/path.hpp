@@ -0,0 +1,68 @@
+#ifndef JSON_PATH_HPP
+#define JSON_PATH_HPP
+
+#include "json_parser/json.hpp"
+#include "json_parser/document.hpp"
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+/*
+    a JSON Pointer (RFC 6901), compiled once and evaluated against any number of documents:
+
+        static const json::Path price("/payload/items/0/price");
+        if(const json::JsonValue* p = price.find(msg)) total += p->as_number();
+
+    - the pointer is split into its tokens, ~1 / ~0 are unescaped and each token's key hash and array
+      index are worked out up front, so evaluating is one lookup per token and nothing else
+    - find() returns nullptr / nullopt when the path does not exist: a missing key, an index past the
+      end, or a token that runs into a scalar. nothing throws for a miss, unlike chained operator[]
+    - on an object a token is always a key (even "0"). on an array it has to be an index: digits without
+      leading zeros. "-" (RFC 6901: the element after the last one) never exists, lookups give nullptr
+    - "" is the whole document, "/" is the member with the empty key
+*/
+class Path {
+public:
+    //throws ParseError if 'pointer' is not a valid JSON Pointer (position() is the offset in it)
+    explicit Path(std::string_view pointer);
+
+    [[nodiscard]] const JsonValue* find(const JsonValue& root) const noexcept;
+    //unshares the containers it goes through (JsonValue::share()), so writes through the result are safe
+    [[nodiscard]] JsonValue* find(JsonValue& root) const;
+    //on the raw text (document.hpp): skips everything off the path. syntax errors on the path still
+    //throw ParseError, the way reading that value through LazyValue would
+    [[nodiscard]] std::optional<LazyValue> find(const LazyValue& root) const;
+    [[nodiscard]] std::optional<LazyValue> find(const Document& doc) const {return find(doc.root());}
+
+    //the pointer it was made from
+    [[nodiscard]] const std::string& str() const noexcept {return pointer_;}
+    //number of tokens (0 for "")
+    [[nodiscard]] std::size_t size() const noexcept {return tokens_.size();}
+    //the unescaped key of token i
+    [[nodiscard]] std::string_view operator[](std::size_t i) const {return tokens_[i].key;}
+    //the array index token i stands for, nullopt if it is not one ("-" included)
+    [[nodiscard]] std::optional<std::size_t> index(std::size_t i) const {
+        if(tokens_[i].index == kNoIndex) return std::nullopt;
+        return tokens_[i].index;
+    }
+
+private:
+    static constexpr std::size_t kNoIndex = static_cast<std::size_t>(-1);
+
+    struct Token {
+        std::string key;
+        std::size_t hash;   //std::hash<std::string_view> of key, see JsonObject::find(key, hash)
+        std::size_t index;  //kNoIndex if the token is not an array index
+    };
+
+    std::string pointer_;
+    std::vector<Token> tokens_;
+};
+
+}
+
+#endif
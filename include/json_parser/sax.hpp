@@ -0,0 +1,49 @@
+#ifndef JSON_SAX_HPP
+#define JSON_SAX_HPP
+
+#include "json_parser/json.hpp"
+#include <cstdint>
+#include <string_view>
+
+namespace json {
+
+/*
+    event based (SAX style) parsing - the same parser as json::parse(), but instead
+    of building a JsonValue it reports every token to a handler. memory use is constant in the size of
+    the document (apart from one byte per open container) and nothing is allocated per value.
+
+    - override only the events you care about, the defaults ignore the token and keep going
+    - return false from any event to stop the parse early (parse_sax then returns false)
+    - string_views are only valid for the duration of the call; copy them if you need to keep them.
+      strings without escapes point straight into the input, escaped ones into a reused scratch buffer
+    - by default the integer events forward to on_number, so a handler that only wants doubles
+      just overrides on_number
+    - syntax errors throw ParseError, exactly like json::parse()
+*/
+class SaxHandler {
+public:
+    virtual ~SaxHandler() = default;
+
+    virtual bool on_null() {return true;}
+    virtual bool on_bool(bool) {return true;}
+    virtual bool on_number(double) {return true;}
+    virtual bool on_int64(std::int64_t value) {return on_number(static_cast<double>(value));}
+    virtual bool on_uint64(std::uint64_t value) {return on_number(static_cast<double>(value));}
+    virtual bool on_string(std::string_view) {return true;}
+
+    virtual bool on_start_object() {return true;}
+    virtual bool on_key(std::string_view) {return true;}
+    virtual bool on_end_object() {return true;}
+
+    virtual bool on_start_array() {return true;}
+    virtual bool on_end_array() {return true;}
+};
+
+// true if the whole document was parsed, false if the handler stopped early
+[[nodiscard]] bool parse_sax(std::string_view json, SaxHandler& handler);
+// same, with the engine and max_depth from options (see ParseOptions)
+[[nodiscard]] bool parse_sax(std::string_view json, SaxHandler& handler, const ParseOptions& options);
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef JSON_VALIDATE_HPP
+#define JSON_VALIDATE_HPP
+
+#include "json_parser/json.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace json {
+
+/*
+    checking a document without parsing it - for a gateway that rejects bad requests before passing
+    the bytes on, or for input that is stored as it is:
+
+        json::validate(body);                    //throws json::ParseError, like parse()
+        if(!json::is_valid(body, limits)) ...
+
+    - exactly the grammar parse() accepts, with the same ParseError messages and positions: numbers,
+      escapes and \u digits, duplicate keys allowed, max_depth. a number that parse() would reject as
+      out of range (1e400) is rejected here too
+    - plus utf-8 (when limits.utf8 is set): every byte sequence of the document has to be valid RFC
+      3629 utf-8 - no overlong forms, no surrogates, nothing past U+10FFFF, nothing cut off. parse()
+      does not check this and keeps whatever bytes the strings hold. an invalid sequence is reported
+      as "invalid utf-8" at its first byte, unless a grammar error comes before it
+    - builds nothing and allocates nothing but the stack of open containers: strings are checked in
+      place and never decoded, numbers are scanned and (nearly always) not converted
+*/
+struct ValidationLimits {
+    //a longer document is rejected before a single byte is looked at
+    std::size_t max_bytes = SIZE_MAX;
+    std::size_t max_depth = ParseOptions::kDefaultMaxDepth;
+    bool utf8 = true;
+};
+
+void validate(std::string_view json, const ValidationLimits& limits = {});
+[[nodiscard]] bool is_valid(std::string_view json, const ValidationLimits& limits = {}) noexcept;
+
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef JSON_WRITER_HPP
+#define JSON_WRITER_HPP
+
+#include "json_parser/json.hpp"
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace json {
+
+/*
+    output sink for JsonValue::dump_to() - serializing without building the whole document in memory.
+
+    the serializer writes into a buffer window [cur_, end_) with plain memcpy / stores. only when the
+    window is full does it call overflow(), which the concrete writer implements by either handing the
+    bytes to its destination and reusing the buffer (fd, stream, callback) or growing (string).
+    so the virtual call happens once per buffer, not once per token.
+
+    - writers are not thread safe, and dump_to() does not flush: call flush() (or let the writer go out
+      of scope) once everything is written
+    - destructors flush but swallow errors, call flush() explicitly to see them
+*/
+class Writer {
+public:
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    virtual ~Writer() = default;
+
+    void write(std::string_view s) {
+        if(s.size() <= static_cast<std::size_t>(end_ - cur_)) {
+            if(!s.empty()) std::memcpy(cur_, s.data(), s.size());
+            cur_ += s.size();
+        } else {
+            write_slow(s);
+        }
+    }
+    void put(char c) {
+        if(cur_ == end_) overflow(1);
+        *cur_++ = c;
+    }
+    //n copies of c (indentation), without building a string for it
+    void fill(char c, std::size_t n);
+
+    //hand everything written so far to the destination
+    virtual void flush() {}
+
+protected:
+    Writer() = default;
+
+    //make room for at least one more byte (ideally 'needed'): flush or grow, then set_buffer()
+    virtual void overflow(std::size_t needed) = 0;
+    void set_buffer(char* begin, char* end) noexcept {
+        begin_ = cur_ = begin;
+        end_ = end;
+    }
+    [[nodiscard]] std::size_t buffered() const noexcept {return static_cast<std::size_t>(cur_ - begin_);}
+
+    char* begin_ = nullptr;
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+
+private:
+    void write_slow(std::string_view s);
+};
+
+// appends to a std::string (what dump() uses)
+class StringWriter : public Writer {
+public:
+    explicit StringWriter(std::string& out);
+    ~StringWriter() override {flush();}
+    //trims the string to what was written
+    void flush() override;
+
+protected:
+    void overflow(std::size_t needed) override;
+
+private:
+    std::string& out_;
+};
+
+/*
+    fixed size buffer that is drained to a destination whenever it fills up.
+    derived writers implement write_out() and must call flush_noexcept() in their own destructor.
+*/
+class BufferedWriter : public Writer {
+public:
+    static constexpr std::size_t kDefaultBufferSize = 64 << 10;
+
+    void flush() override;
+
+protected:
+    explicit BufferedWriter(std::size_t buffer_size);
+    //the destination. may throw
+    virtual void write_out(const char* data, std::size_t size) = 0;
+    void overflow(std::size_t needed) override;
+    //for destructors
+    void flush_noexcept() noexcept;
+
+private:
+    std::unique_ptr<char[]> buffer_;
+    std::size_t capacity_;
+};
+
+// std::ostream (ofstream, ostringstream, ...). throws std::ios_base::failure if the stream goes bad
+class StreamWriter : public BufferedWriter {
+public:
+    explicit StreamWriter(std::ostream& os, std::size_t buffer_size = kDefaultBufferSize);
+    ~StreamWriter() override {flush_noexcept();}
+
+protected:
+    void write_out(const char* data, std::size_t size) override;
+
+private:
+    std::ostream& os_;
+};
+
+// a file descriptor (file, pipe, socket) - retries short writes and EINTR, throws std::system_error
+class FdWriter : public BufferedWriter {
+public:
+    explicit FdWriter(int fd, std::size_t buffer_size = kDefaultBufferSize);
+    ~FdWriter() override {flush_noexcept();}
+
+protected:
+    void write_out(const char* data, std::size_t size) override;
+
+private:
+    int fd_;
+};
+
+// anything else (tls socket, compression stream, ...): sink is called with each full buffer
+class CallbackWriter : public BufferedWriter {
+public:
+    using Sink = std::function<void(std::string_view)>;
+    explicit CallbackWriter(Sink sink, std::size_t buffer_size = kDefaultBufferSize);
+    ~CallbackWriter() override {flush_noexcept();}
+
+protected:
+    void write_out(const char* data, std::size_t size) override;
+
+private:
+    Sink sink_;
+};
+
+}
+
+#endif
@@ -0,0 +1,197 @@
+#include "json_parser/bind.hpp"
+#include "parser.hpp"
+#include <vector>
+
+namespace json::detail {
+
+namespace {
+
+/*
+    Parser handler that writes into typed objects (see bind.hpp).
+    - 'next' is where the next value goes: the root at first, then whatever member the last key chose.
+      in an array every value goes into a freshly appended element instead
+    - a null target (unknown key) skips the value. containers under it get a Skip frame, so everything
+      inside is skipped as well and their end events still pop the right frame
+    - optionals are unwrapped when the value arrives: null resets the optional, anything else emplaces
+      it and goes on with its value type
+*/
+class BindHandler {
+public:
+    //errors are reported at the start of the value that does not fit, not where the parser is
+    static constexpr bool kTracksValueStart = true;
+
+    BindHandler(void* out, const TypeDesc& type) : next_{out, &type} {}
+
+    void attach(const Parser<BindHandler>& parser) noexcept {parser_ = &parser;}
+
+    bool on_null() {
+        Target t = take();
+        if(!t.type) return true;
+        if(t.type->kind != BindKind::Optional) fail("unexpected null");
+        t.type->clear(t.object);
+        return true;
+    }
+    bool on_bool(bool b) {
+        Target t = value_target();
+        if(!t.type) return true;
+        if(t.type->kind != BindKind::Bool) fail(expected(*t.type));
+        t.type->set_bool(t.object, b);
+        return true;
+    }
+    bool on_int64(std::int64_t i) {
+        Target t = value_target();
+        if(!t.type) return true;
+        switch(t.type->kind) {
+            case BindKind::Signed:
+                if(i < t.type->min || (i > 0 && static_cast<std::uint64_t>(i) > t.type->max)) fail("integer out of range");
+                t.type->set_signed(t.object, i);
+                break;
+            case BindKind::Unsigned:
+                if(i < 0 || static_cast<std::uint64_t>(i) > t.type->max) fail("integer out of range");
+                t.type->set_unsigned(t.object, static_cast<std::uint64_t>(i));
+                break;
+            case BindKind::Float:
+                t.type->set_double(t.object, static_cast<double>(i));
+                break;
+            default:
+                fail(expected(*t.type));
+        }
+        return true;
+    }
+    //only above INT64_MAX
+    bool on_uint64(std::uint64_t u) {
+        Target t = value_target();
+        if(!t.type) return true;
+        switch(t.type->kind) {
+            case BindKind::Unsigned:
+                if(u > t.type->max) fail("integer out of range");
+                t.type->set_unsigned(t.object, u);
+                break;
+            case BindKind::Signed:
+                fail("integer out of range");
+            case BindKind::Float:
+                t.type->set_double(t.object, static_cast<double>(u));
+                break;
+            default:
+                fail(expected(*t.type));
+        }
+        return true;
+    }
+    bool on_number(double d) {
+        Target t = value_target();
+        if(!t.type) return true;
+        if(t.type->kind != BindKind::Float) fail(expected(*t.type));
+        t.type->set_double(t.object, d);
+        return true;
+    }
+    bool on_string(std::string_view s) {
+        Target t = value_target();
+        if(!t.type) return true;
+        if(t.type->kind != BindKind::String) fail(expected(*t.type));
+        t.type->set_string(t.object, s);
+        return true;
+    }
+    bool on_key(std::string_view k) {
+        const Frame& frame = frames_.back();
+        if(frame.kind != BindKind::Struct) return true;  //skipped object
+        const FieldDesc* field = find_field(*frame.type, k);
+        next_ = field ? Target{field->member(frame.object), &field->type()} : Target{};
+        return true;
+    }
+    bool on_start_object() {
+        Target t = value_target();
+        if(!t.type) {
+            frames_.push_back(Frame{kSkip, nullptr, nullptr});
+            return true;
+        }
+        if(t.type->kind != BindKind::Struct) fail(expected(*t.type));
+        frames_.push_back(Frame{BindKind::Struct, t.object, t.type});
+        return true;
+    }
+    bool on_start_array() {
+        Target t = value_target();
+        if(!t.type) {
+            frames_.push_back(Frame{kSkip, nullptr, nullptr});
+            return true;
+        }
+        if(t.type->kind != BindKind::Array) fail(expected(*t.type));
+        t.type->clear(t.object);
+        frames_.push_back(Frame{BindKind::Array, t.object, t.type});
+        return true;
+    }
+    bool on_end_object() {frames_.pop_back(); return true;}
+    bool on_end_array() {frames_.pop_back(); return true;}
+
+private:
+    //not a BindKind of any type: the frame of a container that is skipped
+    static constexpr BindKind kSkip = static_cast<BindKind>(0xff);
+
+    struct Target {
+        void* object = nullptr;
+        const TypeDesc* type = nullptr;  //nullptr: skip the value
+    };
+    struct Frame {
+        BindKind kind;
+        void* object;
+        const TypeDesc* type;
+    };
+
+    const Parser<BindHandler>* parser_ = nullptr;
+    Target next_;
+    std::vector<Frame> frames_;
+
+    [[noreturn]] void fail(const char* message) const {
+        throw ParseError(message, parser_->value_start());
+    }
+
+    static const char* expected(const TypeDesc& type) noexcept {
+        switch(type.kind) {
+            case BindKind::Bool: return "expected a bool";
+            case BindKind::Signed: case BindKind::Unsigned: return "expected an integer";
+            case BindKind::Float: return "expected a number";
+            case BindKind::String: return "expected a string";
+            case BindKind::Array: return "expected an array";
+            case BindKind::Struct: return "expected an object";
+            default: return "unexpected value";
+        }
+    }
+
+    static const FieldDesc* find_field(const TypeDesc& type, std::string_view key) noexcept {
+        std::uint8_t slot = type.slots[key_hash(key, type.seed) & type.mask];
+        if(slot == 0) return nullptr;
+        const FieldDesc& field = type.fields[slot - 1];
+        return field.name == key ? &field : nullptr;
+    }
+
+    //where the value that is starting goes
+    Target take() {
+        if(!frames_.empty()) {
+            const Frame& frame = frames_.back();
+            if(frame.kind == kSkip) return {};
+            if(frame.kind == BindKind::Array) return {frame.type->append(frame.object), &frame.type->element()};
+        }
+        Target t = next_;
+        next_ = {};
+        return t;
+    }
+
+    //same for anything but null: optionals on the way get a value
+    Target value_target() {
+        Target t = take();
+        while(t.type && t.type->kind == BindKind::Optional) {
+            t = {t.type->append(t.object), &t.type->element()};
+        }
+        return t;
+    }
+};
+
+}
+
+void bind_json(std::string_view json, void* out, const TypeDesc& type, std::size_t max_depth) {
+    BindHandler handler(out, type);
+    Parser<BindHandler> parser(json, handler, max_depth);
+    handler.attach(parser);
+    parser.parse();
+}
+
+}
@@ -0,0 +1,107 @@
+#include "json_parser/builder.hpp"
+#include "dom_builder.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace json {
+
+/*
+    DomBuilder trusts its caller to be the parser, so the checks the grammar would make are done here:
+    open is the kind of every open container, key_ready whether the innermost object has a key
+    waiting for its value
+*/
+struct Builder::Impl {
+    Impl(std::pmr::memory_resource* resource, KeyPool* key_pool) : builder(resource, key_pool) {}
+
+    enum class Open : std::uint8_t {Array, Object};
+
+    detail::DomBuilder builder;
+    std::vector<Open> open;
+    bool key_ready = false;
+    bool has_root = false;
+
+    //before anything that is a value (a scalar or the start of a container)
+    void value_allowed() {
+        if(open.empty()) {
+            if(has_root) throw std::logic_error("the document already has a root value");
+            has_root = true;
+        } else if(open.back() == Open::Object) {
+            if(!key_ready) throw std::logic_error("expected a key in an object");
+            key_ready = false;
+        }
+    }
+    void close(Open kind) {
+        if(open.empty() || open.back() != kind) {
+            throw std::logic_error(kind == Open::Array ? "end_array() without an open array" : "end_object() without an open object");
+        }
+        if(key_ready) throw std::logic_error("a key without a value");
+        open.pop_back();
+    }
+};
+
+Builder::Builder(std::pmr::memory_resource& resource, KeyPool* key_pool) : impl_(std::make_unique<Impl>(&resource, key_pool)) {}
+Builder::~Builder() = default;
+Builder::Builder(Builder&&) noexcept = default;
+Builder& Builder::operator=(Builder&&) noexcept = default;
+
+Builder& Builder::begin_array() {
+    impl_->value_allowed();
+    impl_->open.push_back(Impl::Open::Array);
+    impl_->builder.on_start_array();
+    return *this;
+}
+
+Builder& Builder::end_array() {
+    impl_->close(Impl::Open::Array);
+    impl_->builder.on_end_array();
+    return *this;
+}
+
+Builder& Builder::begin_object() {
+    impl_->value_allowed();
+    impl_->open.push_back(Impl::Open::Object);
+    impl_->builder.on_start_object();
+    return *this;
+}
+
+Builder& Builder::end_object() {
+    impl_->close(Impl::Open::Object);
+    impl_->builder.on_end_object();
+    return *this;
+}
+
+Builder& Builder::key(std::string_view k) {
+    if(impl_->open.empty() || impl_->open.back() != Impl::Open::Object) {
+        throw std::logic_error("key() outside an object");
+    }
+    if(impl_->key_ready) throw std::logic_error("a key without a value");
+    impl_->key_ready = true;
+    impl_->builder.on_key(k);
+    return *this;
+}
+
+Builder& Builder::value(JsonValue v) {
+    impl_->value_allowed();
+    impl_->builder.on_value(std::move(v));
+    return *this;
+}
+
+Builder& Builder::value(std::string_view s) {
+    impl_->value_allowed();
+    impl_->builder.on_string(s);
+    return *this;
+}
+
+Builder& Builder::reserve(std::size_t n) {
+    impl_->builder.reserve(n);
+    return *this;
+}
+
+JsonValue Builder::take() {
+    if(!impl_->open.empty()) throw std::logic_error("take() with containers still open");
+    impl_->has_root = false;
+    return impl_->builder.take();
+}
+
+}
@@ -0,0 +1,443 @@
+#include "json_parser/json.hpp"
+#include "json_parser/writer.hpp"
+#include "json_parser/key_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace json {
+
+namespace {
+
+/*
+    notes on the encoding (RFC 8949):
+    - every item starts with a head: 3 bits of major type + 5 bits of "additional info". info < 24 is
+      the argument itself, 24..27 say it follows in 1/2/4/8 big endian bytes, 31 is indefinite length
+    - the JsonValue types map onto major types one to one:
+        Int64 / Uint64  -> 0 (unsigned) or 1 (negative, argument is -1 - n)
+        String          -> 3 (utf-8 text), Array -> 4, Object -> 5 (text keys only)
+        Null / Bool     -> 7 simple values 22 / 20, 21
+        Number          -> 7 floats: the shortest of half / single / double that holds the exact value
+      so a round trip keeps the type too: 1.0 comes back as a Number, 1 as an Int64
+    - we always write definite lengths (we know every size up front). the decoder also takes what
+      other (streaming) encoders write: indefinite lengths and chunked strings. tags are skipped,
+      the tagged item is decoded as if it was untagged
+*/
+enum Major : std::uint8_t {
+    kUnsigned = 0,
+    kNegative = 1,
+    kBytes = 2,
+    kText = 3,
+    kArray = 4,
+    kMap = 5,
+    kTag = 6,
+    kSimple = 7,
+};
+
+constexpr std::uint8_t kFalse = 0xf4;
+constexpr std::uint8_t kTrue = 0xf5;
+constexpr std::uint8_t kNull = 0xf6;
+constexpr std::uint8_t kUndefined = 0xf7;
+constexpr std::uint8_t kHalf = 0xf9;
+constexpr std::uint8_t kSingle = 0xfa;
+constexpr std::uint8_t kDouble = 0xfb;
+constexpr std::uint8_t kBreak = 0xff;
+constexpr std::uint8_t kIndefinite = 31;
+
+void write_be(Writer& out, std::uint8_t initial, std::uint64_t value, int bytes) {
+    char buf[9];
+    buf[0] = static_cast<char>(initial);
+    for(int i = bytes; i > 0; --i) {
+        buf[i] = static_cast<char>(value & 0xff);
+        value >>= 8;
+    }
+    out.write(std::string_view(buf, static_cast<std::size_t>(bytes) + 1));
+}
+
+//shortest head for the argument, as RFC 8949 "preferred serialization" asks
+void write_head(Writer& out, Major major, std::uint64_t arg) {
+    std::uint8_t m = static_cast<std::uint8_t>(major << 5);
+    if(arg < 24) {
+        out.put(static_cast<char>(m | arg));
+    } else if(arg <= 0xff) {
+        write_be(out, m | 24, arg, 1);
+    } else if(arg <= 0xffff) {
+        write_be(out, m | 25, arg, 2);
+    } else if(arg <= 0xffffffff) {
+        write_be(out, m | 26, arg, 4);
+    } else {
+        write_be(out, m | 27, arg, 8);
+    }
+}
+
+//the half precision (binary16) encoding of d, if it holds d exactly
+bool to_half(double d, std::uint16_t& half) {
+    std::uint16_t sign = std::signbit(d) ? 0x8000 : 0;
+    if(std::isnan(d)) {
+        half = 0x7e00;
+        return true;
+    }
+    if(std::isinf(d)) {
+        half = sign | 0x7c00;
+        return true;
+    }
+    double a = std::fabs(d);
+    if(a == 0) {
+        half = sign;
+        return true;
+    }
+    int e = std::ilogb(a);
+    if(e > 15 || e < -24) return false;
+    if(e >= -14) {
+        //normal: 1.mmmmmmmmmm * 2^e
+        double m = std::ldexp(a, 10 - e);
+        if(m != std::floor(m)) return false;
+        half = static_cast<std::uint16_t>(sign | (e + 15) << 10 | (static_cast<unsigned>(m) - 1024));
+    } else {
+        //subnormal: 0.mmmmmmmmmm * 2^-14
+        double m = std::ldexp(a, 24);
+        if(m != std::floor(m)) return false;
+        half = static_cast<std::uint16_t>(sign | static_cast<unsigned>(m));
+    }
+    return true;
+}
+
+double from_half(std::uint16_t half) {
+    int exponent = (half >> 10) & 0x1f;
+    int mantissa = half & 0x3ff;
+    double d;
+    if(exponent == 0) {
+        d = std::ldexp(mantissa, -24);
+    } else if(exponent == 31) {
+        d = mantissa == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+    } else {
+        d = std::ldexp(mantissa + 1024, exponent - 25);
+    }
+    return (half & 0x8000) ? -d : d;
+}
+
+void write_number(Writer& out, double d) {
+    std::uint16_t half;
+    if(to_half(d, half)) {
+        write_be(out, kHalf, half, 2);
+        return;
+    }
+    //the range check first: converting a double beyond FLT_MAX to float is undefined
+    if(std::fabs(d) <= std::numeric_limits<float>::max() && static_cast<double>(static_cast<float>(d)) == d) {
+        float f = static_cast<float>(d);
+        std::uint32_t bits;
+        std::memcpy(&bits, &f, sizeof bits);
+        write_be(out, kSingle, bits, 4);
+        return;
+    }
+    std::uint64_t bits;
+    std::memcpy(&bits, &d, sizeof bits);
+    write_be(out, kDouble, bits, 8);
+}
+
+void write_text(Writer& out, std::string_view s) {
+    write_head(out, kText, s.size());
+    out.write(s);
+}
+
+/*
+    notes on decoding:
+    - CBOR gives the size of every array / object up front, so unlike Parser (which has to stack the
+      values in a DomBuilder until it sees the closing bracket) we build the containers directly: each
+      one is reserved at its exact size and its items are decoded straight into it. a new container is
+      placed in its parent first and then filled through its node, which stays where it is however the
+      parent (or the value holding it) moves
+    - sizes are only trusted as far as the input reaches (every item takes at least a byte), so a
+      hostile "array of 2^64 items" reserves what the input could hold and then runs out of input
+    - key_pool, in_situ_strings (text is raw utf-8 in the input, so every definite length string can be
+      borrowed) and duplicate keys (last one wins, at the first one's position) behave like parse()
+    - no recursion: open containers are frames on an explicit stack, like Parser
+    - errors are ParseErrors, position() is the byte offset of the offending item
+*/
+class CborDecoder {
+public:
+    CborDecoder(std::string_view input, std::pmr::memory_resource& resource, const ParseOptions& options)
+        : input_(input), resource_(resource), key_pool_(options.key_pool), max_depth_(options.max_depth),
+          in_situ_(options.in_situ_strings) {}
+
+    JsonValue parse() {
+        while(true) {
+            if(!stack_.empty()) {
+                Frame& frame = stack_.back();
+                bool done = frame.indefinite ? at_break() : frame.remaining == 0;
+                if(done) {
+                    if(frame.indefinite) ++pos_;
+                    stack_.pop_back();
+                    if(stack_.empty()) break;
+                    continue;
+                }
+                --frame.remaining;
+                if(frame.object) read_key();
+            }
+            if(read_value() && stack_.empty()) break;
+        }
+        if(pos_ != input_.size()) {
+            throw ParseError("unexpected data after CBOR item", pos_);
+        }
+        return std::move(root_);
+    }
+
+private:
+    struct Head {
+        std::uint8_t major;
+        std::uint8_t info;
+        std::uint64_t arg;
+    };
+    //an open container: exactly one of array / object is set
+    struct Frame {
+        JsonArray* array;
+        JsonObject* object;
+        std::uint64_t remaining;
+        bool indefinite;
+    };
+
+    std::string_view input_;
+    std::pmr::memory_resource& resource_;
+    KeyPool* key_pool_;
+    std::size_t max_depth_;
+    bool in_situ_;
+    std::size_t pos_ = 0;
+    JsonValue root_;
+    std::vector<Frame> stack_;
+    std::string_view key_;
+    //chunked strings are joined here. keys get their own, the key must survive decoding its value
+    std::string scratch_;
+    std::string key_scratch_;
+
+    bool at_break() const {
+        if(pos_ >= input_.size()) throw ParseError("unexpected end of input", pos_);
+        return static_cast<std::uint8_t>(input_[pos_]) == kBreak;
+    }
+
+    std::uint64_t read_be(int bytes) {
+        if(input_.size() - pos_ < static_cast<std::size_t>(bytes)) {
+            throw ParseError("unexpected end of input", input_.size());
+        }
+        std::uint64_t value = 0;
+        for(int i = 0; i < bytes; ++i) {
+            value = value << 8 | static_cast<std::uint8_t>(input_[pos_++]);
+        }
+        return value;
+    }
+
+    //the next head, tags skipped. 'start' is where the item began (for errors)
+    Head read_head(std::size_t& start) {
+        while(true) {
+            start = pos_;
+            if(pos_ >= input_.size()) throw ParseError("unexpected end of input", pos_);
+            std::uint8_t initial = static_cast<std::uint8_t>(input_[pos_++]);
+            Head head{static_cast<std::uint8_t>(initial >> 5), static_cast<std::uint8_t>(initial & 0x1f), 0};
+            if(head.info < 24) {
+                head.arg = head.info;
+            } else if(head.info <= 27) {
+                head.arg = read_be(1 << (head.info - 24));
+            } else if(head.info != kIndefinite || head.major == kUnsigned || head.major == kNegative || head.major == kTag) {
+                throw ParseError("invalid CBOR item", start);
+            }
+            if(head.major != kTag) return head;
+        }
+    }
+
+    std::string_view read_bytes(std::uint64_t size, std::size_t start) {
+        if(size > input_.size() - pos_) throw ParseError("unexpected end of input", start);
+        std::string_view s = input_.substr(pos_, static_cast<std::size_t>(size));
+        pos_ += static_cast<std::size_t>(size);
+        return s;
+    }
+
+    //text string body after its head: a view into the input, or the chunks joined in 'joined'
+    std::string_view read_text(const Head& head, std::size_t start, std::string& joined) {
+        if(head.info != kIndefinite) return read_bytes(head.arg, start);
+        joined.clear();
+        while(!at_break()) {
+            std::size_t chunk_start;
+            Head chunk = read_head(chunk_start);
+            if(chunk.major != kText || chunk.info == kIndefinite) {
+                throw ParseError("invalid text string chunk", chunk_start);
+            }
+            joined.append(read_bytes(chunk.arg, chunk_start));
+        }
+        ++pos_;
+        return joined;
+    }
+
+    void read_key() {
+        std::size_t start;
+        Head head = read_head(start);
+        if(head.major != kText) throw ParseError("expected string key", start);
+        key_ = read_text(head, start, key_scratch_);
+    }
+
+    //puts a finished value where it belongs: the root, the end of the open array or under key_
+    JsonValue& place(JsonValue value) {
+        if(stack_.empty()) {
+            root_ = std::move(value);
+            return root_;
+        }
+        Frame& frame = stack_.back();
+        if(frame.array) {
+            frame.array->push_back(std::move(value));
+            return frame.array->back();
+        }
+        //short keys are stored inline in the object anyway - the pool would only add a lookup
+        if(key_pool_ && key_.size() > JsonKey::kInlineCapacity) {
+            return frame.object->insert_or_assign(key_pool_->intern(key_), std::move(value)).first->second;
+        }
+        return frame.object->insert_or_assign(key_, std::move(value)).first->second;
+    }
+
+    void place_string(std::string_view s, bool borrowable) {
+        if(borrowable && in_situ_ && s.size() > JsonValue::kSmallString && s.size() <= UINT32_MAX) {
+            place(JsonValue::borrowed(s));
+        } else {
+            place(JsonValue(s, resource_));
+        }
+    }
+
+    void open(const Head& head, std::size_t start, bool object) {
+        if(stack_.size() >= max_depth_) {
+            throw ParseError("maximum nesting depth exceeded", start);
+        }
+        bool indefinite = head.info == kIndefinite;
+        //an item is at least 1 byte, a member at least 2
+        std::size_t fits = (input_.size() - pos_) / (object ? 2 : 1);
+        std::size_t reserve = indefinite ? 0 : static_cast<std::size_t>(std::min<std::uint64_t>(head.arg, fits));
+        if(object) {
+            JsonObject& obj = place(JsonValue(JsonObject(&resource_))).as_object();
+            obj.reserve(reserve);
+            stack_.push_back(Frame{nullptr, &obj, head.arg, indefinite});
+        } else {
+            JsonArray& arr = place(JsonValue(JsonArray(&resource_))).as_array();
+            arr.reserve(reserve);
+            stack_.push_back(Frame{&arr, nullptr, head.arg, indefinite});
+        }
+    }
+
+    //returns true if the value is complete (false: a container was opened)
+    bool read_value() {
+        std::size_t start;
+        Head head = read_head(start);
+        switch(head.major) {
+            case kUnsigned:
+                if(head.arg <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                    place(JsonValue(static_cast<std::int64_t>(head.arg)));
+                } else {
+                    place(JsonValue(head.arg));
+                }
+                return true;
+            case kNegative:
+                //-1 - arg. below INT64_MIN it becomes a double, like a too big integer literal in JSON text
+                if(head.arg <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                    place(JsonValue(-1 - static_cast<std::int64_t>(head.arg)));
+                } else {
+                    place(JsonValue(-1.0 - static_cast<double>(head.arg)));
+                }
+                return true;
+            case kBytes:
+                throw ParseError("byte strings have no JSON equivalent", start);
+            case kText:
+                place_string(read_text(head, start, scratch_), head.info != kIndefinite);
+                return true;
+            case kArray:
+                open(head, start, false);
+                return false;
+            case kMap:
+                open(head, start, true);
+                return false;
+            default:
+                break;
+        }
+        //major 7
+        switch(static_cast<std::uint8_t>(input_[start])) {
+            case kFalse: place(JsonValue(false)); return true;
+            case kTrue: place(JsonValue(true)); return true;
+            //undefined has no JSON equivalent either, RFC 8949 (6.1) suggests null
+            case kNull: case kUndefined: place(JsonValue()); return true;
+            case kHalf: place(JsonValue(from_half(static_cast<std::uint16_t>(head.arg)))); return true;
+            case kSingle: {
+                std::uint32_t bits = static_cast<std::uint32_t>(head.arg);
+                float f;
+                std::memcpy(&f, &bits, sizeof f);
+                place(JsonValue(static_cast<double>(f)));
+                return true;
+            }
+            case kDouble: {
+                double d;
+                std::memcpy(&d, &head.arg, sizeof d);
+                place(JsonValue(d));
+                return true;
+            }
+            case kBreak:
+                throw ParseError("unexpected break", start);
+            default:
+                throw ParseError("unsupported simple value", start);
+        }
+    }
+};
+
+}
+
+std::string JsonValue::to_cbor() const {
+    std::string out;
+    {
+        StringWriter writer(out);
+        to_cbor(writer);
+    }
+    return out;
+}
+
+void JsonValue::to_cbor(Writer& out) const {
+    switch(type_) {
+        case Type::Null: out.put(static_cast<char>(kNull)); break;
+        case Type::Bool: out.put(static_cast<char>(payload_.boolean ? kTrue : kFalse)); break;
+        case Type::Number: write_number(out, payload_.number); break;
+        case Type::Int64:
+            if(payload_.int64 >= 0) {
+                write_head(out, kUnsigned, static_cast<std::uint64_t>(payload_.int64));
+            } else {
+                //-1 - n never overflows, unlike -n for INT64_MIN
+                write_head(out, kNegative, static_cast<std::uint64_t>(-1 - payload_.int64));
+            }
+            break;
+        case Type::Uint64: write_head(out, kUnsigned, payload_.uint64); break;
+        case Type::String: write_text(out, as_string()); break;
+        case Type::Array:
+            write_head(out, kArray, as_array().size());
+            for(const auto& item : as_array()) item.to_cbor(out);
+            break;
+        case Type::Object:
+            write_head(out, kMap, as_object().size());
+            for(const auto& [key, val] : as_object()) {
+                write_text(out, key.view());
+                val.to_cbor(out);
+            }
+            break;
+    }
+}
+
+JsonValue from_cbor(std::string_view bytes) {
+    return from_cbor(bytes, *std::pmr::get_default_resource(), ParseOptions{});
+}
+
+JsonValue from_cbor(std::string_view bytes, std::pmr::memory_resource& resource) {
+    return from_cbor(bytes, resource, ParseOptions{});
+}
+
+JsonValue from_cbor(std::string_view bytes, const ParseOptions& options) {
+    return from_cbor(bytes, *std::pmr::get_default_resource(), options);
+}
+
+JsonValue from_cbor(std::string_view bytes, std::pmr::memory_resource& resource, const ParseOptions& options) {
+    return CborDecoder(bytes, resource, options).parse();
+}
+
+}
@@ -0,0 +1,287 @@
+#include "json_parser/document.hpp"
+#include "dom_builder.hpp"
+#include "parser.hpp"
+#include <stdexcept>
+
+namespace json {
+
+namespace {
+
+/*
+    notes on skipping:
+    - a value is skipped without decoding it: strings jump from quote / backslash to the next one with
+      the simd kernel, containers count brackets (skipping strings so "]" inside one does not count),
+      scalars run to the next whitespace / structural character
+    - skipping checks no more than it needs to stay inside the input - it does not validate. anything
+      that is read later goes through the real parser, which does
+*/
+class Scanner {
+public:
+    explicit Scanner(std::string_view input) noexcept : input_(input) {}
+
+    char at(std::size_t pos) const noexcept {return pos < input_.size() ? input_[pos] : '\0';}
+
+    std::size_t skip_whitespace(std::size_t pos) const noexcept {
+        if(pos >= input_.size() || !simd::is_whitespace(input_[pos])) return pos;
+        ++pos;
+        return pos + simd::skip_whitespace(input_.data() + pos, input_.size() - pos);
+    }
+
+    //pos is at the opening quote, returns the position past the closing one
+    std::size_t skip_string(std::size_t pos) const {
+        ++pos;
+        while(true) {
+            pos += simd::find_quote_or_escape(input_.data() + pos, input_.size() - pos);
+            if(pos >= input_.size()) {
+                throw ParseError("unterminated string", pos);
+            }
+            if(input_[pos] == '"') return pos + 1;
+            //a backslash as the last byte has no character to escape, stepping over it would leave the input
+            if(pos + 1 >= input_.size()) {
+                throw ParseError("unexpected end of input", pos + 1);
+            }
+            pos += 2; //backslash + the escaped character
+        }
+    }
+
+    std::size_t skip_value(std::size_t pos) const {
+        char c = at(pos);
+        if(c == '"') return skip_string(pos);
+        if(c == '[' || c == '{') return skip_container(pos);
+        std::size_t end = pos;
+        while(end < input_.size() && !simd::is_whitespace(input_[end]) &&
+              !detail::is_structural_char(input_[end]) && input_[end] != '"') {
+            ++end;
+        }
+        if(end == pos) {
+            throw ParseError("unexpected character", pos);
+        }
+        return end;
+    }
+
+    //pos is just past a member value / element: the start of the next one, or npos at the closing bracket
+    std::size_t next_item(std::size_t pos, char close) const {
+        pos = skip_whitespace(pos);
+        char c = at(pos);
+        if(c == close) return std::string_view::npos;
+        if(c != ',') {
+            if(pos >= input_.size()) throw ParseError("unexpected end of input", pos);
+            throw ParseError("expected ','", pos);
+        }
+        return skip_whitespace(pos + 1);
+    }
+
+    //first member / element of the container at pos, or npos if it is empty
+    std::size_t first_item(std::size_t pos, char close) const {
+        pos = skip_whitespace(pos + 1);
+        if(at(pos) == close) return std::string_view::npos;
+        if(pos >= input_.size()) throw ParseError("unexpected end of input", pos);
+        return pos;
+    }
+
+    //pos is at a member's key: decodes it into 'key' and returns the position of its value
+    std::size_t read_member(std::size_t pos, std::string_view& key, std::string& scratch) const {
+        if(at(pos) != '"') {
+            throw ParseError("expected string key", pos);
+        }
+        key = detail::scan_string(input_, pos, scratch);
+        pos = skip_whitespace(pos);
+        if(at(pos) != ':') {
+            throw ParseError("expected ':'", pos);
+        }
+        return skip_whitespace(pos + 1);
+    }
+
+private:
+    std::string_view input_;
+
+    std::size_t skip_container(std::size_t pos) const {
+        std::size_t depth = 0;
+        while(pos < input_.size()) {
+            char c = input_[pos];
+            if(c == '"') {
+                pos = skip_string(pos);
+                continue;
+            }
+            if(c == '[' || c == '{') {
+                ++depth;
+            } else if(c == ']' || c == '}') {
+                if(--depth == 0) return pos + 1;
+            }
+            ++pos;
+        }
+        throw ParseError("unexpected end of input", pos);
+    }
+};
+
+}
+
+Document::Document(std::string_view json) : root_(json, Scanner(json).skip_whitespace(0)) {
+    if(root_.pos_ >= json.size()) {
+        throw ParseError("unexpected character", root_.pos_);
+    }
+}
+
+std::size_t LazyValue::find_member(std::string_view key) const {
+    Scanner scanner(input_);
+    if(scanner.at(pos_) != '{') throw std::runtime_error("not an object");
+    std::size_t first = scanner.first_item(pos_, '}');
+    if(first == std::string_view::npos) return std::string_view::npos;
+
+    //start where the last lookup ended and wrap around to the first member
+    std::size_t start = cursor_pos_ ? cursor_pos_ : first;
+    std::string scratch;
+    std::size_t member = start;
+    bool wrapped = false;
+    while(true) {
+        std::string_view member_key;
+        std::size_t value = scanner.read_member(member, member_key, scratch);
+        if(member_key == key) {
+            cursor_pos_ = member;
+            return value;
+        }
+        member = scanner.next_item(scanner.skip_value(value), '}');
+        if(member == std::string_view::npos) {
+            if(start == first) return std::string_view::npos;
+            member = first;
+            wrapped = true;
+        }
+        if(wrapped && member == start) return std::string_view::npos;
+    }
+}
+
+LazyValue LazyValue::operator[](std::string_view key) const {
+    std::size_t value = find_member(key);
+    if(value == std::string_view::npos) {
+        throw std::out_of_range("key not found: " + std::string(key));
+    }
+    return LazyValue(input_, value);
+}
+
+bool LazyValue::contains(std::string_view key) const {
+    return find_member(key) != std::string_view::npos;
+}
+
+std::optional<LazyValue> LazyValue::find(std::string_view key) const {
+    if(Scanner(input_).at(pos_) != '{') return std::nullopt;
+    std::size_t value = find_member(key);
+    if(value == std::string_view::npos) return std::nullopt;
+    return LazyValue(input_, value);
+}
+
+std::size_t LazyValue::find_element(std::size_t index) const {
+    Scanner scanner(input_);
+    if(scanner.at(pos_) != '[') throw std::runtime_error("not an array");
+    //walking forward from the last element found is the common case (for loops over indices)
+    std::size_t i = 0;
+    std::size_t element = 0;
+    if(cursor_pos_ && index >= cursor_index_) {
+        i = cursor_index_;
+        element = cursor_pos_;
+    } else {
+        element = scanner.first_item(pos_, ']');
+    }
+    while(element != std::string_view::npos) {
+        if(i == index) {
+            cursor_pos_ = element;
+            cursor_index_ = i;
+            return element;
+        }
+        element = scanner.next_item(scanner.skip_value(element), ']');
+        ++i;
+    }
+    return std::string_view::npos;
+}
+
+LazyValue LazyValue::operator[](std::size_t index) const {
+    std::size_t element = find_element(index);
+    if(element == std::string_view::npos) {
+        throw std::out_of_range("index out of range");
+    }
+    return LazyValue(input_, element);
+}
+
+std::optional<LazyValue> LazyValue::find(std::size_t index) const {
+    if(Scanner(input_).at(pos_) != '[') return std::nullopt;
+    std::size_t element = find_element(index);
+    if(element == std::string_view::npos) return std::nullopt;
+    return LazyValue(input_, element);
+}
+
+std::size_t LazyValue::size() const {
+    Scanner scanner(input_);
+    char c = scanner.at(pos_);
+    if(c != '[' && c != '{') throw std::runtime_error("size() only valid for arrays and objects");
+    char close = c == '[' ? ']' : '}';
+    std::size_t count = 0;
+    std::string scratch;
+    for(std::size_t item = scanner.first_item(pos_, close); item != std::string_view::npos; ++count) {
+        std::size_t value = item;
+        if(close == '}') {
+            std::string_view key;
+            value = scanner.read_member(item, key, scratch);
+        }
+        item = scanner.next_item(scanner.skip_value(value), close);
+    }
+    return count;
+}
+
+std::string_view LazyValue::raw_json() const {
+    return input_.substr(pos_, Scanner(input_).skip_value(pos_) - pos_);
+}
+
+JsonValue LazyValue::materialize(std::pmr::memory_resource& resource) const {
+    detail::DomBuilder builder(&resource);
+    detail::Parser<detail::DomBuilder> parser(input_, builder);
+    std::size_t end = parser.parse_value_at(pos_);
+    //Parser stops after the value without looking further, so "truex" / "12abc" need an explicit check
+    char c = Scanner(input_).at(end);
+    if(end < input_.size() && !simd::is_whitespace(c) && !detail::is_structural_char(c) && c != '"') {
+        throw ParseError("unexpected character", end);
+    }
+    return builder.take();
+}
+
+/*
+    scalars go through materialize() so the checks and conversions are exactly JsonValue's.
+    for strings / containers an empty value of the right type is enough to get JsonValue's
+    "not a ..." error, without decoding the real thing.
+*/
+JsonValue LazyValue::scalar() const {
+    switch(Scanner(input_).at(pos_)) {
+        case '"': return JsonValue(JsonString());
+        case '[': return JsonValue(JsonArray());
+        case '{': return JsonValue(JsonObject());
+        default: return materialize();
+    }
+}
+
+LazyValue::Type LazyValue::type() const {
+    switch(Scanner(input_).at(pos_)) {
+        case '"': return Type::String;
+        case '[': return Type::Array;
+        case '{': return Type::Object;
+        case 't': case 'f': return Type::Bool;
+        case 'n': return Type::Null;
+        default: return materialize().type();
+    }
+}
+
+bool LazyValue::is_number() const {
+    Type t = type();
+    return t == Type::Number || t == Type::Int64 || t == Type::Uint64;
+}
+
+bool LazyValue::as_bool() const {return scalar().as_bool();}
+double LazyValue::as_number() const {return scalar().as_number();}
+std::int64_t LazyValue::as_int64() const {return scalar().as_int64();}
+std::uint64_t LazyValue::as_uint64() const {return scalar().as_uint64();}
+
+std::string LazyValue::as_string() const {
+    if(Scanner(input_).at(pos_) != '"') throw std::runtime_error("not a string");
+    std::string scratch;
+    std::size_t pos = pos_;
+    return std::string(detail::scan_string(input_, pos, scratch));
+}
+
+}
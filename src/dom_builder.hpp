@@ -0,0 +1,176 @@
+#ifndef JSON_DOM_BUILDER_HPP
+#define JSON_DOM_BUILDER_HPP
+
+#include "json_parser/json.hpp"
+#include "json_parser/key_pool.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json::detail {
+
+/*
+    Parser handler that builds a JsonValue tree - this is what json::parse() runs.
+
+    - finished values are pushed on values_, object keys on keys_. starting a container only records
+      where its children begin (frames_).
+    - when the container ends its children are moved off the stacks into a JsonArray / JsonObject that
+      is allocated once, at its exact size. growing the containers element by element instead used to
+      leave every outgrown buffer behind - which in an Arena is memory that is never reused.
+    - the stacks are plain std::vectors owned by the builder and reused for the whole parse (and across
+      parses when the builder is reused), so after warming up they cost no allocations at all.
+    - a pending key is either interned right away (long keys, with a KeyPool) or its bytes wait in key_chars_
+      and are copied into the object once it is built. either way nothing is allocated per key until
+      the key lands in its object, and a parse error leaves nothing behind to free.
+    - duplicate keys: last one wins, at the position of the first one.
+    - the container is built in place: the JsonValue and its node are made first (empty, reserved),
+      then the children are moved in. filling a local JsonArray / JsonObject and handing that to
+      JsonValue moved the whole container once more, into its node.
+    - json::Builder (builder.hpp) drives it from the outside, on_value() takes a finished subtree.
+*/
+class DomBuilder {
+public:
+    explicit DomBuilder(std::pmr::memory_resource* resource, KeyPool* key_pool = nullptr)
+        : resource_(resource), key_pool_(key_pool) {}
+
+    bool on_null() {values_.emplace_back(nullptr); return true;}
+    bool on_bool(bool b) {values_.emplace_back(b); return true;}
+    bool on_number(double d) {values_.emplace_back(d); return true;}
+    bool on_int64(std::int64_t i) {values_.emplace_back(i); return true;}
+    bool on_uint64(std::uint64_t u) {values_.emplace_back(u); return true;}
+    bool on_value(JsonValue&& v) {values_.push_back(std::move(v)); return true;}
+    bool on_string(std::string_view s) {
+        if(s.size() > JsonValue::kSmallString && borrowed_from(s)) {
+            values_.push_back(JsonValue::borrowed(s));
+        } else {
+            values_.emplace_back(s, *resource_);
+        }
+        return true;
+    }
+    bool on_key(std::string_view k) {
+        //short keys are stored inline in the object anyway - the pool would only add a lookup
+        if(key_pool_ && k.size() > JsonKey::kInlineCapacity) {
+            keys_.push_back(PendingKey{key_pool_->intern(k), 0, 0});
+        } else {
+            keys_.push_back(PendingKey{JsonKey(), key_chars_.size(), k.size()});
+            key_chars_.append(k);
+        }
+        return true;
+    }
+    bool on_start_array() {
+        frames_.push_back(Frame{values_.size(), keys_.size()});
+        return true;
+    }
+    bool on_end_array() {
+        Frame frame = frames_.back();
+        frames_.pop_back();
+        JsonValue node{JsonArray(resource_)};
+        JsonArray& arr = node.as_array();
+        arr.reserve(values_.size() - frame.values);
+        for(std::size_t i = frame.values; i < values_.size(); ++i) {
+            arr.push_back(std::move(values_[i]));
+        }
+        values_.resize(frame.values);
+        values_.push_back(std::move(node));
+        return true;
+    }
+    bool on_start_object() {
+        frames_.push_back(Frame{values_.size(), keys_.size()});
+        return true;
+    }
+    bool on_end_object() {
+        Frame frame = frames_.back();
+        frames_.pop_back();
+        JsonValue node{JsonObject(resource_)};
+        JsonObject& obj = node.as_object();
+        obj.reserve(values_.size() - frame.values);
+        for(std::size_t i = 0; i < values_.size() - frame.values; ++i) {
+            const PendingKey& key = keys_[frame.keys + i];
+            JsonValue& value = values_[frame.values + i];
+            if(key.pooled.is_pooled()) {
+                obj.insert_or_assign(key.pooled, std::move(value));
+            } else {
+                obj.insert_or_assign(std::string_view(key_chars_).substr(key.offset, key.size), std::move(value));
+            }
+        }
+        values_.resize(frame.values);
+        //every key of this object was appended to key_chars_ after the ones of the enclosing objects
+        for(std::size_t i = frame.keys; i < keys_.size(); ++i) {
+            if(!keys_[i].pooled.is_pooled()) {
+                key_chars_.resize(keys_[i].offset);
+                break;
+            }
+        }
+        keys_.resize(frame.keys);
+        values_.push_back(std::move(node));
+        return true;
+    }
+
+    /*
+        in situ strings: a long string that the parser hands over as a view into 'input' (it had no
+        escapes, so it did not go through the scratch buffer) is kept as that view instead of copied
+    */
+    void borrow_strings_from(std::string_view input) noexcept {input_ = input;}
+
+    //where the next values are allocated (a reused builder may serve more than one resource)
+    void set_resource(std::pmr::memory_resource* resource) noexcept {resource_ = resource;}
+
+    //room for n more values / keys on the stacks
+    void reserve(std::size_t n) {
+        values_.reserve(values_.size() + n);
+        keys_.reserve(keys_.size() + n);
+    }
+
+    //the value the last event finished (the ParseStats handler looks at containers once they are built)
+    [[nodiscard]] const JsonValue& last() const noexcept {return values_.back();}
+
+    //true if s is a view into the input being borrowed from (what on_string() keeps without a copy)
+    bool borrowed_from(std::string_view s) const noexcept {
+        //std::less_equal gives a total order even for pointers into different buffers
+        std::less_equal<const char*> le;
+        return !input_.empty() && le(input_.data(), s.data()) && le(s.data() + s.size(), input_.data() + input_.size()) &&
+               s.size() <= UINT32_MAX;
+    }
+
+    //the finished document. leaves the builder ready for the next parse
+    [[nodiscard]] JsonValue take() {
+        JsonValue root = values_.empty() ? JsonValue() : std::move(values_.back());
+        clear();
+        return root;
+    }
+    //drops whatever a failed parse left on the stacks (their capacity stays)
+    void clear() noexcept {
+        values_.clear();
+        keys_.clear();
+        key_chars_.clear();
+        frames_.clear();
+    }
+
+private:
+    //where the children of an open container start on the two stacks
+    struct Frame {
+        std::size_t values;
+        std::size_t keys;
+    };
+
+    //a key waiting for its object: interned (pooled.is_pooled()) or key_chars_[offset, offset + size)
+    struct PendingKey {
+        JsonKey pooled;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    std::pmr::memory_resource* resource_;
+    KeyPool* key_pool_;
+    std::string_view input_;  //empty unless borrowing strings
+    std::vector<JsonValue> values_;
+    std::vector<PendingKey> keys_;
+    std::string key_chars_;
+    std::vector<Frame> frames_;
+};
+
+}
+
+#endif
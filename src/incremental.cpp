@@ -0,0 +1,439 @@
+#include "json_parser/incremental.hpp"
+#include "dom_builder.hpp"
+#include "parser.hpp"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace json {
+
+namespace detail {
+
+namespace {
+
+/*
+    the push parser: the same grammar as Parser, but as an explicit state machine so it can stop at
+    the end of any chunk and pick up where it left off with the next one.
+
+    - open containers are kept on stack_ like in Parser ('[' or '{' per open container)
+    - the state says what we expect next; the token states (String / Escape / Unicode / Number /
+      Literal) are the ones that can be interrupted mid-token by the end of a chunk
+    - a token that starts and ends inside one chunk is handed on as a view into the chunk (no copy).
+      only a token that spans chunks is copied into token_, which is reused for every token
+    - numbers are collected up to the first character that cannot be part of one and then go through
+      the same scan_number / emit_number as Parser, so both accept exactly the same numbers
+    - errors are Parser's too, message and position: a token that stops matching, or the end of the
+      input in any state, throws what Parser throws at the same byte (see complete_number, finish)
+*/
+template <typename Handler>
+class PushParser {
+public:
+    explicit PushParser(Handler& handler) : handler_(handler) {}
+
+    bool feed(std::string_view chunk) {
+        if(finished_ || failed_) {
+            throw std::logic_error("feed() after the parse has finished or failed");
+        }
+        if(stopped_) return false;
+        try {
+            run(chunk);
+        } catch(...) {
+            failed_ = true;
+            throw;
+        }
+        offset_ += chunk.size();
+        return !stopped_;
+    }
+
+    bool finish() {
+        if(finished_ || failed_) {
+            throw std::logic_error("finish() after the parse has finished or failed");
+        }
+        finished_ = true;
+        if(stopped_) return false;
+        //a number is the only token that ends at the end of input rather than at a character
+        if(state_ == State::Number) {
+            //the last chunk is gone, the whole number is in token_
+            if(!complete_number(token_)) return false;
+        }
+        //what Parser runs into at the end of the input in each state, so the errors are parse()'s
+        switch(state_) {
+            case State::Done: return true;
+            case State::Value: case State::ArrayFirst: throw ParseError("unexpected character", offset_);
+            case State::ObjectFirst: case State::ObjectKey: throw ParseError("expected string key", offset_);
+            case State::String: throw ParseError("unterminated string", offset_);
+            case State::Unicode: throw ParseError("invalid unicode escape", offset_);
+            case State::Literal: throw literal_error();
+            default: throw ParseError("unexpected end of input", offset_);
+        }
+    }
+
+    [[nodiscard]] std::size_t offset() const noexcept {return offset_;}
+
+private:
+    enum class State : std::uint8_t {
+        Value,          //any value
+        ArrayFirst,     //a value or ']'
+        ArrayNext,      //',' or ']'
+        ObjectFirst,    //a key or '}'
+        ObjectKey,      //a key (after ',')
+        ObjectColon,    //':'
+        ObjectNext,     //',' or '}'
+        Done,           //only whitespace left
+        String,         //inside a string
+        Escape,         //after '\\'
+        Unicode,        //inside \uXXXX
+        Number,
+        Literal,        //true / false / null
+    };
+
+    Handler& handler_;
+    State state_ = State::Value;
+    std::vector<char> stack_;
+    //the token in progress once it had to be copied: it spans chunks, or it is a string with escapes
+    std::string token_;
+    bool in_buffer_ = false;
+    //bytes of the token in progress in the current chunk that are not in token_ yet start here
+    const char* run_start_ = nullptr;
+    std::size_t token_offset_ = 0;      //absolute position of the token, for errors
+    bool string_is_key_ = false;
+    std::string_view literal_;          //"true" / "false" / "null" while in Literal
+    std::size_t literal_index_ = 0;
+    unsigned codepoint_ = 0;
+    int hex_digits_ = 0;
+    std::size_t offset_ = 0;            //absolute position of the current chunk
+    const char* chunk_ = nullptr;
+    bool stopped_ = false;
+    bool finished_ = false;
+    bool failed_ = false;
+
+    std::size_t position(const char* p) const noexcept {return offset_ + static_cast<std::size_t>(p - chunk_);}
+
+    void begin_token(const char* p) {
+        token_.clear();
+        in_buffer_ = false;
+        run_start_ = p;
+        token_offset_ = position(p);
+    }
+
+    //the finished token: a view into the chunk if it lives entirely there, else the copied bytes in token_
+    std::string_view take_token(const char* end) {
+        if(!in_buffer_) {
+            return std::string_view(run_start_, static_cast<std::size_t>(end - run_start_));
+        }
+        token_.append(run_start_, static_cast<std::size_t>(end - run_start_));
+        return token_;
+    }
+
+    //copy the part of the token this chunk holds, either because the chunk is about to go away or
+    //because decoded escapes are about to be appended after it
+    void save_token(const char* end) {
+        token_.append(run_start_, static_cast<std::size_t>(end - run_start_));
+        in_buffer_ = true;
+        run_start_ = end;
+    }
+
+    bool emit(bool keep_going) {
+        if(!keep_going) stopped_ = true;
+        return keep_going;
+    }
+
+    void after_value() {
+        if(stack_.empty()) {
+            state_ = State::Done;
+        } else {
+            state_ = stack_.back() == '[' ? State::ArrayNext : State::ObjectNext;
+        }
+    }
+
+    /*
+        literal is every character from the start of the number that could be part of one. like Parser,
+        take the number scan_number finds at its start: if the literal goes on after it ("1.5.5", "[1-2]",
+        "01"), what is left is the unexpected character after a complete value
+    */
+    bool complete_number(std::string_view literal) {
+        auto scan = scan_number(literal.data(), literal.data() + literal.size());
+        if(!scan.ok) {
+            throw ParseError("invalid number", token_offset_ + scan.length);
+        }
+        after_value();
+        if(!emit(emit_number(literal.substr(0, scan.length), scan.is_integer, token_offset_, handler_))) return false;
+        if(scan.length != literal.size()) {
+            //none of the characters a literal collects is whitespace, ',' or a closing bracket
+            throw ParseError(state_ == State::Done ? "unexpected characters after JSON" : "expected ','",
+                             token_offset_ + scan.length);
+        }
+        return true;
+    }
+
+    ParseError literal_error() const {
+        return ParseError(literal_[0] == 'n' ? "expected 'null'" : "expected 'true' or 'false'", token_offset_);
+    }
+
+    //first character of a value (also ']' straight after '[')
+    bool start_value(const char*& p) {
+        char c = *p;
+        //same limit as json::parse() with default options, so both accept the same documents
+        if((c == '[' || c == '{') && stack_.size() >= ParseOptions::kDefaultMaxDepth) {
+            throw ParseError("maximum nesting depth exceeded", position(p));
+        }
+        switch(c) {
+            case '"':
+                string_is_key_ = false;
+                state_ = State::String;
+                begin_token(++p);
+                return true;
+            case '[':
+                ++p;
+                stack_.push_back('[');
+                state_ = State::ArrayFirst;
+                return emit(handler_.on_start_array());
+            case '{':
+                ++p;
+                stack_.push_back('{');
+                state_ = State::ObjectFirst;
+                return emit(handler_.on_start_object());
+            case 't': literal_ = "true"; break;
+            case 'f': literal_ = "false"; break;
+            case 'n': literal_ = "null"; break;
+            default:
+                if(c == '-' || is_digit(c)) {
+                    state_ = State::Number;
+                    begin_token(p++);
+                    return true;
+                }
+                throw ParseError("unexpected character", position(p));
+        }
+        token_offset_ = position(p++);
+        literal_index_ = 1;
+        state_ = State::Literal;
+        return true;
+    }
+
+    bool end_container(const char*& p) {
+        ++p;
+        char open = stack_.back();
+        stack_.pop_back();
+        after_value();
+        return emit(open == '[' ? handler_.on_end_array() : handler_.on_end_object());
+    }
+
+    bool finish_literal() {
+        after_value();
+        if(literal_[0] == 'n') return emit(handler_.on_null());
+        return emit(handler_.on_bool(literal_[0] == 't'));
+    }
+
+    bool finish_string(std::string_view s) {
+        if(string_is_key_) {
+            state_ = State::ObjectColon;
+            return emit(handler_.on_key(s));
+        }
+        after_value();
+        return emit(handler_.on_string(s));
+    }
+
+    void run(std::string_view chunk) {
+        chunk_ = chunk.data();
+        const char* p = chunk.data();
+        const char* end = p + chunk.size();
+        //a token carried over from the last chunk continues at the start of this one
+        run_start_ = p;
+        while(p < end && !stopped_) {
+            switch(state_) {
+                case State::String: {
+                    std::size_t run = simd::find_escape_char(p, static_cast<std::size_t>(end - p));
+                    p += run;
+                    if(p == end) break;
+                    if(static_cast<unsigned char>(*p) < 0x20) {
+                        throw ParseError("control character in string", position(p));
+                    }
+                    if(*p == '"') {
+                        std::string_view s = take_token(p);
+                        ++p;
+                        finish_string(s);
+                    } else {
+                        //escapes are decoded into token_, so from here on the string is a copy
+                        save_token(p);
+                        ++p;
+                        state_ = State::Escape;
+                    }
+                    break;
+                }
+                case State::Escape: {
+                    char escape = *p;
+                    if(char c = simple_escape(escape)) {
+                        token_ += c;
+                        state_ = State::String;
+                    } else if(escape == 'u') {
+                        codepoint_ = 0;
+                        hex_digits_ = 0;
+                        state_ = State::Unicode;
+                    } else {
+                        throw ParseError("invalid escape sequence", position(p));
+                    }
+                    ++p;
+                    run_start_ = p;
+                    break;
+                }
+                case State::Unicode: {
+                    int digit = hex_value(*p);
+                    if(digit < 0) {
+                        throw ParseError("invalid unicode escape", position(p));
+                    }
+                    codepoint_ = codepoint_ * 16 + static_cast<unsigned>(digit);
+                    ++p;
+                    if(++hex_digits_ == 4) {
+                        append_utf8(token_, codepoint_);
+                        state_ = State::String;
+                        run_start_ = p;
+                    }
+                    break;
+                }
+                case State::Number: {
+                    const char* q = p;
+                    while(q < end && (is_digit(*q) || *q == '-' || *q == '+' || *q == '.' || *q == 'e' || *q == 'E')) ++q;
+                    p = q;
+                    if(p == end) break;
+                    complete_number(take_token(p));
+                    break;
+                }
+                case State::Literal: {
+                    if(*p != literal_[literal_index_]) {
+                        throw literal_error();
+                    }
+                    ++p;
+                    if(++literal_index_ == literal_.size()) finish_literal();
+                    break;
+                }
+                default:
+                    p = structural(p, end);
+                    break;
+            }
+        }
+        //whatever part of a token this chunk holds has to be kept before the chunk goes away
+        if(!stopped_ && (state_ == State::String || state_ == State::Number)) {
+            save_token(end);
+        }
+    }
+
+    //everything outside of a token: whitespace, punctuation and the start of the next value
+    const char* structural(const char* p, const char* end) {
+        if(simd::is_whitespace(*p)) {
+            ++p;
+            p += simd::skip_whitespace(p, static_cast<std::size_t>(end - p));
+            if(p == end) return p;
+        }
+        char c = *p;
+        switch(state_) {
+            case State::Value:
+                start_value(p);
+                break;
+            case State::ArrayFirst:
+                if(c == ']') {
+                    end_container(p);
+                } else {
+                    start_value(p);
+                }
+                break;
+            case State::ArrayNext:
+                if(c == ']') {
+                    end_container(p);
+                } else if(c == ',') {
+                    ++p;
+                    state_ = State::Value;
+                } else {
+                    throw ParseError("expected ','", position(p));
+                }
+                break;
+            case State::ObjectFirst:
+                if(c == '}') {
+                    end_container(p);
+                    break;
+                }
+                [[fallthrough]];
+            case State::ObjectKey:
+                if(c != '"') {
+                    throw ParseError("expected string key", position(p));
+                }
+                string_is_key_ = true;
+                state_ = State::String;
+                begin_token(++p);
+                break;
+            case State::ObjectColon:
+                if(c != ':') {
+                    throw ParseError("expected ':'", position(p));
+                }
+                ++p;
+                state_ = State::Value;
+                break;
+            case State::ObjectNext:
+                if(c == '}') {
+                    end_container(p);
+                } else if(c == ',') {
+                    ++p;
+                    state_ = State::ObjectKey;
+                } else {
+                    throw ParseError("expected ','", position(p));
+                }
+                break;
+            case State::Done:
+                throw ParseError("unexpected characters after JSON", position(p));
+            default:
+                break;
+        }
+        return p;
+    }
+};
+
+}
+
+}
+
+struct IncrementalParser::Impl {
+    explicit Impl(std::pmr::memory_resource* resource) : builder(resource), parser(builder) {}
+    detail::DomBuilder builder;
+    detail::PushParser<detail::DomBuilder> parser;
+};
+
+IncrementalParser::IncrementalParser(std::pmr::memory_resource& resource) : impl_(std::make_unique<Impl>(&resource)) {}
+IncrementalParser::~IncrementalParser() = default;
+IncrementalParser::IncrementalParser(IncrementalParser&&) noexcept = default;
+IncrementalParser& IncrementalParser::operator=(IncrementalParser&&) noexcept = default;
+
+void IncrementalParser::feed(std::string_view chunk) {
+    impl_->parser.feed(chunk);
+}
+
+JsonValue IncrementalParser::finish() {
+    impl_->parser.finish();
+    return impl_->builder.take();
+}
+
+std::size_t IncrementalParser::bytes_consumed() const noexcept {
+    return impl_->parser.offset();
+}
+
+struct IncrementalSaxParser::Impl {
+    explicit Impl(SaxHandler& handler) : parser(handler) {}
+    detail::PushParser<SaxHandler> parser;
+};
+
+IncrementalSaxParser::IncrementalSaxParser(SaxHandler& handler) : impl_(std::make_unique<Impl>(handler)) {}
+IncrementalSaxParser::~IncrementalSaxParser() = default;
+IncrementalSaxParser::IncrementalSaxParser(IncrementalSaxParser&&) noexcept = default;
+IncrementalSaxParser& IncrementalSaxParser::operator=(IncrementalSaxParser&&) noexcept = default;
+
+bool IncrementalSaxParser::feed(std::string_view chunk) {
+    return impl_->parser.feed(chunk);
+}
+
+bool IncrementalSaxParser::finish() {
+    return impl_->parser.finish();
+}
+
+std::size_t IncrementalSaxParser::bytes_consumed() const noexcept {
+    return impl_->parser.offset();
+}
+
+}
@@ -1,87 +1,318 @@
 #include "json_parser/json.hpp"
-#include <cctype>
-#include <sstream>
+#include "parser.hpp"
+#include "structural_index.hpp"
+#include "dom_builder.hpp"
+#include "parallel_parse.hpp"
+#include "parse_stats.hpp"
+#include "serialize.hpp"
+#include "json_parser/writer.hpp"
+#include <cmath>
+#include <charconv>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <vector>
 
 namespace json {
 
-JsonValue::JsonValue(const JsonValue& other) {
-    if(other.is_null()) {
-        value_ = nullptr;
-    } else if(other.is_bool()) {
-        value_ = other.as_bool();
-    } else if(other.is_number()) {
-        value_ = other.as_number();
-    } else if(other.is_string()) {
-        value_ = other.as_string();
-    } else if(other.is_array()) {
-        value_ = std::make_unique<JsonArray>(other.as_array());
-    } else if(other.is_object()) {
-        value_ = std::make_unique<JsonObject>(other.as_object());
+// arena ---------------------------------------------------------------------
+Arena::Arena(std::size_t initial_block_size, std::pmr::memory_resource* upstream)
+    : upstream_(upstream), next_block_size_(initial_block_size == 0 ? 4096 : initial_block_size) {}
+
+Arena::~Arena() {
+    release();
+}
+
+void Arena::release() noexcept {
+    while(head_) {
+        Block* next = head_->next;
+        upstream_->deallocate(head_, sizeof(Block) + head_->size, alignof(std::max_align_t));
+        head_ = next;
+    }
+    cur_ = end_ = nullptr;
+    bytes_used_ = 0;
+    block_count_ = 0;
+}
+
+void Arena::reset() noexcept {
+    Block* keep = head_;
+    for(Block* b = head_; b; b = b->next) {
+        if(b->size > keep->size) keep = b;
+    }
+    while(head_) {
+        Block* next = head_->next;
+        if(head_ != keep) upstream_->deallocate(head_, sizeof(Block) + head_->size, alignof(std::max_align_t));
+        head_ = next;
+    }
+    head_ = keep;
+    cur_ = end_ = nullptr;
+    block_count_ = 0;
+    if(keep) {
+        keep->next = nullptr;
+        cur_ = reinterpret_cast<char*>(keep + 1);
+        end_ = cur_ + keep->size;
+        block_count_ = 1;
+    }
+    bytes_used_ = 0;
+}
+
+void Arena::add_block(std::size_t min_size) {
+    std::size_t size = next_block_size_;
+    while(size < min_size) size *= 2;
+    //grow geometrically so big documents need few blocks, but cap it so one huge doc doesnt double forever
+    next_block_size_ = std::min<std::size_t>(size * 2, std::size_t{1} << 24);
+
+    void* mem = upstream_->allocate(sizeof(Block) + size, alignof(std::max_align_t));
+    auto* block = static_cast<Block*>(mem);
+    block->next = head_;
+    block->size = size;
+    head_ = block;
+    cur_ = reinterpret_cast<char*>(block + 1);
+    end_ = cur_ + size;
+    ++block_count_;
+}
+
+void* Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    auto aligned = [&]() {
+        auto p = reinterpret_cast<std::uintptr_t>(cur_);
+        return reinterpret_cast<char*>((p + alignment - 1) & ~(alignment - 1));
+    };
+    char* p = cur_ ? aligned() : nullptr;
+    if(!p || p + bytes > end_) {
+        add_block(bytes + alignment);
+        p = aligned();
+    }
+    cur_ = p + bytes;
+    bytes_used_ += bytes;
+    return p;
+}
+
+// json value ----------------------------------------------------------------
+namespace {
+//free a node through the resource it was allocated from
+template <typename T>
+void delete_node(T* node) noexcept {
+    std::pmr::polymorphic_allocator<> alloc(node->get_allocator());
+    alloc.delete_object(node);
+}
+}
+
+/*
+    the node behind a Shared value. 'value' is the Owned string / array / object, it is never written
+    while refs > 1. plain new / delete: the node is not part of any tree's memory resource, it only
+    holds the tree
+*/
+struct JsonValue::SharedNode {
+    explicit SharedNode(JsonValue&& v) noexcept : value(std::move(v)) {}
+
+    std::atomic<std::size_t> refs{1};
+    JsonValue value;
+};
+
+JsonValue::JsonValue(std::string_view s, std::pmr::memory_resource& resource) : type_(Type::String) {
+    init_string(s, resource);
+}
+
+JsonValue::JsonValue(JsonString s) : type_(Type::String) {
+    if(s.size() <= kSmallString) {
+        init_string(s, *std::pmr::null_memory_resource()); //small strings never allocate
+    } else {
+        payload_.string = make_node(std::move(s));
+    }
+}
+
+JsonValue JsonValue::borrowed(std::string_view s) {
+    if(s.size() > UINT32_MAX) throw std::length_error("string too long to borrow");
+    JsonValue v;
+    v.type_ = Type::String;
+    if(s.size() <= kSmallString) {
+        v.init_string(s, *std::pmr::null_memory_resource()); //small strings never allocate
+    } else {
+        v.payload_.view = s.data();
+        v.string_size_ = static_cast<std::uint32_t>(s.size());
+        v.storage_ = Storage::View;
+    }
+    return v;
+}
+
+void JsonValue::init_string(std::string_view s, std::pmr::memory_resource& resource) {
+    if(s.size() <= kSmallString) {
+        if(!s.empty()) std::memcpy(payload_.small, s.data(), s.size());
+        string_size_ = static_cast<std::uint32_t>(s.size());
+        storage_ = Storage::Small;
+    } else {
+        payload_.string = make_node(JsonString(s, &resource));
+        storage_ = Storage::Owned;
+    }
+}
+
+JsonValue::JsonValue(const JsonValue& other) : type_(other.type_) {
+    if(other.is_shared()) {
+        //relaxed is enough to take a new reference, the node is kept alive by other's
+        payload_.shared = other.payload_.shared;
+        payload_.shared->refs.fetch_add(1, std::memory_order_relaxed);
+        storage_ = Storage::Shared;
+        return;
+    }
+    //pmr copy construction picks the default resource, so a copy never points back into an arena
+    switch(other.type_) {
+        case Type::String:
+            if(other.storage_ == Storage::Owned) {
+                payload_.string = make_node(JsonString(*other.payload_.string));
+            } else {
+                //a View is copied too, the copy must not depend on the input buffer
+                init_string(other.as_string(), *std::pmr::get_default_resource());
+            }
+            break;
+        case Type::Array: payload_.array = make_node(JsonArray(*other.payload_.array)); break;
+        case Type::Object: payload_.object = make_node(JsonObject(*other.payload_.object)); break;
+        default: payload_ = other.payload_; //scalars are plain bits
     }
 }
 
 JsonValue& JsonValue::operator=(const JsonValue& other) {
     if(this != &other) {
         JsonValue temp(other);
-        std::swap(value_, temp.value_);
+        *this = std::move(temp);
     }
     return *this;
 }
 
-// type checks --------------------------------------------------------------
-bool JsonValue::is_null() const noexcept {
-    return std::holds_alternative<JsonNull>(value_);
-}
-bool JsonValue::is_bool() const noexcept {
-    return std::holds_alternative<JsonBool>(value_);
+JsonValue& JsonValue::operator=(JsonValue&& other) noexcept {
+    if(this != &other) {
+        //take other's fields before destroy(): other may live inside this value's tree
+        //(v = std::move(v["data"])), and detaching it first keeps destroy() from freeing it too
+        Payload payload = other.payload_;
+        std::uint32_t string_size = other.string_size_;
+        Storage storage = other.storage_;
+        Type type = other.type_;
+        other.type_ = Type::Null;
+        if(type_ >= Type::String) destroy();
+        payload_ = payload;
+        string_size_ = string_size;
+        storage_ = storage;
+        type_ = type;
+    }
+    return *this;
 }
-bool JsonValue::is_number() const noexcept {
-    return std::holds_alternative<JsonNumber>(value_);
+
+void JsonValue::destroy() noexcept {
+    if(storage_ == Storage::Shared) {
+        //acq_rel: whoever frees the node sees every other thread's reads of it finished
+        if(payload_.shared->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete payload_.shared;
+        storage_ = Storage::Owned;
+        type_ = Type::Null;
+        return;
+    }
+    switch(type_) {
+        case Type::String:
+            if(storage_ == Storage::Owned) delete_node(payload_.string);
+            break;
+        case Type::Array: delete_node(payload_.array); break;
+        case Type::Object: delete_node(payload_.object); break;
+        default: break;
+    }
+    type_ = Type::Null;
 }
-bool JsonValue::is_string() const noexcept {
-    return std::holds_alternative<JsonString>(value_);
+
+JsonValue JsonValue::share() && {
+    //scalars and small strings are 16 bytes already, a node would only add an indirection
+    if(type_ < Type::String || storage_ == Storage::Small || is_shared()) return std::move(*this);
+    //a View is copied first (like a copy of it would be), the node only ever holds an Owned value
+    if(storage_ == Storage::View) return JsonValue(*this).share();
+    Type type = type_;
+    JsonValue v;
+    v.payload_.shared = new SharedNode(std::move(*this));
+    v.storage_ = Storage::Shared;
+    v.type_ = type;
+    return v;
 }
-bool JsonValue::is_array() const noexcept {
-    return std::holds_alternative<std::unique_ptr<JsonArray>>(value_);
+
+JsonValue JsonValue::share() const& {
+    if(type_ < Type::String || storage_ == Storage::Small || is_shared()) return *this;
+    return JsonValue(*this).share();
 }
-bool JsonValue::is_object() const noexcept {
-    return std::holds_alternative<std::unique_ptr<JsonObject>>(value_);
+
+void JsonValue::unshare() {
+    SharedNode* node = payload_.shared;
+    JsonValue own;
+    if(node->refs.load(std::memory_order_acquire) == 1) {
+        //the last reference, nobody else can reach the node: take the value over instead of copying
+        own = std::move(node->value);
+    } else {
+        own = node->value;
+    }
+    *this = std::move(own); //drops the reference
 }
 
 //accessors --------------------------------------------------------------
 /*
-    std::get extracts value from std::variant
-    can also use auto* valptr = std::get_if<T>(&value_); here
+    every accessor checks the tag before touching the union -
+    reading a member other than the one last written is UB
 */
 // const accessors
 bool JsonValue::as_bool() const {
     if(!is_bool()) throw std::runtime_error("not a bool");
-    return std::get<JsonBool>(value_);
+    return payload_.boolean;
 }
 double JsonValue::as_number() const {
-    if(!is_number()) throw std::runtime_error("not a number");
-    return std::get<JsonNumber>(value_);
+    switch(type_) {
+        case Type::Number: return payload_.number;
+        case Type::Int64: return static_cast<double>(payload_.int64);
+        case Type::Uint64: return static_cast<double>(payload_.uint64);
+        default: throw std::runtime_error("not a number");
+    }
 }
-const std::string& JsonValue::as_string() const {
+std::int64_t JsonValue::as_int64() const {
+    if(type_ == Type::Int64) return payload_.int64;
+    if(type_ == Type::Uint64) {
+        if(payload_.uint64 > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+            throw std::out_of_range("integer does not fit in int64");
+        }
+        return static_cast<std::int64_t>(payload_.uint64);
+    }
+    throw std::runtime_error("not an integer");
+}
+std::uint64_t JsonValue::as_uint64() const {
+    if(type_ == Type::Uint64) return payload_.uint64;
+    if(type_ == Type::Int64) {
+        if(payload_.int64 < 0) throw std::out_of_range("integer is negative");
+        return static_cast<std::uint64_t>(payload_.int64);
+    }
+    throw std::runtime_error("not an integer");
+}
+std::string_view JsonValue::as_string() const {
     if(!is_string()) throw std::runtime_error("not a string");
-    return std::get<JsonString>(value_);
+    switch(storage_) {
+        case Storage::Small: return {payload_.small, string_size_};
+        case Storage::View: return {payload_.view, string_size_};
+        case Storage::Shared: return payload_.shared->value.as_string();
+        default: return *payload_.string;
+    }
 }
+//the value in a shared node is always Owned
 const JsonArray& JsonValue::as_array() const {
     if(!is_array()) throw std::runtime_error("not an array");
-    return *std::get<std::unique_ptr<JsonArray>>(value_);
+    return is_shared() ? *payload_.shared->value.payload_.array : *payload_.array;
 }
 const JsonObject& JsonValue::as_object() const {
     if(!is_object()) throw std::runtime_error("not an object");
-    return *std::get<std::unique_ptr<JsonObject>>(value_);
+    return is_shared() ? *payload_.shared->value.payload_.object : *payload_.object;
 }
-//mutable accessors
+//mutable accessors (copy on write for shared values)
 JsonArray& JsonValue::as_array() {
     if(!is_array()) throw std::runtime_error("not an array");
-    return *std::get<std::unique_ptr<JsonArray>>(value_);
+    if(is_shared()) unshare();
+    return *payload_.array;
 }
 JsonObject& JsonValue::as_object() {
     if(!is_object()) throw std::runtime_error("not an object");
-    return *std::get<std::unique_ptr<JsonObject>>(value_);
+    if(is_shared()) unshare();
+    return *payload_.object;
 }
 
 //array & obj access
@@ -91,14 +322,45 @@ const JsonValue& JsonValue::operator[](std::size_t index) const {
 JsonValue& JsonValue::operator[](std::size_t index) {
     return as_array().at(index);
 }
-const JsonValue& JsonValue::operator[](const std::string& key) const {
+const JsonValue& JsonValue::operator[](std::string_view key) const {
     // const access - [] access will create missing key. we must used .at(key)
     return as_object().at(key);
 }
-JsonValue& JsonValue::operator[](const std::string& key) {
+JsonValue& JsonValue::operator[](std::string_view key) {
     //mutable access - [] access & creation of new key is fine
     return as_object()[key];
 }
+const JsonValue& JsonValue::operator[](const Key& key) const {
+    return as_object().at(key);
+}
+JsonValue& JsonValue::operator[](const Key& key) {
+    return as_object()[key];
+}
+
+const JsonValue* JsonValue::find(std::string_view key) const noexcept {
+    if(!is_object()) return nullptr;
+    const JsonObject& obj = as_object();
+    auto it = obj.find(key);
+    return it == obj.end() ? nullptr : &it->second;
+}
+const JsonValue* JsonValue::find(const Key& key) const noexcept {
+    if(!is_object()) return nullptr;
+    const JsonObject& obj = as_object();
+    auto it = obj.find(key);
+    return it == obj.end() ? nullptr : &it->second;
+}
+JsonValue* JsonValue::find(std::string_view key) {
+    if(!is_object()) return nullptr;
+    JsonObject& obj = as_object();
+    auto it = obj.find(key);
+    return it == obj.end() ? nullptr : &it->second;
+}
+JsonValue* JsonValue::find(const Key& key) {
+    if(!is_object()) return nullptr;
+    JsonObject& obj = as_object();
+    auto it = obj.find(key);
+    return it == obj.end() ? nullptr : &it->second;
+}
 
 // size ---------------------------------------------------------------------- 
 std::size_t JsonValue::size() const {
@@ -107,326 +369,558 @@ std::size_t JsonValue::size() const {
     throw std::runtime_error("size() only valid for arrays and objects");
 }
 
+bool operator==(const JsonValue& a, const JsonValue& b) noexcept {
+    using Type = JsonValue::Type;
+    if(a.is_number() && b.is_number()) {
+        if(a.type_ == Type::Number || b.type_ == Type::Number) return a.as_number() == b.as_number();
+        if(a.type_ == b.type_) return a.type_ == Type::Int64 ? a.payload_.int64 == b.payload_.int64 : a.payload_.uint64 == b.payload_.uint64;
+        //one Int64, one Uint64: equal only if the signed one is not negative
+        std::int64_t i = a.type_ == Type::Int64 ? a.payload_.int64 : b.payload_.int64;
+        std::uint64_t u = a.type_ == Type::Uint64 ? a.payload_.uint64 : b.payload_.uint64;
+        return i >= 0 && static_cast<std::uint64_t>(i) == u;
+    }
+    if(a.type_ != b.type_) return false;
+    switch(a.type_) {
+        case Type::Bool: return a.payload_.boolean == b.payload_.boolean;
+        case Type::String: return a.as_string() == b.as_string();
+        case Type::Array: {
+            const JsonArray& x = a.as_array();
+            const JsonArray& y = b.as_array();
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+        }
+        case Type::Object: {
+            const JsonObject& x = a.as_object();
+            const JsonObject& y = b.as_object();
+            if(x.size() != y.size()) return false;
+            for(const auto& [key, value] : x) {
+                auto it = y.find(key);
+                if(it == y.end() || !(it->second == value)) return false;
+            }
+            return true;
+        }
+        default: return true;  //null
+    }
+}
+
+// json object ---------------------------------------------------------------
+JsonKey JsonKey::make_inline(std::string_view s) noexcept {
+    JsonKey key;
+    if(!s.empty()) std::memcpy(key.bytes_, s.data(), s.size());
+    key.tag_ = static_cast<std::uint8_t>(s.size());
+    return key;
+}
+
+JsonKey JsonKey::make_external(Kind kind, const char* p, std::size_t n) noexcept {
+    static_assert(sizeof(const char*) + sizeof(std::uint32_t) <= kInlineCapacity);
+    JsonKey key;
+    auto size = static_cast<std::uint32_t>(n);
+    std::memcpy(key.bytes_, &p, sizeof(p));
+    std::memcpy(key.bytes_ + sizeof(p), &size, sizeof(size));
+    key.tag_ = static_cast<std::uint8_t>(static_cast<std::uint8_t>(kind) << 4);
+    return key;
+}
+
+//a pooled key's characters are preceded by their hash (see KeyPool)
+std::size_t JsonKey::hash() const noexcept {
+    if(kind() != Kind::Pooled) return std::hash<std::string_view>{}(view());
+    std::size_t h;
+    std::memcpy(&h, data() - sizeof(h), sizeof(h));
+    return h;
+}
+
+bool operator==(const JsonKey& a, const JsonKey& b) noexcept {
+    if(a.is_pooled() && b.is_pooled()) {
+        //the same pool hands out one pointer per string, so this is the common hit
+        if(a.data() == b.data()) return true;
+        if(a.hash() != b.hash()) return false;
+    }
+    return a.view() == b.view();
+}
+
+JsonObject::JsonObject(std::initializer_list<std::pair<std::string_view, JsonValue>> init, const allocator_type& alloc)
+    : entries_(alloc), index_(alloc) {
+    try {
+        reserve(init.size());
+        for(const auto& [key, value] : init) insert_or_assign(key, value);
+    } catch(...) {
+        release_keys();
+        throw;
+    }
+}
+
+JsonObject::JsonObject(const JsonObject& other, const allocator_type& alloc) : entries_(alloc), index_(alloc) {
+    try {
+        entries_.reserve(other.size());
+        for(const auto& [key, value] : other) {
+            JsonValue copy(value);
+            entries_.emplace_back(copy_key(key), std::move(copy));
+        }
+        //same positions, so the index carries over as is
+        index_.assign(other.index_.begin(), other.index_.end());
+    } catch(...) {
+        release_keys();
+        throw;
+    }
+}
+
+JsonObject::JsonObject(JsonObject&& other, const allocator_type& alloc) : entries_(alloc), index_(alloc) {
+    if(alloc == other.get_allocator()) {
+        entries_ = std::move(other.entries_);
+        index_ = std::move(other.index_);
+        other.entries_.clear();
+        other.index_.clear();
+        return;
+    }
+    //owned keys belong to other's resource - copy those, the values just move over
+    try {
+        entries_.reserve(other.size());
+        for(auto& [key, value] : other) entries_.emplace_back(copy_key(key), std::move(value));
+        index_.assign(other.index_.begin(), other.index_.end());
+    } catch(...) {
+        release_keys();
+        throw;
+    }
+}
+
+//the temporary ends up with our old members and frees them
+JsonObject& JsonObject::operator=(const JsonObject& other) {
+    if(this != &other) {
+        JsonObject tmp(other, get_allocator());
+        entries_.swap(tmp.entries_);
+        index_.swap(tmp.index_);
+    }
+    return *this;
+}
+
+JsonObject& JsonObject::operator=(JsonObject&& other) {
+    if(this != &other) {
+        JsonObject tmp(std::move(other), get_allocator());
+        entries_.swap(tmp.entries_);
+        index_.swap(tmp.index_);
+    }
+    return *this;
+}
+
+void JsonObject::reserve(size_type n) {
+    entries_.reserve(n);
+    if(n >= kIndexThreshold && index_.size() < n * 2) rebuild_index(n);
+}
+
+void JsonObject::clear() noexcept {
+    release_keys();
+    entries_.clear();
+    index_.clear();
+}
+
+namespace {
+inline std::size_t hash_of(std::string_view key) noexcept {return std::hash<std::string_view>{}(key);}
+inline std::size_t hash_of(const JsonKey& key) noexcept {return key.hash();}
+}
+
+template <typename K>
+JsonObject::size_type JsonObject::find_position(const K& key, std::size_t hash) const noexcept {
+    if(index_.empty()) {
+        for(size_type i = 0; i < entries_.size(); ++i) {
+            if(entries_[i].first == key) return i;
+        }
+        return npos;
+    }
+    size_type mask = index_.size() - 1;
+    for(size_type slot = hash & mask;; slot = (slot + 1) & mask) {
+        std::uint32_t entry = index_[slot];
+        if(entry == 0) return npos;
+        if(entries_[entry - 1].first == key) return entry - 1;
+    }
+}
+
+//objects below kIndexThreshold are scanned, the hash is only worth computing once there is an index
+template <typename K>
+JsonObject::size_type JsonObject::find_position(const K& key) const noexcept {
+    return find_position(key, index_.empty() ? 0 : hash_of(key));
+}
+
+
+JsonObject::iterator JsonObject::find(std::string_view key) {
+    size_type pos = find_position(key);
+    return pos == npos ? entries_.end() : entries_.begin() + static_cast<std::ptrdiff_t>(pos);
+}
+JsonObject::const_iterator JsonObject::find(std::string_view key) const {
+    size_type pos = find_position(key);
+    return pos == npos ? entries_.end() : entries_.begin() + static_cast<std::ptrdiff_t>(pos);
+}
+JsonObject::iterator JsonObject::find(std::string_view key, std::size_t hash) {
+    size_type pos = find_position(key, hash);
+    return pos == npos ? entries_.end() : entries_.begin() + static_cast<std::ptrdiff_t>(pos);
+}
+JsonObject::const_iterator JsonObject::find(std::string_view key, std::size_t hash) const {
+    size_type pos = find_position(key, hash);
+    return pos == npos ? entries_.end() : entries_.begin() + static_cast<std::ptrdiff_t>(pos);
+}
+JsonObject::iterator JsonObject::find(const JsonKey& key) {
+    size_type pos = find_position(key);
+    return pos == npos ? entries_.end() : entries_.begin() + static_cast<std::ptrdiff_t>(pos);
+}
+JsonObject::const_iterator JsonObject::find(const JsonKey& key) const {
+    size_type pos = find_position(key);
+    return pos == npos ? entries_.end() : entries_.begin() + static_cast<std::ptrdiff_t>(pos);
+}
+
+JsonObject::iterator JsonObject::find(const Key& key) {
+    return find(key.view(), key.hash());
+}
+JsonObject::const_iterator JsonObject::find(const Key& key) const {
+    return find(key.view(), key.hash());
+}
+
+bool JsonObject::contains(std::string_view key) const {return find_position(key) != npos;}
+bool JsonObject::contains(const JsonKey& key) const {return find_position(key) != npos;}
+bool JsonObject::contains(const Key& key) const {return find_position(key.view(), key.hash()) != npos;}
+
+JsonValue& JsonObject::at(std::string_view key) {
+    size_type pos = find_position(key);
+    if(pos == npos) throw std::out_of_range("key not found: " + std::string(key));
+    return entries_[pos].second;
+}
+const JsonValue& JsonObject::at(std::string_view key) const {
+    size_type pos = find_position(key);
+    if(pos == npos) throw std::out_of_range("key not found: " + std::string(key));
+    return entries_[pos].second;
+}
+JsonValue& JsonObject::at(const Key& key) {
+    size_type pos = find_position(key.view(), key.hash());
+    if(pos == npos) throw std::out_of_range("key not found: " + std::string(key.view()));
+    return entries_[pos].second;
+}
+const JsonValue& JsonObject::at(const Key& key) const {
+    size_type pos = find_position(key.view(), key.hash());
+    if(pos == npos) throw std::out_of_range("key not found: " + std::string(key.view()));
+    return entries_[pos].second;
+}
+
+JsonValue& JsonObject::operator[](std::string_view key) {
+    size_type pos = find_position(key);
+    if(pos != npos) return entries_[pos].second;
+    return append(make_key(key), JsonValue())->second;
+}
+JsonValue& JsonObject::operator[](const Key& key) {
+    size_type pos = find_position(key.view(), key.hash());
+    if(pos != npos) return entries_[pos].second;
+    return append(make_key(key.view()), JsonValue())->second;
+}
+
+std::pair<JsonObject::iterator, bool> JsonObject::insert_or_assign(std::string_view key, JsonValue value) {
+    size_type pos = find_position(key);
+    if(pos != npos) {
+        entries_[pos].second = std::move(value);
+        return {entries_.begin() + static_cast<std::ptrdiff_t>(pos), false};
+    }
+    return {append(make_key(key), std::move(value)), true};
+}
+
+std::pair<JsonObject::iterator, bool> JsonObject::insert_or_assign(const JsonKey& key, JsonValue value) {
+    size_type pos = find_position(key);
+    if(pos != npos) {
+        entries_[pos].second = std::move(value);
+        return {entries_.begin() + static_cast<std::ptrdiff_t>(pos), false};
+    }
+    return {append(copy_key(key), std::move(value)), true};
+}
+
+std::pair<JsonObject::iterator, bool> JsonObject::emplace(std::string_view key, JsonValue value) {
+    size_type pos = find_position(key);
+    if(pos != npos) return {entries_.begin() + static_cast<std::ptrdiff_t>(pos), false};
+    return {append(make_key(key), std::move(value)), true};
+}
+
+JsonObject::size_type JsonObject::erase(std::string_view key) {
+    size_type pos = find_position(key);
+    if(pos == npos) return 0;
+    erase(entries_.begin() + static_cast<std::ptrdiff_t>(pos));
+    return 1;
+}
+
+JsonObject::iterator JsonObject::erase(const_iterator pos) {
+    release_key(pos->first);
+    auto next = entries_.erase(pos);
+    //every position after pos moved down by one - cheaper to rebuild than to patch
+    auto offset = next - entries_.begin();
+    rebuild_index(entries_.size());
+    return entries_.begin() + offset;
+}
+
+JsonKey JsonObject::make_key(std::string_view key) {
+    if(key.size() <= JsonKey::kInlineCapacity) return JsonKey::make_inline(key);
+    if(key.size() > UINT32_MAX) throw std::length_error("object key too long");
+    auto* p = static_cast<char*>(get_allocator().resource()->allocate(key.size(), 1));
+    std::memcpy(p, key.data(), key.size());
+    return JsonKey::make_external(JsonKey::Kind::Owned, p, key.size());
+}
+
+//inline and pooled keys are plain values, only owned ones need bytes of our own
+JsonKey JsonObject::copy_key(const JsonKey& key) {
+    return key.kind() == JsonKey::Kind::Owned ? make_key(key.view()) : key;
+}
+
+void JsonObject::release_key(const JsonKey& key) noexcept {
+    if(key.kind() == JsonKey::Kind::Owned) {
+        get_allocator().resource()->deallocate(const_cast<char*>(key.data()), key.size(), 1);
+    }
+}
+
+void JsonObject::release_keys() noexcept {
+    for(const auto& entry : entries_) release_key(entry.first);
+}
+
+JsonObject::iterator JsonObject::append(JsonKey key, JsonValue&& value) {
+    try {
+        entries_.emplace_back(key, std::move(value));
+    } catch(...) {
+        release_key(key);
+        throw;
+    }
+    if(index_.empty()) {
+        if(entries_.size() >= kIndexThreshold) rebuild_index(entries_.size());
+    } else if(entries_.size() * 2 > index_.size()) {
+        rebuild_index(entries_.size()); //keep the load factor at or below 1/2
+    } else {
+        index_slot(entries_.size() - 1);
+    }
+    return entries_.end() - 1;
+}
+
+void JsonObject::index_slot(size_type position) noexcept {
+    size_type mask = index_.size() - 1;
+    size_type slot = entries_[position].first.hash() & mask;
+    while(index_[slot] != 0) slot = (slot + 1) & mask;
+    index_[slot] = static_cast<std::uint32_t>(position + 1);
+}
+
+//sized for 'capacity' members at a load factor of 1/4 - that leaves room to grow before the next rebuild
+JsonObject::size_type JsonObject::index_slots(size_type capacity) noexcept {
+    if(capacity < kIndexThreshold) return 0;
+    size_type slots = 2 * kIndexThreshold;
+    while(slots < capacity * 4) slots *= 2;
+    return slots;
+}
+
+void JsonObject::rebuild_index(size_type capacity) {
+    size_type slots = index_slots(capacity);
+    if(slots == 0) {
+        index_.clear();
+        return;
+    }
+    index_.assign(slots, 0);
+    for(size_type i = 0; i < entries_.size(); ++i) index_slot(i);
+}
+
 //serialization --------------------------------------------------------------
+namespace {
+
+inline bool needs_escape(char c) noexcept {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+}
+
+/*
+    quoted string with json escapes. the simd kernel finds the next byte that needs one, everything
+    before it is copied in one write() (most keys and short values are below one vector, for those
+    the plain loop is cheaper than the call). the short escapes are what the parser accepts back, the
+    rest of the control characters have none and are written as \u00XX.
+*/
+void detail::write_escaped(Writer& out, std::string_view s) {
+    static constexpr char hex[] = "0123456789abcdef";
+    out.put('"');
+    while(!s.empty()) {
+        std::size_t clean = 0;
+        if(s.size() < 16) {
+            while(clean < s.size() && !needs_escape(s[clean])) ++clean;
+        } else {
+            clean = simd::find_escape_char(s.data(), s.size());
+        }
+        out.write(s.substr(0, clean));
+        if(clean == s.size()) break;
+        char c = s[clean];
+        switch(c) {
+            case '"': out.write("\\\""); break;
+            case '\\': out.write("\\\\"); break;
+            case '\n': out.write("\\n"); break;
+            case '\r': out.write("\\r"); break;
+            case '\t': out.write("\\t"); break;
+            case '\b': out.write("\\b"); break;
+            case '\f': out.write("\\f"); break;
+            default: {
+                auto u = static_cast<unsigned char>(c);
+                const char escape[6] = {'\\', 'u', '0', '0', hex[u >> 4], hex[u & 0xF]};
+                out.write(std::string_view(escape, sizeof(escape)));
+            }
+        }
+        s.remove_prefix(clean + 1);
+    }
+    out.put('"');
+}
+
 std::string JsonValue::dump(int indent) const {
     //-1 for indent means no formatting; entries will be displayed with no indentation regardless of reucrsion level. >= 0 means each level & entry will be displayed as newline
     std::string out;
-    dump_impl(out, indent, 0);
+    StringWriter writer(out);
+    dump_impl(writer, indent, 0);
+    writer.flush();
     return out;
 }
 
-void JsonValue::dump_impl(std::string& out, int indent, int current_indent) const {
+void JsonValue::dump_to(Writer& out, int indent) const {
+    dump_impl(out, indent, 0);
+}
+
+/*
+    everything goes through Writer's inline put / write / fill, which are a bounds check and a store
+    or memcpy into the current buffer. indentation is fill(' ', n) - the old version built a
+    std::string(current_indent + indent, ' ') for every line.
+*/
+void JsonValue::dump_impl(Writer& out, int indent, int current_indent) const {
     if(is_null()) {
-        out += "null";
+        out.write("null");
     } else if(is_bool()) {
-        out += as_bool() ? "true" : "false";
+        out.write(as_bool() ? "true" : "false");
+    } else if(is_integer()) {
+        //integers are exact, format them directly without a stream
+        char buf[24];
+        auto result = type_ == Type::Int64
+            ? std::to_chars(buf, buf + sizeof(buf), payload_.int64)
+            : std::to_chars(buf, buf + sizeof(buf), payload_.uint64);
+        out.write(std::string_view(buf, static_cast<std::size_t>(result.ptr - buf)));
     } else if(is_number()) {
-        std::ostringstream oss;
-        oss << as_number();
-        out += oss.str();
-    } else if(is_string()) {
-        out += '"';
-        for(char c : as_string()) {
-            switch(c) {
-                case '"': out += "\\\""; break;
-                case '\\': out += "\\\\"; break;
-                case '\n': out += "\\n"; break;
-                case '\r': out += "\\r"; break;
-                case '\t': out += "\\t"; break;
-                default: out += c;
-            }
+        /*
+            std::to_chars with no format/precision gives the shortest string that parses back to the
+            exact same double (ryu style), no locale and no allocation. the old ostringstream version
+            built a stream per number and only kept 6 significant digits, so 3.14159265 came back as 3.14159.
+            json has no nan/inf - emit null rather than something no parser accepts.
+        */
+        double d = payload_.number;
+        if(!std::isfinite(d)) {
+            out.write("null");
+        } else {
+            char buf[32];
+            auto result = std::to_chars(buf, buf + sizeof(buf), d);
+            out.write(std::string_view(buf, static_cast<std::size_t>(result.ptr - buf)));
         }
-        out += '"';
+    } else if(is_string()) {
+        detail::write_escaped(out, as_string());
     } else if(is_array()) {
         const auto& arr = as_array();
-        out += '[';
+        out.put('[');
         bool first = true;
         for(const auto& item : arr) {
-            if(!first) out += ',';
+            if(!first) out.put(',');
             if(indent >= 0) {
-                out += '\n';
-                out += std::string(current_indent + indent, ' ');
+                out.put('\n');
+                out.fill(' ', static_cast<std::size_t>(current_indent + indent));
             }
             item.dump_impl(out, indent, current_indent+indent);
             first = false;
         }
         if(indent >= 0 && !arr.empty()) {
-            out += '\n';
-            out += std::string(current_indent, ' ');
+            out.put('\n');
+            out.fill(' ', static_cast<std::size_t>(current_indent));
         }
-        out += ']';
+        out.put(']');
     } else if(is_object()) {
         const auto& obj = as_object();
-        out += '{';
+        out.put('{');
         bool first = true;
         for(const auto& [key, val] : obj) {
-            if(!first) out += ',';
+            if(!first) out.put(',');
             if(indent >= 0) {
-                out += '\n';
-                out += std::string(current_indent+indent, ' ');
+                out.put('\n');
+                out.fill(' ', static_cast<std::size_t>(current_indent + indent));
             }
-            out += '"';
-            out += key;
-            out += '"';
-            out += ':';
-            if(indent >= 0) out += ' ';
+            detail::write_escaped(out, key.view());
+            out.put(':');
+            if(indent >= 0) out.put(' ');
             val.dump_impl(out, indent, current_indent+indent);
             first = false;
         }
         if(indent >=0 && !obj.empty()) {
-            out += '\n';
-            out += std::string(current_indent, ' ');
+            out.put('\n');
+            out.fill(' ', static_cast<std::size_t>(current_indent));
         }
-        out += '}';
+        out.put('}');
     }
 }
 
-//parser implementation
-class Parser {
-public:
-    explicit Parser(const std::string& input) : input_(input), pos_(0) {}
-    JsonValue parse() {
-        skip_whitespace();
-        auto value = parse_value();
-        skip_whitespace();
-        if(pos_ != input_.size()) {
-            throw ParseError("unexpected characters after JSON", pos_);
-        }
-        return value;
-    }
-
-private:
-    const std::string& input_;
-    std::size_t pos_;
-
-    // helper methods to modify pos_ and parse json content
-    char peek() const {
-        if(pos_ >= input_.size()) return '\0';
-        return input_[pos_];
-    }
-    char consume() {
-        if(pos_ >= input_.size()) {
-            throw ParseError("unexpected end of input", pos_);
-        }
-        return input_[pos_++];
-    }
-    void skip_whitespace() {
-        while(pos_ < input_.size() && std::isspace(input_[pos_])) {
-            ++pos_;
-        }
-    }
-    void expect(char c) {
-        if(consume() != c) {
-            throw ParseError(std::string("expected '") + c + "'", pos_-1);
-        }
-    }
-
-    JsonValue parse_value() {
-        skip_whitespace();
-        char c = peek();
-        if(c == 'n') return parse_null();
-        if(c=='t' || c=='f') return parse_bool();
-        if(c=='"') return parse_string();
-        if(c=='[') return parse_array();
-        if(c=='{') return parse_object();
-        if(c=='-' || std::isdigit(c)) return parse_number();
-        throw ParseError("unexpected character", pos_);
-    }
-
-    JsonValue parse_null() {
-        if(input_.substr(pos_, 4) == "null") {
-            pos_+= 4;
-            return JsonValue(nullptr);
-        }
-        throw ParseError("expected 'null'", pos_);
-    }
-
-    JsonValue parse_bool() {
-        if(input_.substr(pos_, 4) == "true") {
-            pos_+=4;
-            return JsonValue(true);
-        }
-        if(input_.substr(pos_, 5) == "false") {
-            pos_+=5;
-            return JsonValue(false);
-        }
-        throw ParseError("expected 'true' or 'false'", pos_);
-    }
+//parsing --------------------------------------------------------------------
+//the grammar lives in parser.hpp, dom parse is the Parser driving a DomBuilder
+JsonValue parse(std::string_view json){
+    return parse(json, *std::pmr::get_default_resource());
+}
 
-    JsonValue parse_number() {
-        /*
-        note on valid numbers in json:
-            integer:        42, -17, 0
-            decimal:        3.14, -0.5, 0.0
-            exponent:       1e10, 2E5, 1e-3, 3.14e+2
-            negative exp:   1e-10, 5E-3
-            combined:       -3.14e-10
-        invalid:
-            .5              (no leading digit)
-            -.5             (no leading digit)
-            5.              (no digit after decimal)
-            +5              (no leading plus)
-            05              (no leading zeros except 0 itself)
-            00.5            (no leading zeros)
-            0x1F            (no hex)
-            NaN             (not allowed)
-            Infinity        (not allowed)
-        */
+JsonValue parse(const char* data, std::size_t size){
+    return parse(std::string_view(data, size));
+}
 
-        std::size_t start = pos_;
-        if(peek() == '-') ++pos_; //leading neg sign
-
-        //this handles all pre-decimal point & exponents
-        if(peek() == '0') {
-            /*
-                if we lead with zero, it must be:
-                1. end of the value
-                2. followed by decimal
-                3. followed by exponent
-                it CANNOT be followed by more digits
-            */
-            ++pos_;
-        } else if(std::isdigit(peek())) {
-            // only check trailing digits if leading digit is NOT zero
-            while(std::isdigit(peek())) ++pos_;
-        } else {
-            // numeric value cannot lead with a non digit
-            throw ParseError("invalid number", pos_);
-        }
-        
-        //handle decimal point (all decimal must be followed by string of digits)
-        if(peek() == '.') {
-            ++pos_;
-            if(!std::isdigit(peek())) {
-                throw ParseError("invalid number", pos_);
-            }
-            while(std::isdigit(peek())) ++pos_;
-        }
+JsonValue parse(std::string_view json, std::pmr::memory_resource& resource){
+    return parse(json, resource, ParseOptions{});
+}
 
-        //handle exponents (all exponent must be followed by +/- then a string of digits)
-        if(peek() == 'e' || peek() == 'E') {
-            ++pos_;
-            if(peek() == '+' || peek() == '-') ++pos_;
-            if(!std::isdigit(peek())) {
-                throw ParseError("invalid number", pos_);
-            }
-            while(std::isdigit(peek())) ++pos_;
-        }
+JsonValue parse(std::string_view json, const ParseOptions& options){
+    return parse(json, *std::pmr::get_default_resource(), options);
+}
 
-        std::string num_str = input_.substr(start, pos_-start);
-        return JsonValue(std::stod(num_str));
-    }
+namespace {
 
-    JsonValue parse_string() {
-        expect('"');
-        std::string str;
-        while(peek() != '"') {
-            if(peek() == '\0'){
-                throw ParseError("unterminated string", pos_);
-            }
-            if(peek() == '\\') {
-                //deal with escape characters
-                ++pos_;
-                char escape = consume();
-                switch(escape) {
-                    case '"': str += '"'; break;
-                    case '\\': str += '\\'; break;
-                    case '/' : str += '/'; break;
-                    case 'n' : str += '\n'; break;
-                    case 'r' : str += '\r'; break;
-                    case 't' : str += '\t'; break;
-                    case 'b' : str += '\b'; break;
-                    case 'f' : str += '\f'; break;
-                    case 'u': {
-                        //unicode escape: \uXXXX
-                        //our implementation only handles basic multilingual plane. characters above 0xFFFF requires surrogate pairs, which we dont handle.
-                        std::string hex;
-                        for(int i=0; i<4; ++i) {
-                            if(!std::isxdigit(peek())) {
-                                throw ParseError("invalid unicode escape", pos_);
-                            }
-                            hex += consume();
-                        }
-                        int codepoint = std::stoi(hex, nullptr, 16);
-                        if(codepoint < 0x80) {
-                            str += static_cast<char>(codepoint);
-                        } else if (codepoint < 0x800) {
-                            str += static_cast<char>(0xC0 | (codepoint >> 6));
-                            str += static_cast<char>(0x80 | (codepoint & 0x3F));
-                        } else {
-                            str += static_cast<char>(0xE0 | (codepoint >> 12));
-                            str += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
-                            str += static_cast<char>(0x80 | (codepoint & 0x3F));
-                        }
-                        break;
-                    }
-                    default:
-                        throw ParseError("invalid escape sequence", pos_-1);
-                }
+//parse() with ParseOptions::stats: the same engines, run on the counting handler
+template <bool kTimed>
+JsonValue parse_with_stats(std::string_view json, std::pmr::memory_resource& resource, const ParseOptions& options) {
+    ParseStats& stats = *options.stats;
+    stats = ParseStats{};
+    detail::DomBuilder builder(&resource, options.key_pool);
+    if(options.in_situ_strings) builder.borrow_strings_from(json);
+    detail::StatsHandler<kTimed> handler(builder, stats, options.key_pool != nullptr);
+    try {
+        if(options.engine == ParseEngine::StructuralIndex && json.size() <= UINT32_MAX) {
+            std::vector<std::uint32_t> index;
+            if constexpr (kTimed) {
+                auto start = std::chrono::steady_clock::now();
+                detail::build_structural_index(json, index);
+                handler.charge_index(std::chrono::steady_clock::now() - start);
             } else {
-                str += consume();
+                detail::build_structural_index(json, index);
             }
+            detail::IndexedParser<detail::StatsHandler<kTimed>> parser(json, index, handler, options.max_depth);
+            parser.parse();
+        } else {
+            detail::Parser<detail::StatsHandler<kTimed>> parser(json, handler, options.max_depth);
+            parser.parse();
         }
-        expect('"');
-        return JsonValue(std::move(str));
-
+    } catch(const ParseError& e) {
+        stats.bytes = e.position();
+        throw;
     }
+    handler.finish();
+    stats.bytes = json.size();
+    return builder.take();
+}
 
-    JsonValue parse_array() {
-        expect('[');
-        skip_whitespace();
-        JsonArray arr;
-
-        if(peek() == ']') {
-            ++pos_;
-            return JsonValue(std::move(arr));
-        }
+}
 
-        while(true) {
-            arr.push_back(parse_value());
-            skip_whitespace();
-            if(peek() == ']') {
-                ++pos_;
-                return JsonValue(std::move(arr));
-            }
-            expect(',');
-            skip_whitespace();
-        }
+JsonValue parse(std::string_view json, std::pmr::memory_resource& resource, const ParseOptions& options){
+    if(options.stats) {
+        return options.time_phases ? parse_with_stats<true>(json, resource, options) : parse_with_stats<false>(json, resource, options);
     }
-
-    JsonValue parse_object() {
-        expect('{');
-        skip_whitespace();
-        JsonObject obj;
-        if(peek() == '}') {
-            ++pos_;
-            return JsonValue(std::move(obj));
-        }
-        while(true) {
-            skip_whitespace();
-            if(peek() != '"') {
-                throw ParseError("expected string key", pos_);
-            }
-            auto key = parse_string().as_string();
-            skip_whitespace();
-            expect(':');
-            auto value = parse_value();
-            obj[std::move(key)] = std::move(value);
-            skip_whitespace();
-            if(peek() == '}') {
-                ++pos_;
-                return JsonValue(std::move(obj));
-            }
-            expect(',');
-        }
+    if(options.threads != 1) {
+        if(auto parsed = detail::parse_array_parallel(json, resource, options)) return std::move(*parsed);
     }
-};
-
-JsonValue parse(const std::string& json){
-    Parser parser(json);
-    return parser.parse();
+    detail::DomBuilder builder(&resource, options.key_pool);
+    if(options.in_situ_strings) builder.borrow_strings_from(json);
+    //the index holds 32 bit offsets
+    if(options.engine == ParseEngine::StructuralIndex && json.size() <= UINT32_MAX) {
+        detail::parse_indexed(json, builder, options.max_depth);
+    } else {
+        detail::Parser<detail::DomBuilder> parser(json, builder, options.max_depth);
+        parser.parse();
+    }
+    return builder.take();
 }
 
 }
-
-
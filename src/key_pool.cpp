@@ -0,0 +1,125 @@
+#include "json_parser/key_pool.hpp"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace json {
+
+/*
+    notes on the pool:
+    - every string is stored as [size][hash][characters] in an Arena, and the pooled JsonKey points at
+      the characters. JsonKey::hash() reads the hash right in front of them
+    - the high bits of the hash pick the shard, the low bits the slot inside the shard's open
+      addressing table (slots hold the character pointers, nullptr = empty, load factor <= 1/2)
+    - lookups take the shard's lock shared. only a miss takes it exclusive, and looks again before
+      inserting because another thread may have added the string in between
+    - the arenas allocate from new/delete directly, so a pool keeps working while the default
+      resource is swapped out (and never reaches a resource the caller didnt ask for)
+*/
+namespace {
+
+struct Header {
+    std::size_t size;
+    std::size_t hash;
+};
+
+constexpr unsigned kShardBits = 4;
+static_assert(KeyPool::kShards == (1u << kShardBits));
+
+const Header& header_of(const char* chars) noexcept {
+    return *reinterpret_cast<const Header*>(chars - sizeof(Header));
+}
+
+}
+
+struct KeyPool::Shard {
+    mutable std::shared_mutex mutex;
+    std::vector<const char*> slots;
+    std::size_t count = 0;
+    Arena storage{4096, std::pmr::new_delete_resource()};
+
+    const char* find(std::string_view key, std::size_t hash) const noexcept {
+        if(slots.empty()) return nullptr;
+        std::size_t mask = slots.size() - 1;
+        for(std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            const char* chars = slots[slot];
+            if(!chars) return nullptr;
+            const Header& h = header_of(chars);
+            if(h.hash == hash && h.size == key.size() && std::memcmp(chars, key.data(), key.size()) == 0) {
+                return chars;
+            }
+        }
+    }
+
+    const char* insert(std::string_view key, std::size_t hash) {
+        if((count + 1) * 2 > slots.size()) grow();
+        void* p = storage.allocate(sizeof(Header) + key.size(), alignof(Header));
+        auto* header = new(p) Header{key.size(), hash};
+        char* chars = reinterpret_cast<char*>(header + 1);
+        if(!key.empty()) std::memcpy(chars, key.data(), key.size());
+        place(chars, hash);
+        ++count;
+        return chars;
+    }
+
+private:
+    void place(const char* chars, std::size_t hash) noexcept {
+        std::size_t mask = slots.size() - 1;
+        std::size_t slot = hash & mask;
+        while(slots[slot]) slot = (slot + 1) & mask;
+        slots[slot] = chars;
+    }
+
+    void grow() {
+        std::vector<const char*> old(slots.empty() ? 64 : slots.size() * 2, nullptr);
+        old.swap(slots);
+        for(const char* chars : old) {
+            if(chars) place(chars, header_of(chars).hash);
+        }
+    }
+};
+
+KeyPool::KeyPool() : shards_(std::make_unique<Shard[]>(kShards)) {}
+KeyPool::~KeyPool() = default;
+
+JsonKey KeyPool::intern(std::string_view key) {
+    if(key.size() > UINT32_MAX) throw std::length_error("object key too long");
+    std::size_t hash = std::hash<std::string_view>{}(key);
+    Shard& shard = shards_[hash >> (std::numeric_limits<std::size_t>::digits - kShardBits)];
+    const char* chars;
+    {
+        std::shared_lock lock(shard.mutex);
+        chars = shard.find(key, hash);
+    }
+    if(!chars) {
+        std::unique_lock lock(shard.mutex);
+        chars = shard.find(key, hash);
+        if(!chars) chars = shard.insert(key, hash);
+    }
+    return JsonKey::make_external(JsonKey::Kind::Pooled, chars, key.size());
+}
+
+std::size_t KeyPool::size() const {
+    std::size_t total = 0;
+    for(std::size_t i = 0; i < kShards; ++i) {
+        std::shared_lock lock(shards_[i].mutex);
+        total += shards_[i].count;
+    }
+    return total;
+}
+
+std::size_t KeyPool::bytes_used() const {
+    std::size_t total = 0;
+    for(std::size_t i = 0; i < kShards; ++i) {
+        std::shared_lock lock(shards_[i].mutex);
+        total += shards_[i].storage.bytes_used();
+    }
+    return total;
+}
+
+}
@@ -0,0 +1,207 @@
+#include "json_parser/ndjson.hpp"
+#include "dom_builder.hpp"
+#include "parser.hpp"
+#include "thread_pool.hpp"
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+    #define JSON_NDJSON_MMAP 1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #include <fstream>
+    #include <iterator>
+#endif
+
+namespace json {
+
+namespace {
+
+/*
+    notes on the batching:
+    - a batch is [begin, end) of the input, always ending just after a '\n' (or at the end of input),
+      so no line is ever split between two batches
+    - a worker does not know which line its batch starts on (that needs every earlier batch's newline
+      count), so it numbers lines from 0 and the delivering thread adds the running total
+    - every worker parses all of its lines with one Parser + DomBuilder pair, reset per line, so the
+      scratch buffer for escaped strings is allocated once per batch instead of once per line
+*/
+struct BatchResult {
+    std::vector<std::pair<std::size_t, JsonValue>> records;  //(line within the batch, value)
+    std::size_t lines = 0;
+    std::optional<ParseError> error;
+    std::size_t error_line = 0;         //line within the batch
+    std::size_t error_line_offset = 0;  //where that line starts in the whole input
+};
+
+BatchResult parse_batch(std::string_view input, std::size_t begin, std::size_t end, const NdjsonOptions& options) {
+    BatchResult result;
+    detail::DomBuilder builder(std::pmr::get_default_resource(), options.key_pool);
+    detail::Parser<detail::DomBuilder> parser(std::string_view(), builder, options.max_depth);
+    std::size_t pos = begin;
+    std::size_t line = 0;
+    while(pos < end) {
+        const void* newline = std::memchr(input.data() + pos, '\n', end - pos);
+        std::size_t line_end = newline ? static_cast<std::size_t>(static_cast<const char*>(newline) - input.data()) : end;
+        std::string_view text = input.substr(pos, line_end - pos);
+        if(simd::skip_whitespace(text.data(), text.size()) != text.size()) {
+            parser.reset(text);
+            try {
+                parser.parse();
+            } catch(const ParseError& e) {
+                result.error.emplace(e);
+                result.error_line = line;
+                result.error_line_offset = pos;
+                return result;
+            }
+            result.records.emplace_back(line, builder.take());
+        }
+        ++line;
+        pos = line_end + 1;
+    }
+    result.lines = line;
+    return result;
+}
+
+//end of the batch starting at 'begin': the first line end at or after begin + batch_bytes
+std::size_t batch_end(std::string_view input, std::size_t begin, std::size_t batch_bytes) {
+    std::size_t cut = begin + (batch_bytes == 0 ? 1 : batch_bytes);
+    if(cut >= input.size()) return input.size();
+    const void* newline = std::memchr(input.data() + cut - 1, '\n', input.size() - cut + 1);
+    if(!newline) return input.size();
+    return static_cast<std::size_t>(static_cast<const char*>(newline) - input.data()) + 1;
+}
+
+}
+
+std::size_t parse_ndjson(std::string_view input, const NdjsonCallback& on_record, const NdjsonOptions& options) {
+    std::size_t delivered = 0;
+    std::size_t first_line = 1;  //line number of the next batch's first line
+    //false once the callback asked to stop
+    auto deliver = [&](BatchResult& batch) {
+        for(auto& [line, value] : batch.records) {
+            ++delivered;
+            if(!on_record(std::move(value), first_line + line)) return false;
+        }
+        if(batch.error) {
+            throw NdjsonError(*batch.error, first_line + batch.error_line, batch.error_line_offset);
+        }
+        first_line += batch.lines;
+        return true;
+    };
+
+    unsigned threads = options.threads == 0 ? detail::ThreadPool::default_threads() : options.threads;
+    std::size_t next = 0;
+    if(threads == 1) {
+        while(next < input.size()) {
+            std::size_t end = batch_end(input, next, options.batch_bytes);
+            BatchResult batch = parse_batch(input, next, end, options);
+            if(!deliver(batch)) break;
+            next = end;
+        }
+        return delivered;
+    }
+
+    //two batches per thread in flight: workers never wait for the delivering thread, and memory
+    //stays bounded however big the input is. the pool is declared first so it outlives the futures
+    detail::ThreadPool pool(threads);
+    std::deque<std::future<BatchResult>> in_flight;
+    auto fill = [&] {
+        while(in_flight.size() < 2 * static_cast<std::size_t>(threads) && next < input.size()) {
+            std::size_t begin = next;
+            std::size_t end = batch_end(input, begin, options.batch_bytes);
+            in_flight.push_back(pool.submit([input, begin, end, options] {
+                return parse_batch(input, begin, end, options);
+            }));
+            next = end;
+        }
+    };
+    fill();
+    while(!in_flight.empty()) {
+        BatchResult batch = in_flight.front().get();
+        in_flight.pop_front();
+        fill();
+        if(!deliver(batch)) break;
+    }
+    return delivered;
+}
+
+std::vector<JsonValue> parse_ndjson(std::string_view input, const NdjsonOptions& options) {
+    std::vector<JsonValue> records;
+    parse_ndjson(input, [&](JsonValue&& record, std::size_t) {
+        records.push_back(std::move(record));
+        return true;
+    }, options);
+    return records;
+}
+
+#if defined(JSON_NDJSON_MMAP)
+
+namespace {
+
+//read only mapping of a whole file, unmapped on scope exit
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        struct stat info{};
+        if(::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat " + path);
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        if(size_ > 0) {
+            void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("cannot map " + path);
+            }
+            data_ = static_cast<const char*>(data);
+            //the file is read front to back once
+            ::madvise(data, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);  //the mapping stays valid without the descriptor
+    }
+    ~MappedFile() {
+        if(data_) ::munmap(const_cast<char*>(data_), size_);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] std::string_view view() const noexcept {return std::string_view(data_, size_);}
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}
+
+std::size_t parse_ndjson_file(const std::string& path, const NdjsonCallback& on_record, const NdjsonOptions& options) {
+    MappedFile file(path);
+    return parse_ndjson(file.view(), on_record, options);
+}
+
+#else
+
+std::size_t parse_ndjson_file(const std::string& path, const NdjsonCallback& on_record, const NdjsonOptions& options) {
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return parse_ndjson(contents, on_record, options);
+}
+
+#endif
+
+}
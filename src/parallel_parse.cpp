@@ -0,0 +1,101 @@
+#include "parallel_parse.hpp"
+#include "dom_builder.hpp"
+#include "parser.hpp"
+#include "structural_index.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <memory_resource>
+#include <vector>
+
+namespace json::detail {
+
+namespace {
+
+/*
+    notes on the parallel parse:
+    - split_top_level_array() finds the commas of the root array in one simd pass (no index is kept),
+      so the number of elements is known before anything is parsed. the result array is sized once
+      and every worker moves its values straight into their slots - there is no stitching pass.
+    - elements are grouped into chunks of roughly chunk_bytes and handed to the pool. there are
+      several chunks per thread and the pool has one shared queue, so a thread that finishes early
+      just takes the next chunk - uneven records balance out the way work stealing would.
+    - each chunk gets its own Parser + DomBuilder over the whole input, so values (and error
+      positions) are exactly what the serial parse gives. elements are one level down, hence max_depth - 1
+    - anything wrong (an element fails to parse, junk between elements) makes us parse the whole
+      document again serially, so errors are the serial parse's errors, first one in the document
+*/
+void parse_chunk(std::string_view json, const std::vector<std::size_t>& separators, std::size_t first, std::size_t last,
+                 JsonArray& out, std::pmr::memory_resource& resource, const ParseOptions& options) {
+    DomBuilder builder(&resource, options.key_pool);
+    if(options.in_situ_strings) builder.borrow_strings_from(json);
+    Parser<DomBuilder> parser(json, builder, options.max_depth - 1);
+    for(std::size_t i = first; i < last; ++i) {
+        std::size_t end = parser.parse_value_at(separators[i] + 1);
+        end += simd::skip_whitespace(json.data() + end, json.size() - end);
+        if(end != separators[i + 1]) {
+            throw ParseError("expected ','", end);
+        }
+        out[i] = builder.take();
+    }
+}
+
+//std::pmr::memory_resource has no way to say whether it is thread safe: only trust the ones that are
+//by definition, or the caller's word. everything else (Arena, monotonic / unsynchronized pools) is parsed serially
+bool shareable(std::pmr::memory_resource& resource, const ParseOptions& options) {
+    return options.thread_safe_resource || &resource == std::pmr::new_delete_resource() ||
+           dynamic_cast<std::pmr::synchronized_pool_resource*>(&resource) != nullptr;
+}
+
+}
+
+std::optional<JsonValue> parse_array_parallel(std::string_view json, std::pmr::memory_resource& resource,
+                                              const ParseOptions& options) {
+    unsigned threads = options.threads == 0 ? ThreadPool::default_threads() : options.threads;
+    if(threads <= 1 || json.size() < ParseOptions::kParallelMinBytes || options.max_depth == 0 || !shareable(resource, options)) {
+        return std::nullopt;
+    }
+    std::vector<std::size_t> separators;
+    if(!split_top_level_array(json, separators)) return std::nullopt;
+    std::size_t count = separators.size() - 1;
+    //"[ ]" has two separators and no element
+    if(count == 1 && separators[0] + 1 + simd::skip_whitespace(json.data() + separators[0] + 1,
+                                                                separators[1] - separators[0] - 1) == separators[1]) {
+        return std::nullopt;
+    }
+
+    JsonArray arr(&resource);
+    arr.resize(count);
+    std::size_t chunk_bytes = std::max<std::size_t>(json.size() / (std::size_t{threads} * 8), 64 << 10);
+    {
+        //declared after arr, so the workers are joined before arr could go away
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> chunks;
+        for(std::size_t first = 0; first < count;) {
+            std::size_t last = first + 1;
+            while(last < count && separators[last] - separators[first] < chunk_bytes) ++last;
+            chunks.push_back(pool.submit([&, first, last] {
+                parse_chunk(json, separators, first, last, arr, resource, options);
+            }));
+            first = last;
+        }
+        //every chunk is waited for before anything is thrown, the workers write into arr
+        bool failed = false;
+        std::exception_ptr error;
+        for(auto& chunk : chunks) {
+            try {
+                chunk.get();
+            } catch(const ParseError&) {
+                failed = true;
+            } catch(...) {
+                if(!error) error = std::current_exception();
+            }
+        }
+        if(error) std::rethrow_exception(error);
+        if(failed) return std::nullopt;
+    }
+    return JsonValue(std::move(arr));
+}
+
+}
@@ -0,0 +1,22 @@
+#ifndef JSON_PARALLEL_PARSE_HPP
+#define JSON_PARALLEL_PARSE_HPP
+
+#include "json_parser/json.hpp"
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+
+namespace json::detail {
+
+/*
+    json::parse() with ParseOptions::threads != 1: a document that is one big top-level array has its
+    elements parsed on several threads, straight into their slots of the result array.
+    nullopt when that does not apply (small input, root is not an array, resource is an Arena,
+    threads resolves to 1) - the caller then parses serially as usual.
+*/
+std::optional<JsonValue> parse_array_parallel(std::string_view json, std::pmr::memory_resource& resource,
+                                              const ParseOptions& options);
+
+}
+
+#endif
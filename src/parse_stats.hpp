@@ -0,0 +1,188 @@
+#ifndef JSON_PARSE_STATS_HPP
+#define JSON_PARSE_STATS_HPP
+
+#include "json_parser/json.hpp"
+#include "dom_builder.hpp"
+#include "parser.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace json::detail {
+
+/*
+    the handler parse() runs when ParseOptions::stats is set: every event is counted and then handed
+    to the DomBuilder as usual. plain parses never instantiate it, so they carry none of this.
+
+    - depth comes from children_, the number of values in every open container so far. the same
+      numbers are what the builder reserves when the container ends, so the container allocations
+      follow from them: the node, then size * 16 (array) / size * 32 (object) bytes, plus the index
+      of a large object. strings are a node and their buffer when they do not fit JsonString's own
+      (none when Small or borrowed), long keys without a KeyPool one each (when a duplicate key
+      collapsed two members, by going over the finished object). tests/parse_stats_test.cpp holds this against a counting memory resource.
+    - kTimed adds the PhaseProbe hooks. time is charged exclusively: at every switch the clock is read
+      and the time since the last read goes to the phase that was running. the builder events nest
+      inside numbers (emit_number calls the handler) and are still charged to build only.
+*/
+template <bool kTimed>
+class StatsHandler {
+public:
+    StatsHandler(DomBuilder& builder, ParseStats& stats, bool pooled_keys)
+        : builder_(builder), stats_(stats), pooled_(pooled_keys), string_inline_(JsonString().capacity()) {
+        if constexpr (kTimed) last_ = Clock::now();
+    }
+
+    bool on_null() {return scalar(stats_.nulls, [&] {return builder_.on_null();});}
+    bool on_bool(bool b) {return scalar(stats_.bools, [&] {return builder_.on_bool(b);});}
+    bool on_number(double d) {return scalar(stats_.doubles, [&] {return builder_.on_number(d);});}
+    bool on_int64(std::int64_t i) {return scalar(stats_.integers, [&] {return builder_.on_int64(i);});}
+    bool on_uint64(std::uint64_t u) {return scalar(stats_.integers, [&] {return builder_.on_uint64(u);});}
+    bool on_string(std::string_view s) {
+        if(s.size() > JsonValue::kSmallString && !builder_.borrowed_from(s)) {
+            allocated(sizeof(JsonString));
+            if(s.size() > string_inline_) allocated(s.size() + 1);
+        }
+        return scalar(stats_.strings, [&] {return builder_.on_string(s);});
+    }
+    bool on_key(std::string_view k) {
+        ++stats_.keys;
+        if(!pooled_ && k.size() > JsonKey::kInlineCapacity) {
+            ++children_.back().owned_keys;
+            children_.back().key_bytes += k.size();
+        }
+        return build([&] {return builder_.on_key(k);});
+    }
+    bool on_start_array() {
+        open_container();
+        return build([&] {return builder_.on_start_array();});
+    }
+    bool on_start_object() {
+        open_container();
+        return build([&] {return builder_.on_start_object();});
+    }
+    bool on_end_array() {
+        ++stats_.arrays;
+        std::size_t n = close_container().values;
+        allocated(sizeof(JsonArray));
+        if(n > 0) allocated(n * sizeof(JsonValue));
+        return build([&] {return builder_.on_end_array();});
+    }
+    bool on_end_object() {
+        ++stats_.objects;
+        Open open = close_container();
+        std::size_t n = open.values;
+        allocated(sizeof(JsonObject));
+        if(n > 0) allocated(n * sizeof(JsonObject::value_type));
+        if(std::size_t slots = JsonObject::index_slots(n)) allocated(slots * sizeof(std::uint32_t));
+        bool ok = build([&] {return builder_.on_end_object();});
+        const JsonObject& obj = builder_.last().as_object();
+        if(obj.size() == n) {
+            stats_.allocations += open.owned_keys;
+            stats_.bytes_allocated += open.key_bytes;
+        } else {
+            //a duplicate key reused the first one's member, count the keys that were actually kept
+            for(const auto& [key, value] : obj) {
+                if(!key.is_pooled() && key.size() > JsonKey::kInlineCapacity) allocated(key.size());
+            }
+        }
+        return ok;
+    }
+
+    void enter_phase(ParsePhase phase) requires kTimed {
+        switch_phase();
+        saved_[depth_++] = current_;
+        current_ = static_cast<std::size_t>(phase);
+    }
+    void leave_phase() requires kTimed {
+        switch_phase();
+        current_ = saved_[--depth_];
+    }
+    //a phase of its own, run before the parser (the structural index). the clock starts over after it
+    void charge_index(std::chrono::nanoseconds t) requires kTimed {
+        stats_.time.index += t;
+        last_ = Clock::now();
+    }
+
+    //the time since the last switch goes to whatever is still running, then into the stats
+    void finish() {
+        if constexpr (kTimed) {
+            switch_phase();
+            auto at = [&](ParsePhase p) {return std::chrono::duration_cast<std::chrono::nanoseconds>(time_[static_cast<std::size_t>(p)]);};
+            stats_.time.whitespace += at(ParsePhase::Whitespace);
+            stats_.time.strings += at(ParsePhase::Strings);
+            stats_.time.numbers += at(ParsePhase::Numbers);
+            stats_.time.build += at(ParsePhase::Build);
+            stats_.time.other += std::chrono::duration_cast<std::chrono::nanoseconds>(time_[kOther]);
+            time_ = {};
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    //the phases the parser reports, then 'other' for the time outside all of them
+    static constexpr std::size_t kOther = static_cast<std::size_t>(ParsePhase::Build) + 1;
+    //an open container: values so far, and its long keys that are not interned (each one allocation)
+    struct Open {
+        std::size_t values;
+        std::size_t owned_keys;
+        std::size_t key_bytes;
+    };
+
+    DomBuilder& builder_;
+    ParseStats& stats_;
+    bool pooled_;                //long keys go to a KeyPool
+    std::size_t string_inline_;  //longest string that lives in JsonString itself, without a buffer of its own
+    std::vector<Open> children_;
+    //kTimed only: the phase running now and the ones it interrupted (the parser nests at most two deep)
+    std::array<Clock::duration, kOther + 1> time_{};
+    std::array<std::size_t, 4> saved_{};
+    std::size_t depth_ = 0;
+    std::size_t current_ = kOther;
+    Clock::time_point last_{};
+
+    void switch_phase() {
+        Clock::time_point now = Clock::now();
+        time_[current_] += now - last_;
+        last_ = now;
+    }
+    template <typename F>
+    bool build(F&& event) {
+        if constexpr (kTimed) {
+            enter_phase(ParsePhase::Build);
+            bool ok = event();
+            leave_phase();
+            return ok;
+        } else {
+            return event();
+        }
+    }
+    template <typename F>
+    bool scalar(std::size_t& count, F&& event) {
+        ++count;
+        child();
+        return build(event);
+    }
+    void child() noexcept {
+        if(!children_.empty()) ++children_.back().values;
+    }
+    void open_container() {
+        child();
+        children_.push_back(Open{0, 0, 0});
+        if(children_.size() > stats_.max_depth) stats_.max_depth = children_.size();
+    }
+    Open close_container() noexcept {
+        Open open = children_.back();
+        children_.pop_back();
+        return open;
+    }
+    void allocated(std::size_t bytes) noexcept {
+        ++stats_.allocations;
+        stats_.bytes_allocated += bytes;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,554 @@
+#ifndef JSON_PARSER_IMPL_HPP
+#define JSON_PARSER_IMPL_HPP
+
+#include "json_parser/json.hpp"
+#include "simd.hpp"
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json::detail {
+
+/*
+    number & escape helpers shared by Parser and the incremental (push) parser, so both agree on
+    exactly what is a valid number and how it is converted.
+*/
+struct NumberScan {
+    std::size_t length;  //length of the literal, or offset of the offending char if !ok
+    bool is_integer;     //no '.' and no exponent
+    bool ok;
+    bool has_exponent;   //only an exponent can take a short literal out of double's range
+};
+
+inline bool is_digit(char c) noexcept {
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_structural_char(char c) noexcept {
+    return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+}
+
+inline NumberScan scan_number(const char* first, const char* last) noexcept {
+    /*
+    note on valid numbers in json:
+        integer:        42, -17, 0
+        decimal:        3.14, -0.5, 0.0
+        exponent:       1e10, 2E5, 1e-3, 3.14e+2
+        negative exp:   1e-10, 5E-3
+        combined:       -3.14e-10
+    invalid:
+        .5              (no leading digit)
+        -.5             (no leading digit)
+        5.              (no digit after decimal)
+        +5              (no leading plus)
+        05              (no leading zeros except 0 itself)
+        00.5            (no leading zeros)
+        0x1F            (no hex)
+        NaN             (not allowed)
+        Infinity        (not allowed)
+    */
+    const char* p = first;
+    auto at = [&](const char* q) {return q < last ? *q : '\0';};
+    auto fail = [&]() {return NumberScan{static_cast<std::size_t>(p - first), false, false, false};};
+
+    if(at(p) == '-') ++p; //leading neg sign
+
+    //this handles all pre-decimal point & exponents
+    if(at(p) == '0') {
+        /*
+            if we lead with zero, it must be:
+            1. end of the value
+            2. followed by decimal
+            3. followed by exponent
+            it CANNOT be followed by more digits
+        */
+        ++p;
+    } else if(is_digit(at(p))) {
+        // only check trailing digits if leading digit is NOT zero
+        while(is_digit(at(p))) ++p;
+    } else {
+        // numeric value cannot lead with a non digit
+        return fail();
+    }
+    bool is_integer = true;
+    bool has_exponent = false;
+
+    //handle decimal point (all decimal must be followed by string of digits)
+    if(at(p) == '.') {
+        is_integer = false;
+        ++p;
+        if(!is_digit(at(p))) return fail();
+        while(is_digit(at(p))) ++p;
+    }
+
+    //handle exponents (all exponent must be followed by +/- then a string of digits)
+    if(at(p) == 'e' || at(p) == 'E') {
+        is_integer = false;
+        has_exponent = true;
+        ++p;
+        if(at(p) == '+' || at(p) == '-') ++p;
+        if(!is_digit(at(p))) return fail();
+        while(is_digit(at(p))) ++p;
+    }
+    return NumberScan{static_cast<std::size_t>(p - first), is_integer, true, has_exponent};
+}
+
+/*
+    convert a literal that already passed scan_number and report it.
+    - integer literals that fit in 64 bits are exact: int64 when they fit, otherwise uint64.
+      std::from_chars on integers does the overflow check for us and never touches float parsing.
+    - "-0" stays a double so the sign survives
+    - everything else (fractions, exponents, integers past 64 bits) goes through std::from_chars:
+        no allocation (std::stod needed a null terminated std::string copy of the view)
+        locale independent (stod honours the C locale's decimal point)
+        correctly rounded, so round trips are exact
+      the grammar is already validated, so the only failure left is out of range.
+    'pos' is only used for the error position.
+*/
+template <typename Handler>
+bool emit_number(std::string_view literal, bool is_integer, std::size_t pos, Handler& handler) {
+    const char* first = literal.data();
+    const char* last = first + literal.size();
+    if(is_integer) {
+        if(*first == '-') {
+            std::int64_t value = 0;
+            auto [end, ec] = std::from_chars(first, last, value);
+            if(ec == std::errc() && end == last) {
+                if(value == 0) return handler.on_number(-0.0);
+                return handler.on_int64(value);
+            }
+        } else {
+            std::uint64_t value = 0;
+            auto [end, ec] = std::from_chars(first, last, value);
+            if(ec == std::errc() && end == last) {
+                if(value <= static_cast<std::uint64_t>(INT64_MAX)) {
+                    return handler.on_int64(static_cast<std::int64_t>(value));
+                }
+                return handler.on_uint64(value);
+            }
+        }
+        //too big for 64 bits - fall through to double
+    }
+    double value = 0.0;
+    auto [end, ec] = std::from_chars(first, last, value);
+    if(ec != std::errc() || end != last) {
+        throw ParseError("number out of range", pos);
+    }
+    return handler.on_number(value);
+}
+
+// value of a hex digit, or -1
+inline int hex_value(char c) noexcept {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// the single character a simple escape (\n, \t, ...) stands for, or 0 if it isnt one ('u' included)
+inline char simple_escape(char escape) noexcept {
+    switch(escape) {
+        case '"': return '"';
+        case '\\': return '\\';
+        case '/' : return '/';
+        case 'n' : return '\n';
+        case 'r' : return '\r';
+        case 't' : return '\t';
+        case 'b' : return '\b';
+        case 'f' : return '\f';
+        default: return 0;
+    }
+}
+
+//our implementation only handles basic multilingual plane. characters above 0xFFFF requires surrogate pairs, which we dont handle.
+inline void append_utf8(std::string& out, unsigned codepoint) {
+    if(codepoint < 0x80) {
+        out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+/*
+    the string whose opening quote is at input[pos]; pos ends up just past the closing quote.
+    strings without escapes come back as a view into the input, escaped ones are decoded into scratch.
+    a raw control character (below 0x20, e.g. a literal newline) is malformed (RFC 8259 section 7),
+    the block scan stops at those as well as at '"' and '\\' (find_escape_char)
+*/
+inline std::string_view scan_string(std::string_view input, std::size_t& pos, std::string& scratch) {
+    ++pos; //opening quote
+    std::size_t start = pos;
+    //scan to the next '"', '\\' or control character in blocks
+    std::size_t run = simd::find_escape_char(input.data() + pos, input.size() - pos);
+    pos += run;
+    if(pos >= input.size()) {
+        throw ParseError("unterminated string", pos);
+    }
+    if(input[pos] == '"') {
+        //no escapes: the string is exactly the bytes in the input
+        ++pos;
+        return input.substr(start, run);
+    }
+    if(input[pos] != '\\') {
+        throw ParseError("control character in string", pos);
+    }
+
+    scratch.assign(input.data() + start, run);
+    while(true) {
+        //its a backslash - deal with escape characters
+        ++pos;
+        if(pos >= input.size()) {
+            throw ParseError("unexpected end of input", pos);
+        }
+        char escape = input[pos++];
+        if(char c = simple_escape(escape)) {
+            scratch += c;
+        } else if(escape == 'u') {
+            //unicode escape: \uXXXX
+            unsigned codepoint = 0;
+            for(int i=0; i<4; ++i) {
+                int digit = pos < input.size() ? hex_value(input[pos]) : -1;
+                if(digit < 0) {
+                    throw ParseError("invalid unicode escape", pos);
+                }
+                codepoint = codepoint * 16 + static_cast<unsigned>(digit);
+                ++pos;
+            }
+            append_utf8(scratch, codepoint);
+        } else {
+            throw ParseError("invalid escape sequence", pos-1);
+        }
+
+        //append the clean run up to the next '"', '\\' or control character in one go
+        run = simd::find_escape_char(input.data() + pos, input.size() - pos);
+        scratch.append(input.data() + pos, run);
+        pos += run;
+        if(pos >= input.size()) {
+            throw ParseError("unterminated string", pos);
+        }
+        if(input[pos] == '"') break;
+        if(input[pos] != '\\') {
+            throw ParseError("control character in string", pos);
+        }
+    }
+    ++pos; //closing quote
+    return scratch;
+}
+
+/*
+    scan_string for a caller that only wants to know the string is valid: the same checks and the same
+    errors (escapes, the 4 hex digits of \u, control characters, the closing quote), nothing decoded.
+    pos as for scan_string
+*/
+inline void skip_string(std::string_view input, std::size_t& pos) {
+    ++pos; //opening quote
+    while(true) {
+        pos += simd::find_escape_char(input.data() + pos, input.size() - pos);
+        if(pos >= input.size()) {
+            throw ParseError("unterminated string", pos);
+        }
+        if(input[pos] == '"') break;
+        if(input[pos] != '\\') {
+            throw ParseError("control character in string", pos);
+        }
+        ++pos;
+        if(pos >= input.size()) {
+            throw ParseError("unexpected end of input", pos);
+        }
+        char escape = input[pos++];
+        if(escape == 'u') {
+            for(int i=0; i<4; ++i, ++pos) {
+                if(pos >= input.size() || hex_value(input[pos]) < 0) {
+                    throw ParseError("invalid unicode escape", pos);
+                }
+            }
+        } else if(!simple_escape(escape)) {
+            throw ParseError("invalid escape sequence", pos-1);
+        }
+    }
+    ++pos; //closing quote
+}
+
+/*
+    the parser shared by every front end (dom parse, sax, ...): the json grammar walked with an explicit
+    stack of open containers instead of recursion (see parse_value).
+
+    it does not build anything itself - every token is reported to a Handler:
+        bool on_null();
+        bool on_bool(bool);
+        bool on_number(double);
+        bool on_int64(std::int64_t);
+        bool on_uint64(std::uint64_t);
+        bool on_string(std::string_view);
+        bool on_key(std::string_view);
+        bool on_start_object();   bool on_end_object();
+        bool on_start_array();    bool on_end_array();
+    returning false from any of them stops the parse (parse() then returns false).
+
+    Handler is a template parameter rather than a virtual interface so the dom builder gets every
+    call inlined - the public SaxHandler is just one more Handler that happens to be virtual.
+
+    string_views passed to on_string / on_key are only valid during the call:
+    - strings without escapes are views straight into the input (no copy at all)
+    - strings with escapes are decoded into a scratch buffer that is reused for the next string
+
+    a Handler that also has enter_phase(ParsePhase) / leave_phase() (the ParseStats handler with
+    time_phases, see parse_stats.hpp) is told when scanning whitespace, a string or a number starts and
+    ends. for any other Handler those calls are compiled out - the plain parse pays nothing for them.
+
+    a Handler with 'static constexpr bool kSkipsValues = true' (the validator, see validate.cpp) gets
+    the structure and no values: strings are checked by skip_string and reported empty, numbers are
+    only scanned and reported as 0. the one number that is still converted is one that could be out of
+    range (an exponent, or a literal too long to fit a double), so the errors stay parse()'s errors.
+
+    a Handler with 'static constexpr bool kTracksValueStart = true' (the binder, see bind.cpp) can ask
+    value_start() for where the value it is being told about begins, to report errors there.
+*/
+enum class ParsePhase : std::uint8_t {Whitespace, Strings, Numbers, Build};
+
+template <typename Handler>
+concept PhaseProbe = requires(Handler& h) {
+    h.enter_phase(ParsePhase::Whitespace);
+    h.leave_phase();
+};
+
+template <typename Handler>
+concept SkipsValues = Handler::kSkipsValues;
+
+template <typename Handler>
+concept TracksValueStart = Handler::kTracksValueStart;
+
+template <typename Handler>
+class Parser {
+public:
+    Parser(std::string_view input, Handler& handler, std::size_t max_depth = ParseOptions::kDefaultMaxDepth)
+        : input_(input), pos_(0), handler_(handler), max_depth_(max_depth) {}
+
+    //true if the whole document was parsed, false if the handler stopped early
+    bool parse() {
+        skip_whitespace();
+        if(!parse_value()) return false;
+        skip_whitespace();
+        if(pos_ != input_.size()) {
+            throw ParseError("unexpected characters after JSON", pos_);
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::size_t position() const noexcept {return pos_;}
+    //start of the value last reported to the handler (TracksValueStart handlers only)
+    [[nodiscard]] std::size_t value_start() const noexcept {return value_start_;}
+
+    //parse just the value that starts at 'start' and return the position right after it.
+    //whatever follows is left alone - the lazy Document decodes single subtrees of a bigger input this way
+    std::size_t parse_value_at(std::size_t start) {
+        pos_ = start;
+        parse_value();
+        return pos_;
+    }
+
+    //start over on a new input, keeping the scratch buffers (for callers that parse many small documents)
+    void reset(std::string_view input) noexcept {
+        input_ = input;
+        pos_ = 0;
+    }
+
+private:
+    /*
+        the parser only ever reads the input, so we hold a view instead of a const std::string&.
+        this lets callers hand us network buffers / mmap'd files directly without materializing a std::string.
+        the view must outlive the parser (it does - parser only lives for the duration of parse()).
+    */
+    std::string_view input_;
+    std::size_t pos_;
+    Handler& handler_;
+    std::size_t max_depth_;
+    std::size_t value_start_ = 0;
+    //decoded form of the current string when it contains escapes
+    std::string scratch_;
+    //open containers, innermost last
+    std::vector<char> stack_;
+
+    // helper methods to modify pos_ and parse json content
+    char peek() const {
+        if(pos_ >= input_.size()) return '\0';
+        return input_[pos_];
+    }
+    char consume() {
+        if(pos_ >= input_.size()) {
+            throw ParseError("unexpected end of input", pos_);
+        }
+        return input_[pos_++];
+    }
+    void skip_whitespace() {
+        //most tokens in compact json are not followed by whitespace at all - check that inline
+        //before paying for the call into the block scanning kernel
+        if(pos_ >= input_.size() || !simd::is_whitespace(input_[pos_])) return;
+        enter(ParsePhase::Whitespace);
+        ++pos_;
+        pos_ += simd::skip_whitespace(input_.data() + pos_, input_.size() - pos_);
+        leave();
+    }
+    //the phase hooks (see PhaseProbe). after a ParseError an enter() may have no leave(), the
+    //handler is not used any more then
+    void enter(ParsePhase phase) {
+        if constexpr (PhaseProbe<Handler>) handler_.enter_phase(phase);
+    }
+    void leave() {
+        if constexpr (PhaseProbe<Handler>) handler_.leave_phase();
+    }
+    void expect(char c) {
+        if(consume() != c) {
+            throw ParseError(std::string("expected '") + c + "'", pos_-1);
+        }
+    }
+
+    /*
+        no recursion: stack_ holds the opening bracket of every open container ('[' or '{'), so nesting
+        costs one byte of heap per level instead of three stack frames, and a hostile "[[[[..." fails
+        with a ParseError at max_depth_ instead of overflowing the thread's stack.
+        the labels are the states of the grammar. once a value is complete (value_done) we jump to the
+        continuation of the innermost open container, so arrays and objects each keep their own code
+        instead of one loop that branches on the container type at every token.
+    */
+    bool parse_value() {
+        stack_.clear();
+    value:
+        skip_whitespace();
+        if constexpr (TracksValueStart<Handler>) value_start_ = pos_;
+        switch(peek()) {
+            case '[':
+                if(!open_container('[')) return false;
+                if(peek() == ']') goto array_end;
+                goto value;
+            case '{':
+                if(!open_container('{')) return false;
+                if(peek() == '}') goto object_end;
+                goto object_member;
+            default:
+                if(!parse_scalar(peek())) return false;
+                break;
+        }
+    value_done:
+        if(stack_.empty()) return true;
+        skip_whitespace();
+        if(stack_.back() == '{') goto object_next;
+        //array_next
+        if(peek() == ']') goto array_end;
+        expect(',');
+        goto value;
+    array_end:
+        ++pos_;
+        stack_.pop_back();
+        if(!handler_.on_end_array()) return false;
+        goto value_done;
+    object_next:
+        if(peek() == '}') goto object_end;
+        expect(',');
+    object_member:
+        if(!parse_key()) return false;
+        goto value;
+    object_end:
+        ++pos_;
+        stack_.pop_back();
+        if(!handler_.on_end_object()) return false;
+        goto value_done;
+    }
+
+    bool parse_scalar(char c) {
+        if(c == 'n') return parse_null();
+        if(c=='t' || c=='f') return parse_bool();
+        if(c=='"') return handler_.on_string(parse_string());
+        if(c=='-' || is_digit(c)) return parse_number();
+        throw ParseError("unexpected character", pos_);
+    }
+
+    //pos_ is at '[' / '{'. leaves pos_ at the first non whitespace character inside
+    bool open_container(char c) {
+        if(stack_.size() >= max_depth_) {
+            throw ParseError("maximum nesting depth exceeded", pos_);
+        }
+        ++pos_;
+        stack_.push_back(c);
+        if(!(c == '[' ? handler_.on_start_array() : handler_.on_start_object())) return false;
+        skip_whitespace();
+        return true;
+    }
+
+    //a member's key and the ':' after it
+    bool parse_key() {
+        skip_whitespace();
+        if(peek() != '"') {
+            throw ParseError("expected string key", pos_);
+        }
+        if(!handler_.on_key(parse_string())) return false;
+        skip_whitespace();
+        expect(':');
+        return true;
+    }
+
+    bool parse_null() {
+        if(input_.substr(pos_, 4) == "null") {
+            pos_+= 4;
+            return handler_.on_null();
+        }
+        throw ParseError("expected 'null'", pos_);
+    }
+
+    bool parse_bool() {
+        if(input_.substr(pos_, 4) == "true") {
+            pos_+=4;
+            return handler_.on_bool(true);
+        }
+        if(input_.substr(pos_, 5) == "false") {
+            pos_+=5;
+            return handler_.on_bool(false);
+        }
+        throw ParseError("expected 'true' or 'false'", pos_);
+    }
+
+    bool parse_number() {
+        enter(ParsePhase::Numbers);
+        auto scan = scan_number(input_.data() + pos_, input_.data() + input_.size());
+        if(!scan.ok) {
+            throw ParseError("invalid number", pos_ + scan.length);
+        }
+        std::size_t start = pos_;
+        pos_ += scan.length;
+        bool ok;
+        if constexpr (SkipsValues<Handler>) {
+            //any literal of at most 300 chars without an exponent is within +-1e300
+            ok = scan.has_exponent || scan.length > 300 ? emit_number(input_.substr(start, scan.length), scan.is_integer, start, handler_)
+                                                         : handler_.on_int64(0);
+        } else {
+            ok = emit_number(input_.substr(start, scan.length), scan.is_integer, start, handler_);
+        }
+        leave();
+        return ok;
+    }
+
+    //shared by string values & object keys. see the note at the top on how long the view lives
+    std::string_view parse_string() {
+        enter(ParsePhase::Strings);
+        std::string_view s;
+        if constexpr (SkipsValues<Handler>) {
+            skip_string(input_, pos_);
+        } else {
+            s = scan_string(input_, pos_, scratch_);
+        }
+        leave();
+        return s;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include "json_parser/parser_context.hpp"
+#include "dom_builder.hpp"
+#include "parser.hpp"
+#include "structural_index.hpp"
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+namespace json {
+
+/*
+    everything json::parse() would make per call, made once: both parsers point at the one builder,
+    and index is refilled by build_structural_index() (it only ever grows)
+*/
+struct ParserContext::Impl {
+    Impl(const ParseOptions& opts, std::pmr::memory_resource* upstream)
+        : options(opts), arena(4096, upstream), builder(&arena, opts.key_pool),
+          parser(std::string_view(), builder, opts.max_depth), indexed(std::string_view(), index, builder, opts.max_depth) {}
+
+    ParseOptions options;
+    Arena arena;
+    detail::DomBuilder builder;
+    std::vector<std::uint32_t> index;
+    detail::Parser<detail::DomBuilder> parser;
+    detail::IndexedParser<detail::DomBuilder> indexed;
+    JsonValue document;  //the last parse(json), in arena
+
+    JsonValue run(std::string_view json, std::pmr::memory_resource& resource) {
+        builder.set_resource(&resource);
+        builder.borrow_strings_from(options.in_situ_strings ? json : std::string_view());
+        try {
+            //the index holds 32 bit offsets
+            if(options.engine == ParseEngine::StructuralIndex && json.size() <= UINT32_MAX) {
+                detail::build_structural_index(json, index);
+                indexed.reset(json, index);
+                indexed.parse();
+            } else {
+                parser.reset(json);
+                parser.parse();
+            }
+        } catch(...) {
+            builder.clear();
+            throw;
+        }
+        return builder.take();
+    }
+};
+
+ParserContext::ParserContext(const ParseOptions& options, std::pmr::memory_resource& upstream)
+    : impl_(std::make_unique<Impl>(options, &upstream)) {}
+ParserContext::~ParserContext() = default;
+ParserContext::ParserContext(ParserContext&&) noexcept = default;
+ParserContext& ParserContext::operator=(ParserContext&&) noexcept = default;
+
+JsonValue& ParserContext::parse(std::string_view json) {
+    //the old document has to go before the arena hands its memory out again
+    impl_->document = JsonValue();
+    impl_->arena.reset();
+    impl_->document = impl_->run(json, impl_->arena);
+    return impl_->document;
+}
+
+JsonValue ParserContext::parse(std::string_view json, std::pmr::memory_resource& resource) {
+    return impl_->run(json, resource);
+}
+
+const Arena& ParserContext::arena() const noexcept {
+    return impl_->arena;
+}
+
+}
@@ -0,0 +1,559 @@
+#include "json_parser/patch.hpp"
+#include "json_parser/path.hpp"
+#include "json_parser/writer.hpp"
+#include "serialize.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace json {
+
+namespace {
+
+constexpr std::size_t kNoPosition = static_cast<std::size_t>(-1);
+
+//position of the existing child that token t of path names in v, kNoPosition if there is none
+std::size_t child_position(JsonValue& v, const Path& path, std::size_t t) {
+    if(v.is_object()) {
+        JsonObject& obj = v.as_object();
+        auto it = obj.find(path[t]);
+        if(it != obj.end()) return static_cast<std::size_t>(it - obj.begin());
+    } else if(v.is_array()) {
+        std::optional<std::size_t> index = path.index(t);
+        if(index && *index < v.as_array().size()) return *index;
+    }
+    return kNoPosition;
+}
+
+JsonValue& child_at(JsonValue& v, std::size_t pos) {
+    if(v.is_object()) return (v.as_object().begin() + static_cast<std::ptrdiff_t>(pos))->second;
+    return v.as_array()[pos];
+}
+
+//true if every token of a is the same token of b (a is b or a container above it)
+bool is_prefix(const Path& a, const Path& b) {
+    if(a.size() > b.size()) return false;
+    for(std::size_t t = 0; t < a.size(); ++t) {
+        if(a[t] != b[t]) return false;
+    }
+    return true;
+}
+
+/*
+    what a change did to the document, for DumpCache: 'trail' is the position of every container on
+    the way from the root to the container that changed (root first), 'pos' the child in it.
+        changed  - the child at pos has a new value
+        inserted - a new child at pos, the ones after it moved up by one
+        erased   - the child at pos is gone, the ones after it moved down by one
+    the plain apply_patch / apply_merge_patch report to NoTracking, where all of it compiles away
+*/
+struct NoTracking {
+    void changed(const std::vector<std::size_t>&, std::size_t) noexcept {}
+    void inserted(const std::vector<std::size_t>&, std::size_t) noexcept {}
+    void erased(const std::vector<std::size_t>&, std::size_t) noexcept {}
+    void replaced_root() noexcept {}
+};
+
+template <typename Tracker>
+class Patcher {
+public:
+    Patcher(JsonValue& doc, Tracker& tracker) : doc_(doc), tracker_(tracker) {}
+
+    void apply(const JsonValue& patch) {
+        const JsonArray& operations = patch.as_array();
+        for(op_ = 0; op_ < operations.size(); ++op_) apply_operation(operations[op_]);
+    }
+
+private:
+    JsonValue& doc_;
+    Tracker& tracker_;
+    std::size_t op_ = 0;
+    std::vector<std::size_t> trail_;  //see NoTracking, of the path being changed
+
+    [[noreturn]] void fail(const std::string& msg) const {
+        throw PatchError(msg, op_);
+    }
+
+    const JsonValue& member(const JsonObject& operation, std::string_view name) const {
+        auto it = operation.find(name);
+        if(it == operation.end()) fail("missing \"" + std::string(name) + "\"");
+        return it->second;
+    }
+    Path pointer(const JsonObject& operation, std::string_view name) const {
+        const JsonValue& v = member(operation, name);
+        if(!v.is_string()) fail("\"" + std::string(name) + "\" is not a string");
+        try {
+            return Path(v.as_string());
+        } catch(const ParseError& e) {
+            fail(e.what());
+        }
+    }
+
+    void apply_operation(const JsonValue& operation) {
+        if(!operation.is_object()) fail("not an object");
+        const JsonObject& op = operation.as_object();
+        const JsonValue& name = member(op, "op");
+        std::string_view kind = name.is_string() ? name.as_string() : std::string_view();
+        Path path = pointer(op, "path");
+        if(kind == "add") {
+            add(path, member(op, "value"));
+        } else if(kind == "remove") {
+            (void)take(path);
+        } else if(kind == "replace") {
+            replace(path, member(op, "value"));
+        } else if(kind == "move") {
+            Path from = pointer(op, "from");
+            if(is_prefix(from, path)) {
+                if(from.size() == path.size()) return;  //onto itself
+                fail("cannot move " + from.str() + " into itself");
+            }
+            add(path, take(from));
+        } else if(kind == "copy") {
+            Path from = pointer(op, "from");
+            const JsonValue* v = from.find(std::as_const(doc_));
+            if(!v) fail("no value at " + from.str());
+            add(path, JsonValue(*v));
+        } else if(kind == "test") {
+            const JsonValue* v = path.find(std::as_const(doc_));
+            if(!v) fail("no value at " + path.str());
+            if(!(*v == member(op, "value"))) fail("test failed at " + path.str());
+        } else {
+            fail("unknown op");
+        }
+    }
+
+    //the container the last token of path is in, through the mutable accessors. fills trail_
+    JsonValue& parent(const Path& path) {
+        trail_.clear();
+        JsonValue* v = &doc_;
+        for(std::size_t t = 0; t + 1 < path.size(); ++t) {
+            std::size_t pos = child_position(*v, path, t);
+            if(pos == kNoPosition) fail("no value at " + path.str());
+            trail_.push_back(pos);
+            v = &child_at(*v, pos);
+        }
+        if(!v->is_object() && !v->is_array()) fail("no container for " + path.str());
+        return *v;
+    }
+
+    void add(const Path& path, JsonValue value) {
+        if(path.size() == 0) {
+            doc_ = std::move(value);
+            tracker_.replaced_root();
+            return;
+        }
+        JsonValue& container = parent(path);
+        std::size_t last = path.size() - 1;
+        if(container.is_object()) {
+            JsonObject& obj = container.as_object();
+            auto [it, inserted] = obj.insert_or_assign(path[last], std::move(value));
+            std::size_t pos = static_cast<std::size_t>(it - obj.begin());
+            if(inserted) {
+                tracker_.inserted(trail_, pos);
+            } else {
+                tracker_.changed(trail_, pos);
+            }
+            return;
+        }
+        JsonArray& arr = container.as_array();
+        std::size_t pos = arr.size();
+        if(path[last] != "-") {
+            std::optional<std::size_t> index = path.index(last);
+            if(!index || *index > arr.size()) fail("index out of range at " + path.str());
+            pos = *index;
+        }
+        arr.insert(arr.begin() + static_cast<std::ptrdiff_t>(pos), std::move(value));
+        tracker_.inserted(trail_, pos);
+    }
+
+    //removes the value at path and hands it back (for move)
+    JsonValue take(const Path& path) {
+        if(path.size() == 0) fail("cannot remove the whole document");
+        JsonValue& container = parent(path);
+        std::size_t pos = child_position(container, path, path.size() - 1);
+        if(pos == kNoPosition) fail("no value at " + path.str());
+        JsonValue out = std::move(child_at(container, pos));
+        if(container.is_object()) {
+            JsonObject& obj = container.as_object();
+            obj.erase(obj.begin() + static_cast<std::ptrdiff_t>(pos));
+        } else {
+            JsonArray& arr = container.as_array();
+            arr.erase(arr.begin() + static_cast<std::ptrdiff_t>(pos));
+        }
+        tracker_.erased(trail_, pos);
+        return out;
+    }
+
+    void replace(const Path& path, const JsonValue& value) {
+        if(path.size() == 0) {
+            doc_ = value;
+            tracker_.replaced_root();
+            return;
+        }
+        JsonValue& container = parent(path);
+        std::size_t pos = child_position(container, path, path.size() - 1);
+        if(pos == kNoPosition) fail("no value at " + path.str());
+        child_at(container, pos) = value;
+        tracker_.changed(trail_, pos);
+    }
+};
+
+/*
+    RFC 7386 into target, which sits below the containers in trail. true if target was replaced as a
+    whole (the caller reports that), false if only members of it changed (reported here)
+*/
+template <typename Tracker>
+bool merge(JsonValue& target, const JsonValue& patch, Tracker& tracker, std::vector<std::size_t>& trail) {
+    if(!patch.is_object()) {
+        target = patch;
+        return true;
+    }
+    bool replaced = !target.is_object();
+    if(replaced) target = JsonValue(JsonObject());
+    JsonObject& obj = target.as_object();
+    for(const auto& [key, value] : patch.as_object()) {
+        auto it = obj.find(key.view());
+        std::size_t pos = static_cast<std::size_t>(it - obj.begin());
+        if(value.is_null()) {
+            if(it == obj.end()) continue;
+            obj.erase(it);
+            if(!replaced) tracker.erased(trail, pos);
+        } else if(it == obj.end()) {
+            //a new member gets the patch without its nulls
+            JsonValue added;
+            NoTracking none;
+            merge(added, value, none, trail);
+            auto inserted = obj.insert_or_assign(key.view(), std::move(added)).first;
+            if(!replaced) tracker.inserted(trail, static_cast<std::size_t>(inserted - obj.begin()));
+        } else {
+            trail.push_back(pos);
+            bool whole = merge(it->second, value, tracker, trail);
+            trail.pop_back();
+            if(whole && !replaced) tracker.changed(trail, pos);
+        }
+    }
+    return replaced;
+}
+
+constexpr std::size_t kDirty = static_cast<std::size_t>(-1);
+
+struct Fragment;
+
+//a child's place in its container's Fragment
+struct Slot {
+    std::size_t begin = kDirty;           //its text (with its key, in an object) is text[begin, end), kDirty if it has to be written again
+    std::size_t end = 0;
+    std::unique_ptr<Fragment> fragment;   //a child big enough to keep its own text, spliced in
+};
+
+/*
+    one container's serialization with a Slot per child. text leaves out the children that have a
+    fragment of their own, splices says where each one goes
+*/
+struct Fragment {
+    std::string text;
+    std::vector<std::pair<std::size_t, std::size_t>> splices;  //offset in text, position of the child
+    std::vector<Slot> slots;                                   //by position in the container
+    std::size_t bytes = 0;                                     //the whole serialization, spliced children included
+    bool valid = false;
+};
+
+//a Writer over a std::string (like StringWriter) that knows how much it wrote and can take some back
+class FragmentWriter : public Writer {
+public:
+    explicit FragmentWriter(std::string& out) : out_(out) {
+        //keep whatever room the string already has
+        out_.resize(out_.capacity());
+        set_buffer(out_.data(), out_.data() + out_.size());
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {return static_cast<std::size_t>(cur_ - out_.data());}
+    [[nodiscard]] std::string_view written() const noexcept {return std::string_view(out_.data(), size());}
+    void truncate(std::size_t n) noexcept {cur_ = out_.data() + n;}
+    void finish() {out_.resize(size());}
+
+protected:
+    void overflow(std::size_t needed) override {
+        std::size_t used = size();
+        out_.resize(std::max({out_.size() * 2, used + needed, std::size_t(256)}));
+        set_buffer(out_.data() + used, out_.data() + out_.size());
+    }
+
+private:
+    std::string& out_;
+};
+
+}
+
+void apply_patch(JsonValue& doc, const JsonValue& patch) {
+    NoTracking none;
+    Patcher<NoTracking>(doc, none).apply(patch);
+}
+
+void apply_merge_patch(JsonValue& doc, const JsonValue& patch) {
+    NoTracking none;
+    std::vector<std::size_t> trail;
+    merge(doc, patch, none, trail);
+}
+
+// dump cache ---------------------------------------------------------------
+/*
+    Patcher / merge report every change (see NoTracking) as positions, which is all it takes to keep
+    the fragments in step with the document, without comparing anything:
+    - the fragments down the trail are invalidated. where the trail goes into a child that is written
+      inline, that child's slot is marked dirty and the rest is below it
+    - the changed child's slot is reset, inserts / erases add or drop a slot
+    rebuilding a fragment copies the text of every clean slot from its old text (runs of neighbouring
+    slots in one write), splices in its clean fragments, rebuilds its invalid ones and writes only
+    the dirty children again. a container written from scratch gets its slots on the way, and when it
+    turns out to be fragment_bytes or more its text is cut out into a fragment of its own.
+*/
+struct DumpCache::Impl {
+    Impl(JsonValue d, std::size_t bytes) : doc(std::move(d)), fragment_bytes(std::max<std::size_t>(bytes, 1)), root(std::make_unique<Fragment>()) {}
+
+    JsonValue doc;
+    std::size_t fragment_bytes;
+    std::unique_ptr<Fragment> root;
+    std::string out;       //the last dump()
+    bool current = false;  //out is the document as it is now
+    std::size_t reused = 0;
+    std::size_t serialized = 0;
+    std::vector<std::unique_ptr<Fragment>> scratch;  //by depth, for containers written from scratch
+    std::vector<std::string> spare;                  //old texts during a rebuild, kept for their capacity
+
+    //the Tracker events
+    void changed(const std::vector<std::size_t>& trail, std::size_t pos) noexcept {
+        Fragment* f = invalidate(trail);
+        if(f && pos < f->slots.size()) f->slots[pos] = Slot();
+    }
+    void inserted(const std::vector<std::size_t>& trail, std::size_t pos) {
+        Fragment* f = invalidate(trail);
+        if(f && pos <= f->slots.size()) f->slots.emplace(f->slots.begin() + static_cast<std::ptrdiff_t>(pos));
+    }
+    void erased(const std::vector<std::size_t>& trail, std::size_t pos) noexcept {
+        Fragment* f = invalidate(trail);
+        if(f && pos < f->slots.size()) f->slots.erase(f->slots.begin() + static_cast<std::ptrdiff_t>(pos));
+    }
+    void replaced_root() {
+        root = std::make_unique<Fragment>();
+        current = false;
+    }
+
+    //the fragment of the container at the end of the trail, nullptr if that one is written inline
+    Fragment* invalidate(const std::vector<std::size_t>& trail) noexcept {
+        current = false;
+        Fragment* f = root.get();
+        f->valid = false;
+        for(std::size_t pos : trail) {
+            if(pos >= f->slots.size()) return nullptr;
+            Slot& slot = f->slots[pos];
+            if(!slot.fragment) {
+                slot.begin = kDirty;
+                return nullptr;
+            }
+            f = slot.fragment.get();
+            f->valid = false;
+        }
+        return f;
+    }
+
+    //f in its own text again, reusing what is still clean in the old one
+    void rebuild(Fragment& f, const JsonValue& v, std::size_t depth) {
+        std::string old;
+        if(!spare.empty()) {
+            old = std::move(spare.back());
+            spare.pop_back();
+        }
+        old.swap(f.text);
+        {
+            FragmentWriter w(f.text);
+            if(v.is_array() || v.is_object()) {
+                write_container(f, v, w, &old, depth);
+            } else {
+                f.slots.clear();
+                f.splices.clear();
+                v.dump_to(w);
+                f.bytes = w.size();
+            }
+            w.finish();
+        }
+        old.clear();
+        spare.push_back(std::move(old));
+        f.valid = true;
+    }
+
+    //a run of clean slots that were next to each other in the old text, copied in one go
+    struct Run {
+        std::size_t begin = kDirty;  //in the old text
+        std::size_t end = 0;
+        std::size_t first = 0;       //the slots in it
+        std::size_t last = 0;
+    };
+
+    /*
+        v at the end of w, with f's offsets relative to where it starts (where f's own text starts
+        once it is cut out). old is f's previous text, nullptr when it is written from scratch
+    */
+    void write_container(Fragment& f, const JsonValue& v, FragmentWriter& w, const std::string* old, std::size_t depth) {
+        const std::size_t base = w.size();
+        const std::size_t n = v.size();
+        if(!old || f.slots.size() != n) {
+            f.slots.clear();
+            f.slots.resize(n);
+        }
+        f.splices.clear();
+        std::size_t spliced = 0;
+        Run run;
+        auto flush = [&] {
+            if(run.begin == kDirty) return;
+            std::size_t to = w.size() - base;
+            w.write(std::string_view(*old).substr(run.begin, run.end - run.begin));
+            reused += run.end - run.begin;
+            for(std::size_t k = run.first; k <= run.last; ++k) {
+                f.slots[k].begin = f.slots[k].begin - run.begin + to;
+                f.slots[k].end = f.slots[k].end - run.begin + to;
+            }
+            run.begin = kDirty;
+        };
+        auto child = [&](std::size_t i, const JsonKey* key, const JsonValue& value) {
+            Slot& slot = f.slots[i];
+            if(old && !slot.fragment && slot.begin != kDirty) {
+                if(run.begin != kDirty && slot.begin == run.end + 1) {
+                    //the ',' between the two is copied along
+                    run.end = slot.end;
+                    run.last = i;
+                    return;
+                }
+                flush();
+                if(i) w.put(',');
+                run = Run{slot.begin, slot.end, i, i};
+                return;
+            }
+            flush();
+            if(i) w.put(',');
+            std::size_t begin = w.size();
+            if(key) {
+                detail::write_escaped(w, key->view());
+                w.put(':');
+            }
+            if(slot.fragment) {
+                if(slot.fragment->valid) {
+                    reused += slot.fragment->bytes;
+                } else {
+                    rebuild(*slot.fragment, value, depth + 1);
+                }
+                f.splices.emplace_back(w.size() - base, i);
+                spliced += slot.fragment->bytes;
+                return;
+            }
+            if(value.is_array() || value.is_object()) {
+                if(scratch.size() <= depth + 1) scratch.resize(depth + 2);
+                if(!scratch[depth + 1]) scratch[depth + 1] = std::make_unique<Fragment>();
+                Fragment& fresh = *scratch[depth + 1];
+                std::size_t start = w.size();
+                write_container(fresh, value, w, nullptr, depth + 1);
+                if(fresh.bytes >= fragment_bytes) {
+                    auto cut = std::make_unique<Fragment>();
+                    cut->text.assign(w.written().substr(start));
+                    cut->slots = std::move(fresh.slots);
+                    cut->splices = std::move(fresh.splices);
+                    cut->bytes = fresh.bytes;
+                    cut->valid = true;
+                    w.truncate(start);
+                    f.splices.emplace_back(start - base, i);
+                    spliced += cut->bytes;
+                    slot.fragment = std::move(cut);
+                    return;
+                }
+            } else {
+                value.dump_to(w);
+            }
+            slot.begin = begin - base;
+            slot.end = w.size() - base;
+        };
+        if(v.is_array()) {
+            const JsonArray& arr = v.as_array();
+            w.put('[');
+            for(std::size_t i = 0; i < n; ++i) child(i, nullptr, arr[i]);
+            flush();
+            w.put(']');
+        } else {
+            const JsonObject& obj = v.as_object();
+            w.put('{');
+            std::size_t i = 0;
+            for(const auto& [key, value] : obj) child(i++, &key, value);
+            flush();
+            w.put('}');
+        }
+        f.bytes = w.size() - base + spliced;
+    }
+
+    void emit(const Fragment& f) {
+        std::size_t from = 0;
+        for(auto [at, i] : f.splices) {
+            out.append(f.text, from, at - from);
+            emit(*f.slots[i].fragment);
+            from = at;
+        }
+        out.append(f.text, from, std::string::npos);
+    }
+};
+
+DumpCache::DumpCache(JsonValue doc, std::size_t fragment_bytes) : impl_(std::make_unique<Impl>(std::move(doc), fragment_bytes)) {}
+DumpCache::~DumpCache() = default;
+DumpCache::DumpCache(DumpCache&&) noexcept = default;
+DumpCache& DumpCache::operator=(DumpCache&&) noexcept = default;
+
+const JsonValue& DumpCache::value() const noexcept {
+    return impl_->doc;
+}
+
+void DumpCache::apply_patch(const JsonValue& patch) {
+    Patcher<Impl>(impl_->doc, *impl_).apply(patch);
+}
+
+void DumpCache::apply_merge_patch(const JsonValue& patch) {
+    std::vector<std::size_t> trail;
+    if(merge(impl_->doc, patch, *impl_, trail)) impl_->replaced_root();
+}
+
+JsonValue& DumpCache::edit(std::string_view pointer) {
+    Path path(pointer);
+    if(path.size() == 0) {
+        impl_->replaced_root();
+        return impl_->doc;
+    }
+    std::vector<std::size_t> trail;
+    JsonValue* v = &impl_->doc;
+    for(std::size_t t = 0; t < path.size(); ++t) {
+        std::size_t pos = child_position(*v, path, t);
+        if(pos == kNoPosition) throw std::out_of_range("no value at " + std::string(pointer));
+        trail.push_back(pos);
+        v = &child_at(*v, pos);
+    }
+    std::size_t pos = trail.back();
+    trail.pop_back();
+    impl_->changed(trail, pos);
+    return *v;
+}
+
+const std::string& DumpCache::dump() {
+    Impl& d = *impl_;
+    d.serialized = 0;
+    if(d.current) return d.out;
+    d.reused = 0;
+    if(!d.root->valid) d.rebuild(*d.root, d.doc, 0);
+    d.out.clear();
+    d.out.reserve(d.root->bytes);
+    d.emit(*d.root);
+    d.serialized = d.root->bytes - d.reused;
+    d.current = true;
+    return d.out;
+}
+
+std::size_t DumpCache::serialized_bytes() const noexcept {
+    return impl_->serialized;
+}
+
+}
@@ -0,0 +1,103 @@
+#include "json_parser/path.hpp"
+#include <functional>
+#include <limits>
+
+namespace json {
+
+namespace {
+
+//RFC 6901 array-index: "0" or digits without a leading zero. anything else (and overflow) is kNoIndex
+std::size_t array_index(std::string_view token, std::size_t no_index) {
+    if(token.empty() || (token[0] == '0' && token.size() > 1)) return no_index;
+    std::size_t index = 0;
+    for(char c : token) {
+        if(c < '0' || c > '9') return no_index;
+        std::size_t digit = static_cast<std::size_t>(c - '0');
+        if(index > (std::numeric_limits<std::size_t>::max() - digit) / 10) return no_index;
+        index = index * 10 + digit;
+    }
+    return index;
+}
+
+}
+
+Path::Path(std::string_view pointer) : pointer_(pointer) {
+    if(pointer.empty()) return;
+    if(pointer[0] != '/') {
+        throw ParseError("JSON pointer must start with '/'", 0);
+    }
+    std::size_t pos = 1;
+    while(true) {
+        Token token;
+        for(; pos < pointer.size() && pointer[pos] != '/'; ++pos) {
+            char c = pointer[pos];
+            if(c == '~') {
+                char next = pos + 1 < pointer.size() ? pointer[pos + 1] : '\0';
+                if(next != '0' && next != '1') {
+                    throw ParseError("invalid escape in JSON pointer", pos);
+                }
+                c = next == '0' ? '~' : '/';
+                ++pos;
+            }
+            token.key.push_back(c);
+        }
+        token.hash = std::hash<std::string_view>{}(token.key);
+        token.index = array_index(token.key, kNoIndex);
+        tokens_.push_back(std::move(token));
+        if(pos == pointer.size()) break;
+        ++pos;  //the '/'
+    }
+}
+
+const JsonValue* Path::find(const JsonValue& root) const noexcept {
+    const JsonValue* v = &root;
+    for(const Token& token : tokens_) {
+        if(v->is_object()) {
+            const JsonObject& obj = v->as_object();
+            auto it = obj.find(token.key, token.hash);
+            if(it == obj.end()) return nullptr;
+            v = &it->second;
+        } else if(v->is_array()) {
+            const JsonArray& arr = v->as_array();
+            if(token.index >= arr.size()) return nullptr;
+            v = &arr[token.index];
+        } else {
+            return nullptr;
+        }
+    }
+    return v;
+}
+
+//same walk through the mutable accessors, they are where shared values get copied on write
+JsonValue* Path::find(JsonValue& root) const {
+    JsonValue* v = &root;
+    for(const Token& token : tokens_) {
+        if(v->is_object()) {
+            JsonObject& obj = v->as_object();
+            auto it = obj.find(token.key, token.hash);
+            if(it == obj.end()) return nullptr;
+            v = &it->second;
+        } else if(v->is_array()) {
+            JsonArray& arr = v->as_array();
+            if(token.index >= arr.size()) return nullptr;
+            v = &arr[token.index];
+        } else {
+            return nullptr;
+        }
+    }
+    return v;
+}
+
+std::optional<LazyValue> Path::find(const LazyValue& root) const {
+    std::optional<LazyValue> v = root;
+    for(const Token& token : tokens_) {
+        //LazyValue::find gives nullopt for the wrong container type, so try the one the token can be
+        std::optional<LazyValue> next = v->find(std::string_view(token.key));
+        if(!next && token.index != kNoIndex) next = v->find(token.index);
+        if(!next) return std::nullopt;
+        v = std::move(next);
+    }
+    return v;
+}
+
+}
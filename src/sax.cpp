@@ -0,0 +1,21 @@
+#include "json_parser/sax.hpp"
+#include "parser.hpp"
+#include "structural_index.hpp"
+
+namespace json {
+
+//SaxHandler is just another Handler for the shared parser, the virtual calls are the only difference to dom parse
+bool parse_sax(std::string_view json, SaxHandler& handler) {
+    detail::Parser<SaxHandler> parser(json, handler);
+    return parser.parse();
+}
+
+bool parse_sax(std::string_view json, SaxHandler& handler, const ParseOptions& options) {
+    if(options.engine == ParseEngine::StructuralIndex && json.size() <= UINT32_MAX) {
+        return detail::parse_indexed(json, handler, options.max_depth);
+    }
+    detail::Parser<SaxHandler> parser(json, handler, options.max_depth);
+    return parser.parse();
+}
+
+}
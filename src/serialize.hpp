@@ -0,0 +1,14 @@
+#ifndef JSON_SERIALIZE_HPP
+#define JSON_SERIALIZE_HPP
+
+#include "json_parser/writer.hpp"
+#include <string_view>
+
+namespace json::detail {
+
+//s as a quoted json string, escaped the way dump() writes strings and keys (json.cpp)
+void write_escaped(Writer& out, std::string_view s);
+
+}
+
+#endif
@@ -0,0 +1,491 @@
+#include "simd.hpp"
+#include <cstdint>
+#include <cstring>
+
+#if !defined(JSON_PARSER_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+    #define JSON_SIMD_X86 1
+    #include <immintrin.h>
+#elif !defined(JSON_PARSER_NO_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+    #define JSON_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace json::simd {
+
+namespace {
+
+/*
+    notes on the kernels:
+    - each block compares every byte against the interesting characters, ORs the results together
+      and turns the byte mask into a bit mask (movemask). the first set bit is the answer.
+    - whitespace: we look for the first byte that is NOT whitespace, so the mask is inverted.
+    - the avx2 kernels clear the upper ymm halves before handing the tail to the (legacy encoded) sse2
+      kernel. gcc does not do it for that call, and the avx -> sse transition then cost ~150ns per
+      call on short strings - more than the whole scan.
+    - escape chars: sse2 has no unsigned byte compare, but max(v, 0x1F) == 0x1F is exactly v <= 0x1F.
+    - whatever is left after the last full block (< 16/32 bytes) goes through the scalar loop.
+    - most whitespace runs in compact json are 0-1 bytes, the parser checks the first byte
+      itself before calling in here, so the kernels are tuned for the longer (pretty printed) runs.
+    - utf-8: a block without a high bit set is ascii and valid as it is, that is the whole simd part.
+      at the first byte that is not ascii one sequence is checked byte by byte (utf8_sequence), then
+      the block scan goes on right after it. mostly ascii json (keys, numbers, english text) runs at
+      block speed; text that is mostly multi byte characters goes at the speed of the scalar check.
+*/
+
+std::size_t scalar_skip_whitespace(const char* p, std::size_t n) noexcept {
+    std::size_t i = 0;
+    while(i < n && is_whitespace(p[i])) ++i;
+    return i;
+}
+
+std::size_t scalar_find_quote_or_escape(const char* p, std::size_t n) noexcept {
+    std::size_t i = 0;
+    while(i < n && p[i] != '"' && p[i] != '\\') ++i;
+    return i;
+}
+
+inline bool needs_escape(char c) noexcept {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+std::size_t scalar_find_escape_char(const char* p, std::size_t n) noexcept {
+    std::size_t i = 0;
+    while(i < n && !needs_escape(p[i])) ++i;
+    return i;
+}
+
+/*
+    length (2-4) of the utf-8 sequence whose lead byte (>= 0x80) is at s[0], 0 if it is not a valid one.
+    valid is RFC 3629: no overlong forms, no surrogates (U+D800-DFFF), nothing past U+10FFFF,
+    and no sequence cut off by the end of the input.
+*/
+inline std::size_t utf8_sequence(const unsigned char* s, std::size_t n) noexcept {
+    auto cont = [&](std::size_t i) {return i < n && (s[i] & 0xC0) == 0x80;};
+    unsigned char c = s[0];
+    if(c >= 0xC2 && c <= 0xDF) return cont(1) ? 2 : 0;
+    if(n < 2) return 0;
+    unsigned char c1 = s[1];
+    if(c >= 0xE0 && c <= 0xEF) {
+        if(c == 0xE0 && c1 < 0xA0) return 0;  //overlong
+        if(c == 0xED && c1 > 0x9F) return 0;  //surrogate
+        return cont(1) && cont(2) ? 3 : 0;
+    }
+    if(c >= 0xF0 && c <= 0xF4) {
+        if(c == 0xF0 && c1 < 0x90) return 0;  //overlong
+        if(c == 0xF4 && c1 > 0x8F) return 0;  //past U+10FFFF
+        return cont(1) && cont(2) && cont(3) ? 4 : 0;
+    }
+    return 0;  //a continuation byte without a lead, C0 / C1 (always overlong) or F5-FF
+}
+
+std::size_t scalar_find_invalid_utf8(const char* p, std::size_t n) noexcept {
+    const auto* s = reinterpret_cast<const unsigned char*>(p);
+    std::size_t i = 0;
+    while(i < n) {
+        //8 ascii bytes at a time
+        if(i + 8 <= n) {
+            std::uint64_t word;
+            std::memcpy(&word, s + i, 8);
+            if((word & 0x8080808080808080u) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        if(s[i] < 0x80) {
+            ++i;
+            continue;
+        }
+        std::size_t len = utf8_sequence(s + i, n - i);
+        if(len == 0) return i;
+        i += len;
+    }
+    return n;
+}
+
+//only selected without simd, but kept compiled everywhere so it cannot rot
+[[maybe_unused]] void scalar_classify_block(const char* p, BlockMasks& out) noexcept {
+    out = BlockMasks{0, 0, 0, 0};
+    for(int i = 0; i < 64; ++i) {
+        std::uint64_t bit = std::uint64_t{1} << i;
+        switch(p[i]) {
+            case '"': out.quote |= bit; break;
+            case '\\': out.backslash |= bit; break;
+            case ' ': case '\t': case '\n': case '\r': out.whitespace |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': out.op |= bit; break;
+            default: break;
+        }
+    }
+}
+
+#if defined(JSON_SIMD_X86)
+
+std::size_t sse2_skip_whitespace(const char* p, std::size_t n) noexcept {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage = _mm_set1_epi8('\r');
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, newline), _mm_cmpeq_epi8(v, carriage)));
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xFFFFu;
+        if(mask) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    return i + scalar_skip_whitespace(p + i, n - i);
+}
+
+std::size_t sse2_find_quote_or_escape(const char* p, std::size_t n) noexcept {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if(mask) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    return i + scalar_find_quote_or_escape(p + i, n - i);
+}
+
+std::size_t sse2_find_escape_char(const char* p, std::size_t n) noexcept {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if(mask) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    return i + scalar_find_escape_char(p + i, n - i);
+}
+
+std::size_t sse2_find_invalid_utf8(const char* p, std::size_t n) noexcept {
+    const auto* s = reinterpret_cast<const unsigned char*>(p);
+    std::size_t i = 0;
+    while(i + 16 <= n) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(v));  //the high bit of every byte
+        if(mask == 0) {
+            i += 16;
+            continue;
+        }
+        i += static_cast<std::size_t>(__builtin_ctz(mask));
+        std::size_t len = utf8_sequence(s + i, n - i);
+        if(len == 0) return i;
+        i += len;
+    }
+    return i + scalar_find_invalid_utf8(p + i, n - i);
+}
+
+/*
+    brackets: '[' | 0x20 == '{' and ']' | 0x20 == '}', and no other byte maps onto those two, so one
+    OR + two compares find all four. ':' and ',' need their own compares (0x1A | 0x20 == ':').
+*/
+void sse2_classify_block(const char* p, BlockMasks& out) noexcept {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage = _mm_set1_epi8('\r');
+    const __m128i lower = _mm_set1_epi8(0x20);
+    const __m128i open_brace = _mm_set1_epi8('{');
+    const __m128i close_brace = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    out = BlockMasks{0, 0, 0, 0};
+    for(int i = 0; i < 4; ++i) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+        __m128i folded = _mm_or_si128(v, lower);
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, newline), _mm_cmpeq_epi8(v, carriage)));
+        __m128i op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, open_brace), _mm_cmpeq_epi8(folded, close_brace)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+        int shift = 16 * i;
+        out.quote |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << shift;
+        out.backslash |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)))) << shift;
+        out.whitespace |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(ws))) << shift;
+        out.op |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(op))) << shift;
+    }
+}
+
+__attribute__((target("avx2")))
+std::size_t avx2_skip_whitespace(const char* p, std::size_t n) noexcept {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriage = _mm256_set1_epi8('\r');
+    std::size_t i = 0;
+    for(; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, newline), _mm256_cmpeq_epi8(v, carriage)));
+        std::uint32_t mask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(ws));
+        if(mask) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    _mm256_zeroupper();
+    return i + sse2_skip_whitespace(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+std::size_t avx2_find_quote_or_escape(const char* p, std::size_t n) noexcept {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    std::size_t i = 0;
+    for(; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash));
+        std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(hit));
+        if(mask) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    _mm256_zeroupper();
+    return i + sse2_find_quote_or_escape(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+std::size_t avx2_find_escape_char(const char* p, std::size_t n) noexcept {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(0x1F);
+    std::size_t i = 0;
+    for(; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+            _mm256_cmpeq_epi8(_mm256_max_epu8(v, control), control));
+        std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(hit));
+        if(mask) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    _mm256_zeroupper();
+    return i + sse2_find_escape_char(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+std::size_t avx2_find_invalid_utf8(const char* p, std::size_t n) noexcept {
+    const auto* s = reinterpret_cast<const unsigned char*>(p);
+    std::size_t i = 0;
+    while(i + 32 <= n) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+        if(mask == 0) {
+            i += 32;
+            continue;
+        }
+        i += static_cast<std::size_t>(__builtin_ctz(mask));
+        std::size_t len = utf8_sequence(s + i, n - i);
+        if(len == 0) {
+            _mm256_zeroupper();
+            return i;
+        }
+        i += len;
+    }
+    _mm256_zeroupper();
+    return i + sse2_find_invalid_utf8(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+void avx2_classify_block(const char* p, BlockMasks& out) noexcept {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriage = _mm256_set1_epi8('\r');
+    const __m256i lower = _mm256_set1_epi8(0x20);
+    const __m256i open_brace = _mm256_set1_epi8('{');
+    const __m256i close_brace = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+    out = BlockMasks{0, 0, 0, 0};
+    for(int i = 0; i < 2; ++i) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * i));
+        __m256i folded = _mm256_or_si256(v, lower);
+        __m256i ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, newline), _mm256_cmpeq_epi8(v, carriage)));
+        __m256i op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, open_brace), _mm256_cmpeq_epi8(folded, close_brace)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma)));
+        int shift = 32 * i;
+        out.quote |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << shift;
+        out.backslash |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslash)))) << shift;
+        out.whitespace |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(ws))) << shift;
+        out.op |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(op))) << shift;
+    }
+}
+
+#elif defined(JSON_SIMD_NEON)
+
+// neon has no movemask. narrowing each 16 bit lane by 4 packs the byte mask into 4 bits per byte
+inline std::uint64_t neon_nibble_mask(uint8x16_t bytes) noexcept {
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(bytes), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+}
+
+std::size_t neon_skip_whitespace(const char* p, std::size_t n) noexcept {
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    const uint8x16_t carriage = vdupq_n_u8('\r');
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(p + i));
+        uint8x16_t ws = vorrq_u8(
+            vorrq_u8(vceqq_u8(v, space), vceqq_u8(v, tab)),
+            vorrq_u8(vceqq_u8(v, newline), vceqq_u8(v, carriage)));
+        std::uint64_t mask = neon_nibble_mask(vmvnq_u8(ws));
+        if(mask) return i + static_cast<std::size_t>(__builtin_ctzll(mask) >> 2);
+    }
+    return i + scalar_skip_whitespace(p + i, n - i);
+}
+
+std::size_t neon_find_quote_or_escape(const char* p, std::size_t n) noexcept {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(p + i));
+        uint8x16_t hit = vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash));
+        std::uint64_t mask = neon_nibble_mask(hit);
+        if(mask) return i + static_cast<std::size_t>(__builtin_ctzll(mask) >> 2);
+    }
+    return i + scalar_find_quote_or_escape(p + i, n - i);
+}
+
+std::size_t neon_find_escape_char(const char* p, std::size_t n) noexcept {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t control = vdupq_n_u8(0x20);
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(p + i));
+        uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcltq_u8(v, control));
+        std::uint64_t mask = neon_nibble_mask(hit);
+        if(mask) return i + static_cast<std::size_t>(__builtin_ctzll(mask) >> 2);
+    }
+    return i + scalar_find_escape_char(p + i, n - i);
+}
+
+std::size_t neon_find_invalid_utf8(const char* p, std::size_t n) noexcept {
+    const auto* s = reinterpret_cast<const unsigned char*>(p);
+    const uint8x16_t high = vdupq_n_u8(0x80);
+    std::size_t i = 0;
+    while(i + 16 <= n) {
+        uint8x16_t v = vld1q_u8(s + i);
+        std::uint64_t mask = neon_nibble_mask(vcgeq_u8(v, high));
+        if(mask == 0) {
+            i += 16;
+            continue;
+        }
+        i += static_cast<std::size_t>(__builtin_ctzll(mask) >> 2);
+        std::size_t len = utf8_sequence(s + i, n - i);
+        if(len == 0) return i;
+        i += len;
+    }
+    return i + scalar_find_invalid_utf8(p + i, n - i);
+}
+
+// 16 compare results (0x00 / 0xFF) to 16 bits: weight each lane by its bit and add up each half
+inline std::uint64_t neon_movemask(uint8x16_t bytes) noexcept {
+    static const std::uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t weighted = vandq_u8(bytes, vld1q_u8(weights));
+    return static_cast<std::uint64_t>(vaddv_u8(vget_low_u8(weighted))) |
+           (static_cast<std::uint64_t>(vaddv_u8(vget_high_u8(weighted))) << 8);
+}
+
+void neon_classify_block(const char* p, BlockMasks& out) noexcept {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    const uint8x16_t carriage = vdupq_n_u8('\r');
+    const uint8x16_t lower = vdupq_n_u8(0x20);
+    const uint8x16_t open_brace = vdupq_n_u8('{');
+    const uint8x16_t close_brace = vdupq_n_u8('}');
+    const uint8x16_t colon = vdupq_n_u8(':');
+    const uint8x16_t comma = vdupq_n_u8(',');
+    out = BlockMasks{0, 0, 0, 0};
+    for(int i = 0; i < 4; ++i) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(p + 16 * i));
+        uint8x16_t folded = vorrq_u8(v, lower);
+        uint8x16_t ws = vorrq_u8(
+            vorrq_u8(vceqq_u8(v, space), vceqq_u8(v, tab)),
+            vorrq_u8(vceqq_u8(v, newline), vceqq_u8(v, carriage)));
+        uint8x16_t op = vorrq_u8(
+            vorrq_u8(vceqq_u8(folded, open_brace), vceqq_u8(folded, close_brace)),
+            vorrq_u8(vceqq_u8(v, colon), vceqq_u8(v, comma)));
+        int shift = 16 * i;
+        out.quote |= neon_movemask(vceqq_u8(v, quote)) << shift;
+        out.backslash |= neon_movemask(vceqq_u8(v, backslash)) << shift;
+        out.whitespace |= neon_movemask(ws) << shift;
+        out.op |= neon_movemask(op) << shift;
+    }
+}
+
+#endif
+
+struct Kernels {
+    std::size_t (*skip_whitespace)(const char*, std::size_t) noexcept;
+    std::size_t (*find_quote_or_escape)(const char*, std::size_t) noexcept;
+    std::size_t (*find_escape_char)(const char*, std::size_t) noexcept;
+    std::size_t (*find_invalid_utf8)(const char*, std::size_t) noexcept;
+    void (*classify_block)(const char*, BlockMasks&) noexcept;
+    const char* name;
+};
+
+Kernels select_kernels() noexcept {
+#if defined(JSON_SIMD_X86)
+    if(__builtin_cpu_supports("avx2")) {
+        return {avx2_skip_whitespace, avx2_find_quote_or_escape, avx2_find_escape_char, avx2_find_invalid_utf8, avx2_classify_block, "avx2"};
+    }
+    return {sse2_skip_whitespace, sse2_find_quote_or_escape, sse2_find_escape_char, sse2_find_invalid_utf8, sse2_classify_block, "sse2"};
+#elif defined(JSON_SIMD_NEON)
+    return {neon_skip_whitespace, neon_find_quote_or_escape, neon_find_escape_char, neon_find_invalid_utf8, neon_classify_block, "neon"};
+#else
+    return {scalar_skip_whitespace, scalar_find_quote_or_escape, scalar_find_escape_char, scalar_find_invalid_utf8, scalar_classify_block, "scalar"};
+#endif
+}
+
+//function local static so the cpu check runs once, and safely even if someone parses during static init
+const Kernels& kernels() noexcept {
+    static const Kernels k = select_kernels();
+    return k;
+}
+
+}
+
+std::size_t skip_whitespace(const char* p, std::size_t n) noexcept {
+    return kernels().skip_whitespace(p, n);
+}
+
+std::size_t find_quote_or_escape(const char* p, std::size_t n) noexcept {
+    return kernels().find_quote_or_escape(p, n);
+}
+
+std::size_t find_escape_char(const char* p, std::size_t n) noexcept {
+    return kernels().find_escape_char(p, n);
+}
+
+std::size_t find_invalid_utf8(const char* p, std::size_t n) noexcept {
+    return kernels().find_invalid_utf8(p, n);
+}
+
+void classify_block(const char* p, BlockMasks& out) noexcept {
+    kernels().classify_block(p, out);
+}
+
+const char* active_isa() noexcept {
+    return kernels().name;
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef JSON_SIMD_HPP
+#define JSON_SIMD_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    internal scanning kernels used by the parser (not part of the public API).
+
+    every kernel has a scalar version plus SSE2 / AVX2 (x86-64) and NEON (aarch64) versions.
+    the best one the cpu supports is picked once, the first time a kernel is called.
+    building with -DJSON_PARSER_SIMD=OFF forces the scalar versions everywhere.
+
+    kernels never read outside [p, p+n) - the parser hands us views into caller memory,
+    so there is no padding past the end we could safely over-read into.
+*/
+namespace json::simd {
+
+// json whitespace is exactly ' ', '\t', '\n', '\r' (std::isspace also accepts '\v' and '\f')
+inline bool is_whitespace(char c) noexcept {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// index of the first byte in [p, p+n) that is not json whitespace, or n if there is none
+std::size_t skip_whitespace(const char* p, std::size_t n) noexcept;
+
+// index of the first '"' or '\\' in [p, p+n), or n if there is none
+std::size_t find_quote_or_escape(const char* p, std::size_t n) noexcept;
+
+// index of the first byte in [p, p+n) that has to be escaped in json output ('"', '\\' or < 0x20), or n
+std::size_t find_escape_char(const char* p, std::size_t n) noexcept;
+
+// index of the first byte in [p, p+n) that does not start a valid utf-8 sequence (RFC 3629), or n
+std::size_t find_invalid_utf8(const char* p, std::size_t n) noexcept;
+
+/*
+    one bit per byte of a 64 byte block (bit i = byte i), for the structural index (structural_index.cpp).
+    op is the six structural characters {}[]:, - strings and the rest are worked out from these.
+*/
+struct BlockMasks {
+    std::uint64_t quote;
+    std::uint64_t backslash;
+    std::uint64_t whitespace;
+    std::uint64_t op;
+};
+
+// classify the 64 bytes at p (all 64 must be readable)
+void classify_block(const char* p, BlockMasks& out) noexcept;
+
+// name of the kernel set in use: "avx2", "sse2", "neon" or "scalar"
+const char* active_isa() noexcept;
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include "structural_index.hpp"
+#include "simd.hpp"
+#include <cstring>
+
+namespace json::detail {
+
+namespace {
+
+/*
+    notes on stage 1 (the bit tricks are the ones from simdjson, "Parsing Gigabytes of JSON per Second"):
+    - simd::classify_block gives one bit per byte for '"', '\\', whitespace and {}[]:, in a 64 byte block.
+      everything after that is plain 64 bit integer arithmetic, so it is the same on every cpu.
+    - escaped: a byte is escaped if it follows an odd length run of backslashes. runs are found with
+      one subtraction (the borrow ripples through a run) instead of a loop over the backslashes.
+    - in_string: prefix xor of the unescaped quotes - 1 from an opening quote up to (not including)
+      the closing one. a carry-less multiply by all ones computes the same, the shift ladder below is
+      6 shifts + 6 xors and needs no pclmul / pmull.
+    - scalars: any byte outside a string that is neither whitespace nor structural. only the first
+      byte of each run is a token start.
+    - all three (escape, string, scalar) carry one bit of state into the next block.
+    - the last partial block is copied into a buffer padded with spaces, so the kernels always have
+      64 readable bytes and the padding never shows up as a token.
+*/
+constexpr std::uint64_t kOddBits = 0xAAAAAAAAAAAAAAAAULL;
+
+inline std::uint64_t prefix_xor(std::uint64_t x) noexcept {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+struct BlockScanner {
+    std::uint64_t next_is_escaped = 0;  //last byte of the previous block was an escaping backslash
+    std::uint64_t in_string = 0;        //all ones if the previous block ended inside a string
+    std::uint64_t prev_scalar = 0;      //last byte of the previous block was part of a scalar
+
+    std::uint64_t escaped(std::uint64_t backslash) noexcept {
+        if(!backslash) {
+            std::uint64_t result = next_is_escaped;
+            next_is_escaped = 0;
+            return result;
+        }
+        //a backslash that is itself escaped starts nothing
+        std::uint64_t potential_escape = backslash & ~next_is_escaped;
+        std::uint64_t maybe_escaped = potential_escape << 1;
+        //subtracting the run start from the odd bits flips the parity bit at the end of every odd run
+        std::uint64_t escape_and_terminal = ((maybe_escaped | kOddBits) - potential_escape) ^ kOddBits;
+        std::uint64_t result = escape_and_terminal ^ (backslash | next_is_escaped);
+        next_is_escaped = (escape_and_terminal & backslash) >> 63;
+        return result;
+    }
+
+    //bytes that are not part of a string. 'inside' covers the opening quote and the body, 'quotes' adds the closing one
+    std::uint64_t outside_strings(const simd::BlockMasks& m, std::uint64_t& quotes, std::uint64_t& inside) noexcept {
+        quotes = m.quote & ~escaped(m.backslash);
+        inside = prefix_xor(quotes) ^ in_string;
+        in_string = static_cast<std::uint64_t>(static_cast<std::int64_t>(inside) >> 63);
+        return ~(inside | quotes);
+    }
+
+    //token starts of one block
+    std::uint64_t structurals(const simd::BlockMasks& m) noexcept {
+        std::uint64_t quotes;
+        std::uint64_t inside;
+        std::uint64_t outside = outside_strings(m, quotes, inside);
+        std::uint64_t scalar = outside & ~(m.op | m.whitespace);
+        std::uint64_t scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+        prev_scalar = scalar >> 63;
+
+        std::uint64_t opening_quotes = quotes & inside;
+        return (m.op & outside) | opening_quotes | scalar_start;
+    }
+};
+
+}
+
+void build_structural_index(std::string_view input, std::vector<std::uint32_t>& index) {
+    index.clear();
+    //grown on demand: one token per 8 input bytes is typical, one per byte is the worst case
+    index.resize(input.size() / 8 + 64);
+    std::size_t count = 0;
+    BlockScanner scanner;
+    char tail[64];
+    for(std::size_t base = 0; base < input.size(); base += 64) {
+        const char* block = input.data() + base;
+        if(input.size() - base < 64) {
+            std::memset(tail, ' ', sizeof tail);
+            std::memcpy(tail, block, input.size() - base);
+            block = tail;
+        }
+        simd::BlockMasks masks;
+        simd::classify_block(block, masks);
+        std::uint64_t bits = scanner.structurals(masks);
+
+        if(index.size() < count + 64) index.resize(index.size() * 2 + 64);
+        std::uint32_t* out = index.data() + count;
+        auto offset = static_cast<std::uint32_t>(base);
+        while(bits) {
+            *out++ = offset + static_cast<std::uint32_t>(__builtin_ctzll(bits));
+            bits &= bits - 1;
+        }
+        count = static_cast<std::size_t>(out - index.data());
+    }
+    index.resize(count);
+}
+
+/*
+    the pre-scan only looks at {}[]:, outside strings (no scalar / quote bookkeeping). junk before the
+    root or after it is caught by the whitespace checks at both ends, junk between two elements by the
+    parse of the elements themselves.
+*/
+bool split_top_level_array(std::string_view input, std::vector<std::size_t>& separators) {
+    separators.clear();
+    std::size_t first = simd::skip_whitespace(input.data(), input.size());
+    if(first == input.size() || input[first] != '[') return false;
+    BlockScanner scanner;
+    std::size_t depth = 0;
+    char tail[64];
+    for(std::size_t base = 0; base < input.size(); base += 64) {
+        const char* block = input.data() + base;
+        if(input.size() - base < 64) {
+            std::memset(tail, ' ', sizeof tail);
+            std::memcpy(tail, block, input.size() - base);
+            block = tail;
+        }
+        simd::BlockMasks masks;
+        simd::classify_block(block, masks);
+        std::uint64_t quotes;
+        std::uint64_t inside;
+        std::uint64_t bits = masks.op & scanner.outside_strings(masks, quotes, inside);
+        while(bits) {
+            std::size_t pos = base + static_cast<std::size_t>(__builtin_ctzll(bits));
+            bits &= bits - 1;
+            switch(input[pos]) {
+                case '[': case '{':
+                    if(depth++ == 0) separators.push_back(pos);
+                    break;
+                case ']': case '}':
+                    if(--depth == 0) {
+                        separators.push_back(pos);
+                        //the root must close with ']' and only whitespace may follow it
+                        std::size_t rest = pos + 1;
+                        return input[pos] == ']' &&
+                               rest + simd::skip_whitespace(input.data() + rest, input.size() - rest) == input.size();
+                    }
+                    break;
+                case ',':
+                    if(depth == 1) separators.push_back(pos);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,208 @@
+#ifndef JSON_STRUCTURAL_INDEX_HPP
+#define JSON_STRUCTURAL_INDEX_HPP
+
+#include "parser.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace json::detail {
+
+/*
+    stage 1 of the StructuralIndex engine: the offset of every token start in the input, in order.
+    a token start is one of {}[]:, outside a string, the opening quote of a string, or the first
+    byte of a scalar (number / literal / garbage). nothing inside a string is recorded.
+    offsets are 32 bit - callers fall back to the byte at a time Parser for inputs of 4GB and up.
+*/
+void build_structural_index(std::string_view input, std::vector<std::uint32_t>& index);
+
+/*
+    pre-scan for the parallel parse, with the same block scanner as stage 1 but without storing the index:
+    if the input is one top-level array, 'separators' gets the offset of its '[', of every comma
+    between two of its elements and of its ']', so element i lies between separators[i] and
+    separators[i + 1]. false if the root is not an array or the brackets do not balance.
+    nothing else is validated - the elements still go through the real parser.
+*/
+bool split_top_level_array(std::string_view input, std::vector<std::size_t>& separators);
+
+/*
+    stage 2: the same grammar as Parser, driving the same Handler, but walking the index instead of
+    the bytes. whitespace is never looked at, every token is found with one load from the index.
+    strings and scalars are still decoded from the input with the shared helpers (scan_string,
+    scan_number / emit_number), so both engines agree on every value and every error.
+
+    the index only says where tokens start, so a scalar has to be checked for junk after it: "truex"
+    and "12abc" are one scalar run each and would otherwise read as true / 12.
+*/
+template <typename Handler>
+class IndexedParser {
+public:
+    IndexedParser(std::string_view input, const std::vector<std::uint32_t>& index, Handler& handler,
+                  std::size_t max_depth = ParseOptions::kDefaultMaxDepth)
+        : input_(input), index_(index.data()), count_(index.size()), handler_(handler), max_depth_(max_depth) {}
+
+    bool parse() {
+        if(!parse_value()) return false;
+        if(next_ != count_) {
+            throw ParseError("unexpected characters after JSON", position());
+        }
+        return true;
+    }
+
+    //start over on a new input and its index, keeping the scratch buffers (like Parser::reset)
+    void reset(std::string_view input, const std::vector<std::uint32_t>& index) noexcept {
+        input_ = input;
+        index_ = index.data();
+        count_ = index.size();
+        next_ = 0;
+    }
+
+private:
+    std::string_view input_;
+    const std::uint32_t* index_;
+    std::size_t count_;
+    std::size_t next_ = 0;  //next entry of the index to look at
+    Handler& handler_;
+    std::size_t max_depth_;
+    std::string scratch_;
+    std::vector<char> stack_;  //open containers, see Parser
+
+    std::size_t position() const noexcept {return next_ < count_ ? index_[next_] : input_.size();}
+    char peek() const noexcept {return next_ < count_ ? input_[index_[next_]] : '\0';}
+
+    void expect(char c) {
+        if(next_ >= count_) {
+            throw ParseError("unexpected end of input", input_.size());
+        }
+        if(input_[index_[next_]] != c) {
+            throw ParseError(std::string("expected '") + c + "'", index_[next_]);
+        }
+        ++next_;
+    }
+
+    //a scalar must be followed by whitespace, a structural character, a quote or the end of input
+    void check_scalar_end(std::size_t end) const {
+        if(end >= input_.size()) return;
+        char c = input_[end];
+        if(!simd::is_whitespace(c) && !is_structural_char(c) && c != '"') {
+            throw ParseError("unexpected character", end);
+        }
+    }
+
+    std::string_view string_at(std::size_t at) {
+        //stage 1 never records anything inside a string, so the next entry is already past it
+        return scan_string(input_, at, scratch_);
+    }
+
+    /*
+        same walk as Parser::parse_value. the labels are the states of the grammar: after a value we
+        jump straight to the array or object continuation, so the code for each kind of container is
+        separate instead of one loop that branches on the container type at every token.
+    */
+    bool parse_value() {
+        stack_.clear();
+    value:
+        switch(peek()) {
+            case '[':
+                if(!open_container('[')) return false;
+                if(peek() == ']') goto array_end;
+                goto value;
+            case '{':
+                if(!open_container('{')) return false;
+                if(peek() == '}') goto object_end;
+                goto object_member;
+            default:
+                if(!parse_scalar()) return false;
+                break;
+        }
+    value_done:
+        if(stack_.empty()) return true;
+        if(stack_.back() == '{') goto object_next;
+        //array_next
+        if(peek() == ']') goto array_end;
+        expect(',');
+        goto value;
+    array_end:
+        ++next_;
+        stack_.pop_back();
+        if(!handler_.on_end_array()) return false;
+        goto value_done;
+    object_next:
+        if(peek() == '}') goto object_end;
+        expect(',');
+    object_member:
+        if(!parse_key()) return false;
+        goto value;
+    object_end:
+        ++next_;
+        stack_.pop_back();
+        if(!handler_.on_end_object()) return false;
+        goto value_done;
+    }
+
+    bool parse_scalar() {
+        std::size_t at = position();
+        switch(peek()) {
+            case '"': ++next_; return handler_.on_string(string_at(at));
+            case 't': return parse_literal(at, "true") && handler_.on_bool(true);
+            case 'f': return parse_literal(at, "false") && handler_.on_bool(false);
+            case 'n': return parse_literal(at, "null") && handler_.on_null();
+            default: break;
+        }
+        char c = peek();
+        if(next_ < count_ && (c == '-' || is_digit(c))) return parse_number(at);
+        throw ParseError("unexpected character", at);
+    }
+
+    bool open_container(char c) {
+        if(stack_.size() >= max_depth_) {
+            throw ParseError("maximum nesting depth exceeded", position());
+        }
+        ++next_;
+        stack_.push_back(c);
+        return c == '[' ? handler_.on_start_array() : handler_.on_start_object();
+    }
+
+    bool parse_key() {
+        if(peek() != '"' || next_ >= count_) {
+            throw ParseError("expected string key", position());
+        }
+        std::size_t at = position();
+        ++next_;
+        if(!handler_.on_key(string_at(at))) return false;
+        expect(':');
+        return true;
+    }
+
+    bool parse_literal(std::size_t at, std::string_view literal) {
+        if(input_.substr(at, literal.size()) != literal) {
+            throw ParseError(literal[0] == 'n' ? "expected 'null'" : "expected 'true' or 'false'", at);
+        }
+        check_scalar_end(at + literal.size());
+        ++next_;
+        return true;
+    }
+
+    bool parse_number(std::size_t at) {
+        auto scan = scan_number(input_.data() + at, input_.data() + input_.size());
+        if(!scan.ok) {
+            throw ParseError("invalid number", at + scan.length);
+        }
+        check_scalar_end(at + scan.length);
+        ++next_;
+        return emit_number(input_.substr(at, scan.length), scan.is_integer, at, handler_);
+    }
+};
+
+// both stages. true if the whole document was parsed, false if the handler stopped early
+template <typename Handler>
+bool parse_indexed(std::string_view input, Handler& handler, std::size_t max_depth = ParseOptions::kDefaultMaxDepth) {
+    std::vector<std::uint32_t> index;
+    build_structural_index(input, index);
+    IndexedParser<Handler> parser(input, index, handler, max_depth);
+    return parser.parse();
+}
+
+}
+
+#endif
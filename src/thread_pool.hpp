@@ -0,0 +1,88 @@
+#ifndef JSON_THREAD_POOL_HPP
+#define JSON_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace json::detail {
+
+/*
+    minimal fixed size thread pool for the parallel front ends (not part of the public API).
+    - submit() queues a task and hands back a future for its result (exceptions travel through it)
+    - the destructor drops tasks that have not started and joins the workers. a dropped task's future
+      reports broken_promise, which only matters if someone is still waiting on it (nobody is - the
+      pool is always destroyed after its user stopped collecting results)
+*/
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads) {
+        if(threads == 0) threads = 1;
+        workers_.reserve(threads);
+        for(unsigned i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] {work();});
+        }
+    }
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            queue_.clear();
+        }
+        ready_.notify_all();
+        for(auto& worker : workers_) worker.join();
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] unsigned size() const noexcept {return static_cast<unsigned>(workers_.size());}
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task) {
+        //packaged_task is move only and std::function wants copyable callables, hence the shared_ptr
+        auto packaged = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(task));
+        auto result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.emplace_back([packaged] {(*packaged)();});
+        }
+        ready_.notify_one();
+        return result;
+    }
+
+    // threads to use when the caller asked for 0 ("pick for me")
+    static unsigned default_threads() noexcept {
+        unsigned n = std::thread::hardware_concurrency();
+        return n == 0 ? 1 : n;
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    bool stop_ = false;
+
+    void work() {
+        while(true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this] {return stop_ || !queue_.empty();});
+                if(stop_) return;
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include "json_parser/validate.hpp"
+#include "parser.hpp"
+#include "simd.hpp"
+#include <cstdint>
+
+namespace json {
+
+namespace {
+
+//accepts everything the parser reports. kSkipsValues: strings and numbers are not even decoded for it
+struct Validator {
+    static constexpr bool kSkipsValues = true;
+
+    bool on_null() noexcept {return true;}
+    bool on_bool(bool) noexcept {return true;}
+    bool on_number(double) noexcept {return true;}
+    bool on_int64(std::int64_t) noexcept {return true;}
+    bool on_uint64(std::uint64_t) noexcept {return true;}
+    bool on_string(std::string_view) noexcept {return true;}
+    bool on_key(std::string_view) noexcept {return true;}
+    bool on_start_object() noexcept {return true;}
+    bool on_end_object() noexcept {return true;}
+    bool on_start_array() noexcept {return true;}
+    bool on_end_array() noexcept {return true;}
+};
+
+}
+
+/*
+    two passes: utf-8 over the whole input first (one block scan, the parser never looks inside the
+    strings' bytes), then the grammar. whichever error sits first in the input is the one reported, so a
+    stray byte in a string ahead of a missing bracket is the error, and not the bracket
+*/
+void validate(std::string_view json, const ValidationLimits& limits) {
+    if(json.size() > limits.max_bytes) {
+        throw ParseError("document larger than max_bytes", limits.max_bytes);
+    }
+    std::size_t bad_utf8 = limits.utf8 ? simd::find_invalid_utf8(json.data(), json.size()) : json.size();
+    Validator validator;
+    detail::Parser<Validator> parser(json, validator, limits.max_depth);
+    try {
+        parser.parse();
+    } catch(const ParseError& e) {
+        if(bad_utf8 < e.position()) throw ParseError("invalid utf-8", bad_utf8);
+        throw;
+    }
+    if(bad_utf8 < json.size()) {
+        throw ParseError("invalid utf-8", bad_utf8);
+    }
+}
+
+bool is_valid(std::string_view json, const ValidationLimits& limits) noexcept {
+    try {
+        validate(json, limits);
+        return true;
+    } catch(...) {
+        //ParseError, or bad_alloc from a very deep document's stack
+        return false;
+    }
+}
+
+}
@@ -0,0 +1,110 @@
+#include "json_parser/writer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <ostream>
+#include <system_error>
+
+#if __has_include(<unistd.h>)
+    #include <unistd.h>
+#else
+    #include <io.h>
+#endif
+
+namespace json {
+
+// writer ----------------------------------------------------------------------
+void Writer::write_slow(std::string_view s) {
+    while(!s.empty()) {
+        if(cur_ == end_) overflow(s.size());
+        std::size_t n = std::min(s.size(), static_cast<std::size_t>(end_ - cur_));
+        std::memcpy(cur_, s.data(), n);
+        cur_ += n;
+        s.remove_prefix(n);
+    }
+}
+
+void Writer::fill(char c, std::size_t n) {
+    while(n > 0) {
+        if(cur_ == end_) overflow(n);
+        std::size_t run = std::min(n, static_cast<std::size_t>(end_ - cur_));
+        std::memset(cur_, c, run);
+        cur_ += run;
+        n -= run;
+    }
+}
+
+// string writer -----------------------------------------------------------------
+/*
+    the window is the unused tail of the string itself, so nothing is copied twice. the string is
+    resized geometrically when the window fills up, and trimmed back to what was written in flush()
+*/
+StringWriter::StringWriter(std::string& out) : out_(out) {
+    set_buffer(out_.data() + out_.size(), out_.data() + out_.size());
+}
+
+void StringWriter::flush() {
+    out_.resize(static_cast<std::size_t>(cur_ - out_.data()));
+    set_buffer(out_.data() + out_.size(), out_.data() + out_.size());
+}
+
+void StringWriter::overflow(std::size_t needed) {
+    auto used = static_cast<std::size_t>(cur_ - out_.data());
+    out_.resize(std::max({out_.size() * 2, used + needed, std::size_t(256)}));
+    set_buffer(out_.data() + used, out_.data() + out_.size());
+}
+
+// buffered writers ----------------------------------------------------------------
+BufferedWriter::BufferedWriter(std::size_t buffer_size)
+    : buffer_(std::make_unique_for_overwrite<char[]>(std::max<std::size_t>(buffer_size, 1))),
+      capacity_(std::max<std::size_t>(buffer_size, 1)) {
+    set_buffer(buffer_.get(), buffer_.get() + capacity_);
+}
+
+void BufferedWriter::flush() {
+    if(buffered() > 0) write_out(begin_, buffered());
+    set_buffer(buffer_.get(), buffer_.get() + capacity_);
+}
+
+void BufferedWriter::overflow(std::size_t) {
+    flush();
+}
+
+void BufferedWriter::flush_noexcept() noexcept {
+    try {
+        flush();
+    } catch(...) {
+    }
+}
+
+StreamWriter::StreamWriter(std::ostream& os, std::size_t buffer_size) : BufferedWriter(buffer_size), os_(os) {}
+
+void StreamWriter::write_out(const char* data, std::size_t size) {
+    os_.write(data, static_cast<std::streamsize>(size));
+    if(!os_) throw std::ios_base::failure("json::StreamWriter: stream write failed");
+}
+
+FdWriter::FdWriter(int fd, std::size_t buffer_size) : BufferedWriter(buffer_size), fd_(fd) {}
+
+void FdWriter::write_out(const char* data, std::size_t size) {
+    while(size > 0) {
+#if __has_include(<unistd.h>)
+        auto n = ::write(fd_, data, size);
+#else
+        auto n = ::_write(fd_, data, static_cast<unsigned>(std::min<std::size_t>(size, 1u << 30)));
+#endif
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            throw std::system_error(errno, std::generic_category(), "json::FdWriter: write failed");
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+CallbackWriter::CallbackWriter(Sink sink, std::size_t buffer_size) : BufferedWriter(buffer_size), sink_(std::move(sink)) {}
+
+void CallbackWriter::write_out(const char* data, std::size_t size) {
+    sink_(std::string_view(data, size));
+}
+
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include "json_parser/bind.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace shop {
+
+struct Item {
+    std::string sku;
+    int qty = 0;
+    double price = 0;
+    std::vector<std::string> tags;
+};
+JSON_FIELDS(Item, sku, qty, price, tags)
+
+struct Order {
+    std::uint64_t id = 0;
+    bool paid = false;
+    std::vector<Item> items;
+    std::optional<std::string> note;
+    std::optional<Item> gift;
+    float discount = 0;
+};
+JSON_FIELDS(Order, id, paid, items, note, gift, discount)
+
+//refers to itself through the vector
+struct Category {
+    std::string name;
+    std::vector<Category> children;
+};
+JSON_FIELDS(Category, name, children)
+
+struct Ranges {
+    std::int8_t i8 = 0;
+    std::uint8_t u8 = 0;
+    std::int64_t i64 = 0;
+    std::uint64_t u64 = 0;
+    unsigned short us = 0;
+};
+JSON_FIELDS(Ranges, i8, u8, i64, u64, us)
+
+}
+
+//and one in the global namespace, with more members than the slots of a small table
+struct Wide {
+    int f0 = 0, f1 = 0, f2 = 0, f3 = 0, f4 = 0, f5 = 0, f6 = 0, f7 = 0, f8 = 0, f9 = 0;
+    int f10 = 0, f11 = 0, f12 = 0, f13 = 0, f14 = 0, f15 = 0, f16 = 0, f17 = 0, f18 = 0, f19 = 0;
+    int f20 = 0, f21 = 0, f22 = 0, f23 = 0, f24 = 0, f25 = 0, f26 = 0, f27 = 0, f28 = 0, f29 = 0, f30 = 0, f31 = 0;
+};
+JSON_FIELDS(Wide, f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19,
+            f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30, f31)
+
+namespace {
+
+const std::string kOrder = R"({
+    "id": 18446744073709551615,
+    "paid": true,
+    "items": [
+        {"sku": "a-1", "qty": 2, "price": 9.5, "tags": ["new", "sale"]},
+        {"sku": "b\"2", "qty": 1, "price": 3, "extra": {"ignored": [1, {"deep": null}]}}
+    ],
+    "note": "leave at the door",
+    "gift": null,
+    "discount": 0.25,
+    "unknown": [true, "x"]
+})";
+
+}
+
+TEST(JsonBind, FillsNestedStructs){
+    auto order = json::from_json<shop::Order>(kOrder);
+    EXPECT_EQ(order.id, UINT64_MAX);
+    EXPECT_TRUE(order.paid);
+    ASSERT_EQ(order.items.size(), 2u);
+    EXPECT_EQ(order.items[0].sku, "a-1");
+    EXPECT_EQ(order.items[0].qty, 2);
+    EXPECT_EQ(order.items[0].price, 9.5);
+    EXPECT_EQ(order.items[0].tags, (std::vector<std::string>{"new", "sale"}));
+    EXPECT_EQ(order.items[1].sku, "b\"2");
+    EXPECT_EQ(order.items[1].price, 3.0);
+    EXPECT_TRUE(order.items[1].tags.empty());
+    EXPECT_EQ(order.note, "leave at the door");
+    EXPECT_FALSE(order.gift.has_value());
+    EXPECT_FLOAT_EQ(order.discount, 0.25f);
+}
+TEST(JsonBind, OptionalsAndMissingKeys){
+    auto order = json::from_json<shop::Order>(R"({"gift": {"sku": "g", "qty": 1}, "note": null})");
+    EXPECT_EQ(order.id, 0u);
+    EXPECT_TRUE(order.items.empty());
+    EXPECT_FALSE(order.note.has_value());
+    ASSERT_TRUE(order.gift.has_value());
+    EXPECT_EQ(order.gift->sku, "g");
+
+    //from_json(json, out) leaves members of missing keys alone, null resets an optional
+    json::from_json(R"({"paid": true, "gift": null})", order);
+    EXPECT_TRUE(order.paid);
+    EXPECT_FALSE(order.gift.has_value());
+    //arrays are replaced, not appended to
+    json::from_json(R"({"items": [{"sku": "x"}]})", order);
+    json::from_json(R"({"items": [{"sku": "y"}]})", order);
+    ASSERT_EQ(order.items.size(), 1u);
+    EXPECT_EQ(order.items[0].sku, "y");
+}
+TEST(JsonBind, DuplicateKeysLastWins){
+    auto item = json::from_json<shop::Item>(R"({"qty": 1, "qty": 5})");
+    EXPECT_EQ(item.qty, 5);
+}
+TEST(JsonBind, RecursiveTypes){
+    auto root = json::from_json<shop::Category>(
+        R"({"name": "root", "children": [{"name": "a", "children": [{"name": "a1", "children": []}]}, {"name": "b"}]})");
+    ASSERT_EQ(root.children.size(), 2u);
+    EXPECT_EQ(root.children[0].children[0].name, "a1");
+    EXPECT_EQ(root.children[1].name, "b");
+}
+TEST(JsonBind, EveryKeyOfAWideStruct){
+    std::string json = "{";
+    for(int i = 0; i < 32; ++i) {
+        json += (i ? ", \"f" : "\"f") + std::to_string(i) + "\": " + std::to_string(i * 10);
+    }
+    json += R"(, "f32": 1, "f": 2, "f000": 3})";
+    auto wide = json::from_json<Wide>(json);
+    EXPECT_EQ(wide.f0, 0);
+    EXPECT_EQ(wide.f7, 70);
+    EXPECT_EQ(wide.f19, 190);
+    EXPECT_EQ(wide.f31, 310);
+}
+TEST(JsonBind, IntegerRanges){
+    auto r = json::from_json<shop::Ranges>(R"({"i8": -128, "u8": 255, "i64": -9223372036854775808, "u64": 18446744073709551615, "us": 65535})");
+    EXPECT_EQ(r.i8, -128);
+    EXPECT_EQ(r.u8, 255);
+    EXPECT_EQ(r.i64, INT64_MIN);
+    EXPECT_EQ(r.u64, UINT64_MAX);
+    EXPECT_EQ(r.us, 65535);
+    EXPECT_THROW((void)json::from_json<shop::Ranges>(R"({"i8": 128})"), json::ParseError);
+    EXPECT_THROW((void)json::from_json<shop::Ranges>(R"({"i8": -129})"), json::ParseError);
+    EXPECT_THROW((void)json::from_json<shop::Ranges>(R"({"u8": 256})"), json::ParseError);
+    EXPECT_THROW((void)json::from_json<shop::Ranges>(R"({"u8": -1})"), json::ParseError);
+    EXPECT_THROW((void)json::from_json<shop::Ranges>(R"({"i64": 9223372036854775808})"), json::ParseError);
+    EXPECT_THROW((void)json::from_json<shop::Ranges>(R"({"us": 1.5})"), json::ParseError);
+}
+TEST(JsonBind, MismatchesThrowWithPosition){
+    auto error = [](const std::string& json) -> std::string {
+        try {
+            (void)json::from_json<shop::Order>(json);
+        } catch(const json::ParseError& e) {
+            return e.what();
+        }
+        return "";
+    };
+    //the position is where the value starts, for scalars and containers alike
+    EXPECT_EQ(error(R"({"id": "7"})"), "expected an integer at position 7");
+    EXPECT_EQ(error(R"({"id": 12.75})"), "expected an integer at position 7");
+    EXPECT_EQ(error(R"({"id": -1})"), "integer out of range at position 7");
+    EXPECT_EQ(error(R"({"paid": 1})"), "expected a bool at position 9");
+    EXPECT_EQ(error(R"({"items": {}})"), "expected an array at position 10");
+    EXPECT_EQ(error(R"({"items": [1]})"), "expected an object at position 11");
+    EXPECT_EQ(error(R"({"items": [{"sku": "a"},  true]})"), "expected an object at position 26");
+    EXPECT_EQ(error(R"({"note": 5})"), "expected a string at position 9");
+    EXPECT_EQ(error(R"({"id": null})"), "unexpected null at position 7");
+    EXPECT_EQ(error(R"(  [])"), "expected an object at position 2");
+    //syntax errors are the parser's
+    EXPECT_EQ(error(R"({"id": 1,})"), "expected string key at position 9");
+    EXPECT_EQ(error(R"({"unknown": [1 2]})"), "expected ',' at position 15");
+}
+TEST(JsonBind, TopLevelContainersAndMaxDepth){
+    auto tags = json::from_json<std::vector<std::optional<std::string>>>(R"(["a", null, "c"])");
+    ASSERT_EQ(tags.size(), 3u);
+    EXPECT_FALSE(tags[1].has_value());
+    EXPECT_EQ(json::from_json<int>("42"), 42);
+
+    json::ParseOptions options;
+    options.max_depth = 2;
+    EXPECT_NO_THROW((void)json::from_json<shop::Category>(R"({"name": "a", "children": []})", options));
+    EXPECT_THROW((void)json::from_json<shop::Category>(R"({"children": [{}]})", options), json::ParseError);
+    //skipped values count too
+    EXPECT_THROW((void)json::from_json<shop::Item>(R"({"x": [[1]]})", options), json::ParseError);
+}
+TEST(JsonBind, KeyTableIsPerfect){
+    //every member name has its own slot, and a key that is not a member never matches
+    const json::detail::TypeDesc& desc = json::detail::type_of<Wide>();
+    std::vector<bool> used(desc.mask + 1);
+    for(std::size_t i = 0; i < desc.field_count; ++i) {
+        std::size_t slot = json::detail::key_hash(desc.fields[i].name, desc.seed) & desc.mask;
+        EXPECT_FALSE(used[slot]);
+        used[slot] = true;
+        EXPECT_EQ(desc.slots[slot], i + 1);
+    }
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "json_parser/builder.hpp"
+#include "json_parser/key_pool.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+TEST(JsonBuilder, BuildsWhatParseBuilds){
+    json::Builder b;
+    b.begin_object();
+    b.key("id").value(42);
+    b.key("price").value(9.5);
+    b.key("name").value("a name longer than eight bytes");
+    b.key("paid").value(true);
+    b.key("note").value(nullptr);
+    b.key("tags").begin_array().value("new").value(std::string("sale")).end_array();
+    b.key("owner").begin_object().key("big").value(std::uint64_t{18446744073709551615u}).end_object();
+    b.key("empty").begin_array().end_array();
+    b.end_object();
+    json::JsonValue doc = b.take();
+
+    const std::string text = R"({"id":42,"price":9.5,"name":"a name longer than eight bytes","paid":true,"note":null,)"
+                             R"("tags":["new","sale"],"owner":{"big":18446744073709551615},"empty":[]})";
+    EXPECT_EQ(doc.dump(), json::parse(text).dump());
+    EXPECT_EQ(doc["id"].type(), json::JsonValue::Type::Int64);
+    EXPECT_EQ(doc["owner"]["big"].type(), json::JsonValue::Type::Uint64);
+}
+TEST(JsonBuilder, ContainersHaveTheirExactSize){
+    json::Builder b;
+    b.begin_array();
+    for(int i = 0; i < 1000; ++i) b.value(i);
+    b.end_array();
+    json::JsonValue arr = b.take();
+    ASSERT_EQ(arr.size(), 1000u);
+    EXPECT_EQ(arr.as_array().capacity(), 1000u);
+    EXPECT_EQ(arr[999].as_int64(), 999);
+}
+TEST(JsonBuilder, DuplicateKeysLastWins){
+    json::Builder b;
+    b.begin_object().key("a").value(1).key("b").value(2).key("a").value(3).end_object();
+    EXPECT_EQ(b.take().dump(), R"({"a":3,"b":2})");
+}
+TEST(JsonBuilder, ScalarRootAndReuse){
+    json::Builder b;
+    b.value("root");
+    EXPECT_EQ(b.take().as_string(), "root");
+    //nothing added is null
+    EXPECT_TRUE(b.take().is_null());
+    //the same builder, next document
+    b.begin_array().value(1).end_array();
+    EXPECT_EQ(b.take().dump(), "[1]");
+}
+TEST(JsonBuilder, SubtreesAreTakenAsTheyAre){
+    json::JsonValue shared = json::parse(R"({"host": "alpha.internal", "port": 8080})").share();
+    json::Builder b;
+    b.begin_array().value(shared).value(json::parse("[1, 2]")).end_array();
+    json::JsonValue doc = b.take();
+    EXPECT_TRUE(std::as_const(doc)[0].is_shared());
+    EXPECT_EQ(doc.dump(), R"([{"host":"alpha.internal","port":8080},[1,2]])");
+}
+TEST(JsonBuilder, ArenaAndKeyPool){
+    json::Arena arena;
+    json::KeyPool pool;
+    json::Builder b(arena, &pool);
+    b.begin_object().key("a_key_long_enough_to_be_pooled").value("a string that goes in the arena").end_object();
+    json::JsonValue doc = b.take();
+    EXPECT_GT(arena.bytes_used(), 0u);
+    EXPECT_EQ(pool.size(), 1u);
+    EXPECT_TRUE(doc.as_object().begin()->first.is_pooled());
+    EXPECT_EQ(doc["a_key_long_enough_to_be_pooled"].as_string(), "a string that goes in the arena");
+}
+TEST(JsonBuilder, MisuseThrows){
+    {
+        json::Builder b;
+        b.begin_object();
+        EXPECT_THROW(b.value(1), std::logic_error);
+        EXPECT_THROW(b.end_array(), std::logic_error);
+        b.key("a");
+        EXPECT_THROW(b.key("b"), std::logic_error);
+        EXPECT_THROW(b.end_object(), std::logic_error);
+        b.value(1);
+        EXPECT_THROW((void)b.take(), std::logic_error);
+        b.end_object();
+        EXPECT_THROW(b.value(2), std::logic_error);
+        EXPECT_EQ(b.take().dump(), R"({"a":1})");
+    }
+    json::Builder b;
+    EXPECT_THROW(b.key("a"), std::logic_error);
+    b.begin_array();
+    EXPECT_THROW(b.key("a"), std::logic_error);
+    EXPECT_THROW(b.end_object(), std::logic_error);
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "json_parser/json.hpp"
+#include "json_parser/key_pool.hpp"
+#include "json_parser/writer.hpp"
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace {
+
+const std::string kInput = R"({"name": "line\nbreak \"quoted\"", "ratio": 0.1, "half": 1.5, "one": 1.0,)"
+                           R"( "ids": [0, 23, 24, 255, 256, 65536, -1, -24, -25, -9223372036854775808, 18446744073709551615],)"
+                           R"( "nested": {"deep": {"deeper": [true, false, null, {}, []]}}, "empty": "", "café": "ünïcödé"})";
+
+//"0102" -> "\x01\x02" (CBOR test vectors are written as hex in the RFC)
+std::string hex(std::string_view digits) {
+    std::string out;
+    for(std::size_t i = 0; i + 1 < digits.size(); i += 2) {
+        out.push_back(static_cast<char>(std::stoi(std::string(digits.substr(i, 2)), nullptr, 16)));
+    }
+    return out;
+}
+
+}
+
+TEST(JsonCbor, RoundTripKeepsValuesAndTypes){
+    auto value = json::parse(kInput);
+    auto decoded = json::from_cbor(value.to_cbor());
+    EXPECT_EQ(decoded.dump(), value.dump());
+    EXPECT_EQ(decoded["one"].type(), json::JsonValue::Type::Number);
+    EXPECT_EQ(decoded["ids"][0].type(), json::JsonValue::Type::Int64);
+    EXPECT_EQ(decoded["ids"][9].as_int64(), INT64_MIN);
+    EXPECT_EQ(decoded["ids"][10].type(), json::JsonValue::Type::Uint64);
+    EXPECT_EQ(decoded["ratio"].as_number(), 0.1);
+    //and it is smaller than the text
+    EXPECT_LT(value.to_cbor().size(), value.dump().size());
+}
+TEST(JsonCbor, EncodesRfcExamples){
+    //RFC 8949 appendix A, preferred serialization
+    EXPECT_EQ(json::JsonValue(0).to_cbor(), hex("00"));
+    EXPECT_EQ(json::JsonValue(23).to_cbor(), hex("17"));
+    EXPECT_EQ(json::JsonValue(24).to_cbor(), hex("1818"));
+    EXPECT_EQ(json::JsonValue(1000).to_cbor(), hex("1903e8"));
+    EXPECT_EQ(json::JsonValue(1000000).to_cbor(), hex("1a000f4240"));
+    EXPECT_EQ(json::JsonValue(1000000000000).to_cbor(), hex("1b000000e8d4a51000"));
+    EXPECT_EQ(json::JsonValue(UINT64_MAX).to_cbor(), hex("1bffffffffffffffff"));
+    EXPECT_EQ(json::JsonValue(-1).to_cbor(), hex("20"));
+    EXPECT_EQ(json::JsonValue(-1000).to_cbor(), hex("3903e7"));
+    EXPECT_EQ(json::JsonValue(0.0).to_cbor(), hex("f90000"));
+    EXPECT_EQ(json::JsonValue(-0.0).to_cbor(), hex("f98000"));
+    EXPECT_EQ(json::JsonValue(1.5).to_cbor(), hex("f93e00"));
+    EXPECT_EQ(json::JsonValue(65504.0).to_cbor(), hex("f97bff"));
+    EXPECT_EQ(json::JsonValue(5.960464477539063e-8).to_cbor(), hex("f90001"));
+    EXPECT_EQ(json::JsonValue(100000.0).to_cbor(), hex("fa47c35000"));
+    EXPECT_EQ(json::JsonValue(3.4028234663852886e+38).to_cbor(), hex("fa7f7fffff"));
+    EXPECT_EQ(json::JsonValue(1.1).to_cbor(), hex("fb3ff199999999999a"));
+    EXPECT_EQ(json::JsonValue(1.0e+300).to_cbor(), hex("fb7e37e43c8800759c"));
+    EXPECT_EQ(json::JsonValue(false).to_cbor(), hex("f4"));
+    EXPECT_EQ(json::JsonValue(true).to_cbor(), hex("f5"));
+    EXPECT_EQ(json::JsonValue().to_cbor(), hex("f6"));
+    EXPECT_EQ(json::JsonValue("").to_cbor(), hex("60"));
+    EXPECT_EQ(json::JsonValue("IETF").to_cbor(), hex("6449455446"));
+    EXPECT_EQ(json::JsonValue("\xc3\xbc").to_cbor(), hex("62c3bc"));
+    EXPECT_EQ(json::parse("[1, [2, 3], [4, 5]]").to_cbor(), hex("8301820203820405"));
+    EXPECT_EQ(json::parse(R"({"a": 1, "b": [2, 3]})").to_cbor(), hex("a26161016162820203"));
+}
+TEST(JsonCbor, DecodesOtherEncoders){
+    //indefinite lengths and chunked strings (RFC 8949 appendix A again)
+    EXPECT_EQ(json::from_cbor(hex("9f018202039f0405ffff")).dump(), "[1,[2,3],[4,5]]");
+    EXPECT_EQ(json::from_cbor(hex("bf61610161629f0203ffff")).dump(), R"({"a":1,"b":[2,3]})");
+    EXPECT_EQ(json::from_cbor(hex("7f657374726561646d696e67ff")).as_string(), "streaming");
+    EXPECT_EQ(json::from_cbor(hex("9fff")).size(), 0u);
+    //non preferred (longer than needed) heads
+    EXPECT_EQ(json::from_cbor(hex("1b0000000000000001")).as_int64(), 1);
+    EXPECT_EQ(json::from_cbor(hex("fb3ff8000000000000")).as_number(), 1.5);
+    //half / single precision
+    EXPECT_EQ(json::from_cbor(hex("f90400")).as_number(), 6.103515625e-05);
+    EXPECT_EQ(json::from_cbor(hex("f9c400")).as_number(), -4.0);
+    EXPECT_TRUE(std::isinf(json::from_cbor(hex("f97c00")).as_number()));
+    EXPECT_TRUE(std::isnan(json::from_cbor(hex("f97e00")).as_number()));
+    EXPECT_EQ(json::from_cbor(hex("fa47c35000")).as_number(), 100000.0);
+    //tags are skipped (0: date/time string, 1: epoch)
+    EXPECT_EQ(json::from_cbor(hex("c074323031332d30332d32315432303a30343a30305a")).as_string(), "2013-03-21T20:04:00Z");
+    EXPECT_EQ(json::from_cbor(hex("c11a514b67b0")).as_int64(), 1363896240);
+    EXPECT_TRUE(json::from_cbor(hex("f7")).is_null());
+    //below INT64_MIN becomes a double, like in JSON text
+    EXPECT_EQ(json::from_cbor(hex("3bffffffffffffffff")).as_number(), -18446744073709551616.0);
+}
+TEST(JsonCbor, MalformedInputThrows){
+    auto position = [](const std::string& bytes) -> std::size_t {
+        try {
+            (void)json::from_cbor(bytes);
+        } catch(const json::ParseError& e) {
+            return e.position();
+        }
+        return SIZE_MAX;
+    };
+    EXPECT_EQ(position(""), 0u);
+    EXPECT_EQ(position(hex("83010203")), SIZE_MAX);  //complete, does not throw
+    EXPECT_EQ(position(hex("830102")), 3u);          //truncated array
+    EXPECT_EQ(position(hex("1903")), 2u);            //truncated argument
+    EXPECT_EQ(position(hex("6449")), 0u);            //truncated string
+    EXPECT_EQ(position(hex("9f01")), 2u);            //no break
+    EXPECT_EQ(position(hex("0102")), 1u);            //trailing data
+    EXPECT_EQ(position(hex("a10102")), 1u);          //integer key
+    EXPECT_EQ(position(hex("4161")), 0u);            //byte string
+    EXPECT_EQ(position(hex("8201ff")), 2u);          //break in a definite array
+    EXPECT_EQ(position(hex("bf6161ff")), 3u);        //break instead of a value
+    EXPECT_EQ(position(hex("1c")), 0u);              //reserved additional info
+    EXPECT_EQ(position(hex("1f")), 0u);              //indefinite integer
+    EXPECT_EQ(position(hex("f0")), 0u);              //unassigned simple value
+    EXPECT_EQ(position(hex("7f4161ff")), 1u);        //byte string chunk in a text string
+    //a huge count does not allocate for it, it just runs out of input
+    EXPECT_EQ(position(hex("9bffffffffffffffff01")), 10u);
+}
+TEST(JsonCbor, DuplicateKeysLikeParse){
+    //{"a": 1, "b": 2, "a": 3}
+    EXPECT_EQ(json::from_cbor(hex("a3616101616202616103")).dump(), json::parse(R"({"a": 1, "b": 2, "a": 3})").dump());
+}
+TEST(JsonCbor, MaxDepth){
+    std::string nested(5, static_cast<char>(0x81));
+    nested.push_back(static_cast<char>(0x80));
+    EXPECT_EQ(json::from_cbor(nested).dump(), "[[[[[[]]]]]]");
+    json::ParseOptions options;
+    options.max_depth = 6;
+    EXPECT_NO_THROW((void)json::from_cbor(nested, options));
+    options.max_depth = 5;
+    EXPECT_THROW((void)json::from_cbor(nested, options), json::ParseError);
+    //no recursion while decoding
+    std::string deep(1'000'000, static_cast<char>(0x81));
+    deep.push_back(static_cast<char>(0xf6));
+    options.max_depth = SIZE_MAX;
+    EXPECT_THROW((void)json::from_cbor(deep), json::ParseError);
+    auto value = json::from_cbor(deep, options);
+    EXPECT_TRUE(value.is_array());
+    //the value itself is destroyed recursively - unwind it level by level
+    while(value.is_array()) {
+        json::JsonValue inner = std::move(value.as_array()[0]);
+        value = std::move(inner);
+    }
+    EXPECT_TRUE(value.is_null());
+}
+TEST(JsonCbor, OptionsAndResources){
+    auto encoded = json::parse(kInput).to_cbor();
+    json::Arena arena;
+    auto in_arena = json::from_cbor(encoded, arena);
+    EXPECT_EQ(in_arena["nested"].as_object().get_allocator().resource(), &arena);
+
+    json::KeyPool pool;
+    json::ParseOptions options;
+    options.key_pool = &pool;
+    options.in_situ_strings = true;
+    auto borrowed = json::from_cbor(encoded, options);
+    EXPECT_EQ(borrowed.dump(), json::parse(kInput).dump());
+    //long strings point into the encoded bytes
+    std::string_view name = borrowed["name"].as_string();
+    EXPECT_GE(name.data(), encoded.data());
+    EXPECT_LE(name.data() + name.size(), encoded.data() + encoded.size());
+}
+TEST(JsonCbor, WriterSinks){
+    auto value = json::parse(kInput);
+    std::string streamed;
+    {
+        json::CallbackWriter writer([&](std::string_view chunk) {streamed.append(chunk);}, 5);
+        value.to_cbor(writer);
+    }
+    EXPECT_EQ(streamed, value.to_cbor());
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include "json_parser/document.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const std::string kInput = R"({
+    "skipped": {"deep": [1, [2, [3, "]]]}}"]]], "x": "\"}", "esc\"aped": "brackets ] } inside"},
+    "id": 9007199254740993,
+    "name": "café",
+    "ratio": 0.25,
+    "big": 18446744073709551615,
+    "flags": [true, false, null],
+    "user": {"profile": {"email": "a@b.c", "age": 41}, "roles": ["admin", "dev"]},
+    "empty": {},
+    "none": []
+})";
+
+}
+
+TEST(JsonDocument, ReadsNestedFields){
+    json::Document doc(kInput);
+    EXPECT_EQ(doc["user"]["profile"]["email"].as_string(), "a@b.c");
+    EXPECT_EQ(doc["user"]["profile"]["age"].as_int64(), 41);
+    EXPECT_EQ(doc["user"]["roles"][1].as_string(), "dev");
+}
+TEST(JsonDocument, ScalarsMatchJsonValue){
+    json::Document doc(kInput);
+    EXPECT_EQ(doc["id"].as_int64(), 9007199254740993);
+    EXPECT_EQ(doc["id"].type(), json::LazyValue::Type::Int64);
+    EXPECT_EQ(doc["big"].as_uint64(), 18446744073709551615ull);
+    EXPECT_THROW((void)doc["big"].as_int64(), std::out_of_range);
+    EXPECT_DOUBLE_EQ(doc["ratio"].as_number(), 0.25);
+    EXPECT_EQ(doc["name"].as_string(), "caf\xC3\xA9");
+    EXPECT_TRUE(doc["flags"][0].as_bool());
+    EXPECT_FALSE(doc["flags"][1].as_bool());
+    EXPECT_TRUE(doc["flags"][2].is_null());
+    EXPECT_TRUE(doc["ratio"].is_number());
+}
+TEST(JsonDocument, SkipsBracketsAndQuotesInsideStrings){
+    json::Document doc(kInput);
+    //"skipped" is full of brackets and escaped quotes inside strings - the id after it must still be found
+    EXPECT_EQ(doc["id"].as_int64(), 9007199254740993);
+    EXPECT_EQ(doc["skipped"]["esc\"aped"].as_string(), "brackets ] } inside");
+    EXPECT_EQ(doc["skipped"]["deep"][1][1][1].as_string(), "]]]}}");
+}
+TEST(JsonDocument, AnyLookupOrder){
+    json::Document doc(kInput);
+    //forwards, backwards and repeated lookups all work with the cursor memo
+    EXPECT_EQ(doc["ratio"].as_number(), 0.25);
+    EXPECT_EQ(doc["name"].as_string(), "caf\xC3\xA9");
+    EXPECT_EQ(doc["none"].size(), 0u);
+    EXPECT_EQ(doc["id"].as_int64(), 9007199254740993);
+    EXPECT_EQ(doc["id"].as_int64(), 9007199254740993);
+    EXPECT_TRUE(doc.root().contains("empty"));
+    EXPECT_FALSE(doc.root().contains("missing"));
+    EXPECT_EQ(doc["flags"][2].type(), json::LazyValue::Type::Null);
+    EXPECT_TRUE(doc["flags"][0].as_bool());
+}
+TEST(JsonDocument, ArrayIndexForwardAndBack){
+    json::Document doc("[10, 11, 12, 13, 14]");
+    auto arr = doc.root();
+    for(std::size_t i = 0; i < 5; ++i) EXPECT_EQ(arr[i].as_int64(), static_cast<std::int64_t>(10 + i));
+    EXPECT_EQ(arr[1].as_int64(), 11);
+    EXPECT_EQ(arr[4].as_int64(), 14);
+    EXPECT_THROW((void)arr[5], std::out_of_range);
+    EXPECT_EQ(arr.size(), 5u);
+}
+TEST(JsonDocument, Sizes){
+    json::Document doc(kInput);
+    EXPECT_EQ(doc.root().size(), 9u);
+    EXPECT_EQ(doc["flags"].size(), 3u);
+    EXPECT_EQ(doc["empty"].size(), 0u);
+    EXPECT_THROW((void)doc["id"].size(), std::runtime_error);
+}
+TEST(JsonDocument, MissingAndWrongType){
+    json::Document doc(kInput);
+    EXPECT_THROW((void)doc["missing"], std::out_of_range);
+    EXPECT_THROW((void)doc["flags"][3], std::out_of_range);
+    EXPECT_THROW((void)doc["name"].as_int64(), std::runtime_error);
+    EXPECT_THROW((void)doc["user"].as_string(), std::runtime_error);
+    EXPECT_THROW((void)doc["user"]["x"], std::out_of_range);
+    EXPECT_THROW((void)doc["flags"]["x"], std::runtime_error);
+    EXPECT_THROW((void)doc["user"][0], std::runtime_error);
+}
+TEST(JsonDocument, MaterializeMatchesParse){
+    json::Document doc(kInput);
+    EXPECT_EQ(doc["user"].materialize().dump(), json::parse(kInput)["user"].dump());
+    EXPECT_EQ(doc.root().materialize().dump(), json::parse(kInput).dump());
+    json::Arena arena;
+    auto roles = doc["user"]["roles"].materialize(arena);
+    EXPECT_EQ(roles.as_array().get_allocator().resource(), &arena);
+}
+TEST(JsonDocument, RawJson){
+    json::Document doc(kInput);
+    EXPECT_EQ(doc["user"]["roles"].raw_json(), R"(["admin", "dev"])");
+    EXPECT_EQ(doc["ratio"].raw_json(), "0.25");
+    EXPECT_EQ(doc["name"].raw_json(), R"("café")");
+}
+TEST(JsonDocument, OnlyReadValuesAreValidated){
+    //the broken member is never read, so it does not matter
+    json::Document doc(R"({"broken": [1, 2 3, tru], "ok": 5})");
+    EXPECT_EQ(doc["ok"].as_int64(), 5);
+    //reading it does throw
+    EXPECT_THROW((void)doc["broken"].materialize(), json::ParseError);
+    EXPECT_THROW((void)json::Document(R"({"n": 12abc})")["n"].as_int64(), json::ParseError);
+    EXPECT_THROW((void)json::Document(R"({"n": tru})")["n"].as_bool(), json::ParseError);
+}
+TEST(JsonDocument, MalformedStructureThrows){
+    EXPECT_THROW(json::Document(""), json::ParseError);
+    EXPECT_THROW(json::Document("   "), json::ParseError);
+    EXPECT_THROW((void)json::Document(R"({"a": 1 "b": 2})")["b"], json::ParseError);
+    EXPECT_THROW((void)json::Document(R"({"a" 1})")["a"], json::ParseError);
+    EXPECT_THROW((void)json::Document(R"({"a": "unterminated)")["b"], json::ParseError);
+    EXPECT_THROW((void)json::Document(R"({"a": [1, 2)")["b"], json::ParseError);
+    EXPECT_THROW((void)json::Document(R"([1, 2)")[5], json::ParseError);
+}
+TEST(JsonDocument, TruncatedInputWhileSkipping){
+    //each input in a heap buffer of exactly its size, so a read past the end is a read past the buffer
+    auto lookup = [](std::string_view text, auto&& read) {
+        std::unique_ptr<char[]> buffer(new char[text.size()]);
+        std::copy(text.begin(), text.end(), buffer.get());
+        json::Document doc(std::string_view(buffer.get(), text.size()));
+        read(doc);
+    };
+    auto missing_key = [](const json::Document& doc) {(void)doc["z"];};
+    auto missing_index = [](const json::Document& doc) {(void)doc[5];};
+    //a skipped member that ends in a truncated escape
+    EXPECT_THROW(lookup(R"({"k":"\)", missing_key), json::ParseError);
+    EXPECT_THROW(lookup(R"({"k":["a\)", missing_key), json::ParseError);
+    EXPECT_THROW(lookup(R"([1, "\)", missing_index), json::ParseError);
+    try {
+        lookup(R"({"k":"\)", missing_key);
+    } catch(const json::ParseError& e) {
+        EXPECT_STREQ(e.what(), "unexpected end of input at position 7");
+    }
+    //every prefix of a document: lookups of what is not there throw or miss, never read past the end
+    const std::string text = R"({"a": {"s": "x\"y\\", "l": [1, "é", {"n": null}]}, "b": "\\\"", "c": tru})";
+    for(std::size_t cut = 1; cut < text.size(); ++cut) {
+        std::string_view prefix(text.data(), cut);
+        EXPECT_THROW(lookup(prefix, missing_key), json::ParseError) << "cut at " << cut;
+        EXPECT_THROW(lookup(prefix, [](const json::Document& doc) {(void)doc.root().size();}), json::ParseError) << "cut at " << cut;
+    }
+}
+TEST(JsonDocument, FirstDuplicateKeyWins){
+    json::Document doc(R"({"a": 1, "b": 2, "a": 3})");
+    EXPECT_EQ(doc["a"].as_int64(), 1);
+    EXPECT_EQ(doc["b"].as_int64(), 2);
+    //Document's lookups keep no memo, each one finds the first occurrence
+    EXPECT_EQ(doc["a"].as_int64(), 1);
+}
+TEST(JsonDocument, DuplicateKeysFromTheCursor){
+    json::Document doc(R"({"a": 1, "b": 2, "a": 3})");
+    json::LazyValue root = doc.root();
+    EXPECT_EQ(root["a"].as_int64(), 1);
+    //the search starts at the member found last and wraps around
+    EXPECT_EQ(root["b"].as_int64(), 2);
+    EXPECT_EQ(root["a"].as_int64(), 3);
+    EXPECT_EQ(root["a"].as_int64(), 3);
+    EXPECT_EQ(root["b"].as_int64(), 2);
+    //a fresh copy of the root starts over
+    EXPECT_EQ(doc.root()["a"].as_int64(), 1);
+}
+TEST(JsonDocument, ConstDocumentFromThreads){
+    const json::Document doc(R"({"a": 1, "b": [10, 11, 12], "c": "x", "d": true})");
+    std::vector<std::thread> threads;
+    std::atomic<int> failures = 0;
+    for(int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for(int i = 0; i < 2000; ++i) {
+                bool ok = (t % 2 ? doc["d"].as_bool() && doc["a"].as_int64() == 1
+                                 : doc["b"][2].as_int64() == 12 && doc["c"].as_string() == "x");
+                if(!ok) ++failures;
+            }
+        });
+    }
+    for(std::thread& t : threads) t.join();
+    EXPECT_EQ(failures, 0);
+}
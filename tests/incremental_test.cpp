@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include "json_parser/incremental.hpp"
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string kDocument =
+    R"({"name": "caf\u00e9 \"bar\"\n", "id": -1234567, "big": 18446744073709551615, )"
+    R"("ratio": 3.25e-2, "ok": true, "no": false, "none": null, "list": [1, [], {}, "x\\y"], )"
+    R"("nested": {"deep": [0.5, -0, 1E+3]}})";
+
+//feed 'input' split at the given byte offsets
+json::JsonValue parse_split(std::string_view input, const std::vector<std::size_t>& cuts) {
+    json::IncrementalParser parser;
+    std::size_t from = 0;
+    for(std::size_t cut : cuts) {
+        parser.feed(input.substr(from, cut - from));
+        from = cut;
+    }
+    parser.feed(input.substr(from));
+    return parser.finish();
+}
+
+//records every event as a short string so whole streams can be compared at once
+struct Recorder : json::SaxHandler {
+    std::vector<std::string> events;
+    bool on_null() override {events.push_back("null"); return true;}
+    bool on_bool(bool b) override {events.push_back(b ? "true" : "false"); return true;}
+    bool on_number(double d) override {events.push_back("d:" + std::to_string(d)); return true;}
+    bool on_int64(std::int64_t i) override {events.push_back("i:" + std::to_string(i)); return true;}
+    bool on_string(std::string_view s) override {events.push_back("s:" + std::string(s)); return true;}
+    bool on_key(std::string_view k) override {events.push_back("k:" + std::string(k)); return true;}
+    bool on_start_object() override {events.push_back("{"); return true;}
+    bool on_end_object() override {events.push_back("}"); return true;}
+    bool on_start_array() override {events.push_back("["); return true;}
+    bool on_end_array() override {events.push_back("]"); return true;}
+};
+
+}
+
+// chunk boundary tests ------------------------------------------------------------
+TEST(JsonIncremental, SingleChunkMatchesParse){
+    EXPECT_EQ(parse_split(kDocument, {}).dump(), json::parse(kDocument).dump());
+}
+TEST(JsonIncremental, EverySplitPointMatchesParse){
+    //covers a boundary inside every string, number, literal and \u escape of the document
+    std::string expected = json::parse(kDocument).dump();
+    for(std::size_t cut = 0; cut <= kDocument.size(); ++cut) {
+        EXPECT_EQ(parse_split(kDocument, {cut}).dump(), expected) << "split at " << cut;
+    }
+}
+TEST(JsonIncremental, EveryPairOfSplitPointsMatchesParse){
+    std::string input = R"(["ab\u00e9c", 12.5e3, true])";
+    std::string expected = json::parse(input).dump();
+    for(std::size_t a = 0; a <= input.size(); ++a) {
+        for(std::size_t b = a; b <= input.size(); ++b) {
+            EXPECT_EQ(parse_split(input, {a, b}).dump(), expected) << "split at " << a << ", " << b;
+        }
+    }
+}
+TEST(JsonIncremental, ByteAtATime){
+    json::IncrementalParser parser;
+    for(char c : kDocument) {
+        parser.feed(std::string_view(&c, 1));
+    }
+    EXPECT_EQ(parser.bytes_consumed(), kDocument.size());
+    EXPECT_EQ(parser.finish().dump(), json::parse(kDocument).dump());
+}
+TEST(JsonIncremental, EmptyChunksAreIgnored){
+    json::IncrementalParser parser;
+    parser.feed("");
+    parser.feed("[1,");
+    parser.feed("");
+    parser.feed("2]");
+    EXPECT_EQ(parser.finish().dump(), "[1,2]");
+}
+TEST(JsonIncremental, TopLevelScalars){
+    EXPECT_EQ(parse_split("42", {1}).as_int64(), 42);
+    EXPECT_DOUBLE_EQ(parse_split("  -2.5e1  ", {4}).as_number(), -25.0);
+    EXPECT_TRUE(parse_split("true", {2}).as_bool());
+    EXPECT_TRUE(parse_split("null", {3}).is_null());
+    EXPECT_EQ(std::string_view(parse_split("\"hi\"", {2}).as_string()), "hi");
+}
+TEST(JsonIncremental, LongStringAcrossManyChunks){
+    std::string body(100000, 'x');
+    body[5000] = '\\';
+    body.insert(5001, "n");
+    std::string input = "\"" + body + "\"";
+    json::IncrementalParser parser;
+    for(std::size_t i = 0; i < input.size(); i += 16384) {
+        parser.feed(std::string_view(input).substr(i, 16384));
+    }
+    EXPECT_EQ(parser.finish().dump(), json::parse(input).dump());
+}
+TEST(JsonIncremental, ChunksOnlyNeedToLiveForTheFeedCall){
+    json::IncrementalParser parser;
+    {
+        std::string chunk = R"({"key": "val)";
+        parser.feed(chunk);
+        chunk.assign(chunk.size(), '#');
+    }
+    {
+        std::string chunk = R"(ue", "n": 12)";
+        parser.feed(chunk);
+        chunk.assign(chunk.size(), '#');
+    }
+    parser.feed("3}");
+    auto doc = parser.finish();
+    EXPECT_EQ(std::string_view(doc["key"].as_string()), "value");
+    EXPECT_EQ(doc["n"].as_int64(), 123);
+}
+TEST(JsonIncremental, AllocatesFromResource){
+    json::Arena arena;
+    json::IncrementalParser parser(arena);
+    parser.feed(R"({"a": ["a string too long for sso",)");
+    parser.feed(R"( 1]})");
+    auto doc = parser.finish();
+    EXPECT_GT(arena.bytes_used(), 0u);
+    EXPECT_EQ(doc["a"].as_array().get_allocator().resource(), &arena);
+}
+
+// error tests ------------------------------------------------------------
+TEST(JsonIncremental, ErrorPositionIsAbsolute){
+    json::IncrementalParser parser;
+    parser.feed("[1, 2, ");
+    try {
+        parser.feed("3, x]");
+        FAIL() << "expected ParseError";
+    } catch(const json::ParseError& e) {
+        EXPECT_EQ(e.position(), 10u);
+    }
+}
+TEST(JsonIncremental, InvalidInputThrows){
+    for(std::string input : {"[1,]", "{\"a\" 1}", "[01]", "tru e", "\"\\x\"", "\"\\u12g4\"", "[1] 2", "{1:2}", "-", "\"a\nb\"", "[\"\\n\t\"]"}) {
+        for(std::size_t cut = 0; cut <= input.size(); ++cut) {
+            json::IncrementalParser parser;
+            EXPECT_THROW({
+                parser.feed(std::string_view(input).substr(0, cut));
+                parser.feed(std::string_view(input).substr(cut));
+                (void)parser.finish();
+            }, json::ParseError) << input << " split at " << cut;
+        }
+    }
+}
+TEST(JsonIncremental, SameErrorsAsParse){
+    auto parse_error = [](const std::string& input) -> std::string {
+        try {
+            (void)json::parse(input);
+        } catch(const json::ParseError& e) {
+            return e.what();
+        }
+        return "";
+    };
+    auto push_error = [](const std::string& input, std::size_t cut) -> std::string {
+        try {
+            json::IncrementalParser parser;
+            parser.feed(std::string_view(input).substr(0, cut));
+            parser.feed(std::string_view(input).substr(cut));
+            (void)parser.finish();
+        } catch(const json::ParseError& e) {
+            return e.what();
+        }
+        return "";
+    };
+    std::vector<std::string> inputs = {
+        //numbers that stop matching part way: parse() takes the number it can and fails on what follows
+        "1.5.5", "[1-2]", "{\"a\": 1.5.5}", "01", "[01]", "-", "-x", "1.", "[1.]", "1e", "1e+", "[1e+]", "1ex", "2-",
+        "[0.5e", "12abc", "--1", "1..2", "[1, 2e3e4]",
+        //literals, also cut off by the end of the input
+        "nul", "[nul", "tr", "fals", "{\"a\": t}", "tru e", "truex", "nulll", "[true false]",
+        //strings cut off in an escape
+        "\"a\\", "[\"ab\\u00", "\"\\u", "\"abc",
+        //structure cut off
+        "", " ", "[", "{", "[1", "[1,", "{\"a\"", "{\"a\":", "{\"a\": 1", "{\"a\": 1,", "[[]", "{\"a\" 1}", "]",
+    };
+    //and every prefix of a document with all kinds of tokens
+    for(std::size_t n = 0; n < kDocument.size(); ++n) inputs.push_back(kDocument.substr(0, n));
+    for(const std::string& input : inputs) {
+        std::string expected = parse_error(input);
+        EXPECT_FALSE(expected.empty()) << input;
+        for(std::size_t cut = 0; cut <= input.size(); ++cut) {
+            EXPECT_EQ(push_error(input, cut), expected) << input << " split at " << cut;
+        }
+    }
+}
+TEST(JsonIncremental, SameDepthLimitAsParse){
+    std::size_t limit = json::ParseOptions::kDefaultMaxDepth;
+    json::IncrementalParser ok;
+    ok.feed(std::string(limit, '['));
+    ok.feed(std::string(limit, ']'));
+    EXPECT_EQ(ok.finish().dump(), json::parse(std::string(limit, '[') + std::string(limit, ']')).dump());
+    json::IncrementalParser deep;
+    try {
+        deep.feed(std::string(limit, '['));
+        deep.feed("[");
+        FAIL() << "expected ParseError";
+    } catch(const json::ParseError& e) {
+        EXPECT_EQ(e.position(), limit);
+    }
+}
+TEST(JsonIncremental, IncompleteInputThrowsAtFinish){
+    for(std::string input : {"", "   ", "[1, 2", "{\"a\":", "\"abc", "\"ab\\u00", "tr", "[1.5e"}) {
+        json::IncrementalParser parser;
+        parser.feed(input);
+        EXPECT_THROW((void)parser.finish(), json::ParseError) << input;
+    }
+}
+TEST(JsonIncremental, FeedAfterFinishOrErrorThrows){
+    json::IncrementalParser done;
+    done.feed("1");
+    (void)done.finish();
+    EXPECT_THROW(done.feed("2"), std::logic_error);
+
+    json::IncrementalParser failed;
+    EXPECT_THROW(failed.feed("]"), json::ParseError);
+    EXPECT_THROW(failed.feed("1"), std::logic_error);
+}
+
+// sax tests ------------------------------------------------------------
+TEST(JsonIncremental, SaxEventsMatchAcrossChunks){
+    Recorder r;
+    json::IncrementalSaxParser parser(r);
+    EXPECT_TRUE(parser.feed(R"({"k\u0065y": [tr)"));
+    EXPECT_TRUE(parser.feed(R"(ue, 1)"));
+    EXPECT_TRUE(parser.feed(R"(0, "v"]})"));
+    EXPECT_TRUE(parser.finish());
+    std::vector<std::string> expected = {"{", "k:key", "[", "true", "i:10", "s:v", "]", "}"};
+    EXPECT_EQ(r.events, expected);
+}
+TEST(JsonIncremental, SaxHandlerCanStopEarly){
+    struct StopAtFirstString : Recorder {
+        bool on_string(std::string_view s) override {Recorder::on_string(s); return false;}
+    } r;
+    json::IncrementalSaxParser parser(r);
+    EXPECT_TRUE(parser.feed("[1, \"st"));
+    EXPECT_FALSE(parser.feed("op\", 2, "));
+    EXPECT_FALSE(parser.feed("garbage that is never looked at"));
+    EXPECT_FALSE(parser.finish());
+    std::vector<std::string> expected = {"[", "i:1", "s:stop"};
+    EXPECT_EQ(r.events, expected);
+}
@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 #include "json_parser/json.hpp"
+#include "json_parser/sax.hpp"
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <string>
 
 // parsing tests -----------------------------------------------------------------
 TEST(JsonParse, Null){
@@ -53,6 +58,67 @@ TEST(JsonParse, ZeroDecimal){
     EXPECT_TRUE(val.is_number());
     EXPECT_NEAR(val.as_number(), 0.5, 0.001);
 }
+TEST(JsonParse, NegativeZero){
+    auto val = json::parse("-0");
+    EXPECT_EQ(val.as_number(), 0.0);
+    EXPECT_TRUE(std::signbit(val.as_number()));
+}
+TEST(JsonParse, LongIntegers){
+    // 15 digits takes the integer fast path, longer ones go through from_chars
+    EXPECT_EQ(json::parse("999999999999999").as_number(), 999999999999999.0);
+    EXPECT_EQ(json::parse("-123456789012345").as_number(), -123456789012345.0);
+    EXPECT_EQ(json::parse("9007199254740992").as_number(), 9007199254740992.0);
+    // 2^53 + 1 is not representable - must round to nearest even like any correct parser
+    EXPECT_EQ(json::parse("9007199254740993").as_number(), 9007199254740992.0);
+    EXPECT_EQ(json::parse("123456789012345678901234567890").as_number(), 1.2345678901234568e29);
+}
+TEST(JsonParse, IntegersAreExact){
+    auto val = json::parse("[0, 42, -17, 1700000000123456789, 9223372036854775807, -9223372036854775808]");
+    EXPECT_EQ(val[0].type(), json::JsonValue::Type::Int64);
+    EXPECT_EQ(val[1].as_int64(), 42);
+    EXPECT_EQ(val[2].as_int64(), -17);
+    EXPECT_EQ(val[3].as_int64(), 1700000000123456789);
+    EXPECT_EQ(val[4].as_int64(), std::numeric_limits<std::int64_t>::max());
+    EXPECT_EQ(val[5].as_int64(), std::numeric_limits<std::int64_t>::min());
+    EXPECT_TRUE(val[3].is_number());
+    EXPECT_TRUE(val[3].is_integer());
+}
+TEST(JsonParse, Unsigned64){
+    auto val = json::parse("18446744073709551615");
+    EXPECT_EQ(val.type(), json::JsonValue::Type::Uint64);
+    EXPECT_EQ(val.as_uint64(), std::numeric_limits<std::uint64_t>::max());
+    EXPECT_THROW((void)val.as_int64(), std::out_of_range);
+    EXPECT_EQ(val.as_number(), 18446744073709551615.0);
+}
+TEST(JsonParse, IntegerOverflowBecomesDouble){
+    auto big = json::parse("18446744073709551616");
+    EXPECT_EQ(big.type(), json::JsonValue::Type::Number);
+    EXPECT_EQ(big.as_number(), 18446744073709551616.0);
+    auto neg = json::parse("-9223372036854775809");
+    EXPECT_EQ(neg.type(), json::JsonValue::Type::Number);
+    EXPECT_FALSE(neg.is_integer());
+}
+TEST(JsonParse, FractionsAreNotIntegers){
+    EXPECT_EQ(json::parse("1.0").type(), json::JsonValue::Type::Number);
+    EXPECT_EQ(json::parse("1e2").type(), json::JsonValue::Type::Number);
+    EXPECT_THROW((void)json::parse("1.5").as_int64(), std::runtime_error);
+    EXPECT_THROW((void)json::parse("-1").as_uint64(), std::out_of_range);
+}
+TEST(JsonParse, CorrectlyRoundedDecimals){
+    EXPECT_EQ(json::parse("0.1").as_number(), 0.1);
+    EXPECT_EQ(json::parse("3.141592653589793").as_number(), 3.141592653589793);
+    EXPECT_EQ(json::parse("1.7976931348623157e308").as_number(), 1.7976931348623157e308);
+    EXPECT_EQ(json::parse("5e-324").as_number(), 5e-324);
+    EXPECT_EQ(json::parse("-2.5E+3").as_number(), -2500.0);
+}
+TEST(JsonParse, NumbersInArray){
+    auto val = json::parse("[0,-1,2.5,1e2,12345678901234567]");
+    EXPECT_EQ(val[0].as_number(), 0.0);
+    EXPECT_EQ(val[1].as_number(), -1.0);
+    EXPECT_EQ(val[2].as_number(), 2.5);
+    EXPECT_EQ(val[3].as_number(), 100.0);
+    EXPECT_EQ(val[4].as_number(), 12345678901234568.0);
+}
 
 TEST(JsonParse, SimpleString){
     auto val = json::parse("\"hello\"");
@@ -140,6 +206,35 @@ TEST(JsonParse, Whiespace){
     EXPECT_EQ(val["a"].as_number(), 1.0);
 }
 
+TEST(JsonParse, FromStringView){
+    std::string_view input = "{\"a\": [1, 2]}";
+    auto val = json::parse(input);
+    EXPECT_EQ(val["a"][1].as_number(), 2.0);
+}
+TEST(JsonParse, FromStdString){
+    std::string input = "[true, false]";
+    auto val = json::parse(input);
+    EXPECT_EQ(val.size(), 2);
+}
+TEST(JsonParse, FromRawBuffer){
+    // buffer is not null terminated and has trailing bytes past the document
+    const char buffer[] = {'[', '1', ',', '2', ']', 'x', 'y'};
+    auto val = json::parse(buffer, 5);
+    EXPECT_EQ(val.size(), 2);
+    EXPECT_EQ(val[1].as_number(), 2.0);
+}
+TEST(JsonParse, FromRawBufferNumberAtEnd){
+    // number runs to the very end of the buffer - must not read past size
+    const char buffer[] = {'1', '2', '3', '4'};
+    auto val = json::parse(buffer, 2);
+    EXPECT_EQ(val.as_number(), 12.0);
+}
+TEST(JsonParse, FromSubView){
+    std::string payload = "HEADER{\"k\": \"v\"}TRAILER";
+    auto val = json::parse(std::string_view(payload).substr(6, 10));
+    EXPECT_EQ(val["k"].as_string(), "v");
+}
+
 // parse error tests -------------------------------------------------------------
 TEST(JsonParse, InvalidLeadingZero){
     EXPECT_THROW(json::parse("007"), json::ParseError);
@@ -151,6 +246,18 @@ TEST(JsonParse, InvalidDecimalNoLeadingDigit){
     EXPECT_THROW(json::parse(".5"), json::ParseError);
 }
 
+TEST(JsonParse, InvalidNumberOutOfRange){
+    EXPECT_THROW(json::parse("1e400"), json::ParseError);
+    EXPECT_THROW(json::parse("[-1e400]"), json::ParseError);
+}
+TEST(JsonParse, InvalidNumberForms){
+    EXPECT_THROW(json::parse("5."), json::ParseError);
+    EXPECT_THROW(json::parse("-"), json::ParseError);
+    EXPECT_THROW(json::parse("1e"), json::ParseError);
+    EXPECT_THROW(json::parse("1e+"), json::ParseError);
+    EXPECT_THROW(json::parse("-.5"), json::ParseError);
+}
+
 TEST(JsonParse, InvalidTrailingCommaArray){
     EXPECT_THROW(json::parse("[1,2,]"), json::ParseError);
 }
@@ -161,6 +268,31 @@ TEST(JsonParse, InvalidTrailingCommaObject){
 TEST(JsonParse, UnterminatedString){
     EXPECT_THROW(json::parse("\"hello"), json::ParseError);
 }
+TEST(JsonParse, ControlCharacterInString){
+    auto error = [](const std::string& input, const json::ParseOptions& options) -> std::string {
+        try {
+            (void)json::parse(input, options);
+        } catch(const json::ParseError& e) {
+            return e.what();
+        }
+        return "";
+    };
+    const json::ParseOptions indexed{json::ParseEngine::StructuralIndex};
+    for(const json::ParseOptions& options : {json::ParseOptions{}, indexed}) {
+        //every raw byte below 0x20, in a plain string, after an escape, in a key and past a block
+        for(int c = 0; c < 0x20; ++c) {
+            std::string raw(1, static_cast<char>(c));
+            SCOPED_TRACE(c);
+            EXPECT_EQ(error("\"a" + raw + "b\"", options), "control character in string at position 2");
+            EXPECT_EQ(error("[\"\\n" + raw + "\"]", options), "control character in string at position 4");
+            EXPECT_EQ(error("{\"k" + raw + "\": 1}", options), "control character in string at position 3");
+            EXPECT_EQ(error("\"" + std::string(70, 'x') + raw + "\"", options), "control character in string at position 71");
+        }
+        //escaped they are fine, and so is DEL
+        EXPECT_EQ(json::parse("\"a\\nb\\u0000\"", options).as_string(), std::string("a\nb\0", 4));
+        EXPECT_EQ(json::parse("\"\x7F\"", options).as_string(), "\x7F");
+    }
+}
 TEST(JsonParse, UnterminatedArray){
     EXPECT_THROW(json::parse("[1,2"), json::ParseError);
 }
@@ -174,6 +306,43 @@ TEST(JsonParse, InvalidToken){
 TEST(JsonParse, TrailingGarbage){
     EXPECT_THROW(json::parse("123abc"), json::ParseError);
 }
+TEST(JsonParse, RawBufferTruncated){
+    const char buffer[] = "[1,2]";
+    EXPECT_THROW(json::parse(buffer, 4), json::ParseError);
+}
+TEST(JsonParse, DefaultMaxDepth){
+    std::size_t limit = json::ParseOptions::kDefaultMaxDepth;
+    std::string ok = std::string(limit, '[') + std::string(limit, ']');
+    EXPECT_NO_THROW(json::parse(ok));
+    std::string deep = std::string(limit + 1, '[') + std::string(limit + 1, ']');
+    try {
+        (void)json::parse(deep);
+        FAIL() << "expected ParseError";
+    } catch(const json::ParseError& e) {
+        EXPECT_EQ(e.position(), limit);
+    }
+}
+TEST(JsonParse, CustomMaxDepth){
+    json::ParseOptions options;
+    options.max_depth = 3;
+    EXPECT_NO_THROW(json::parse(R"({"a": [{"b": 1}, []], "c": {}})", options));
+    EXPECT_THROW(json::parse(R"({"a": [{"b": []}]})", options), json::ParseError);
+    options.max_depth = 0;
+    EXPECT_EQ(json::parse("42", options).as_int64(), 42);
+    EXPECT_THROW(json::parse("[]", options), json::ParseError);
+}
+TEST(JsonParse, DeepNestingDoesNotRecurse){
+    //far deeper than a recursive parser survives on a normal thread stack (nothing is built, a tree
+    //this deep could not be destroyed without recursing either)
+    constexpr std::size_t depth = 2'000'000;
+    std::string deep = std::string(depth, '[') + std::string(depth, ']');
+    json::ParseOptions options;
+    options.max_depth = depth;
+    json::SaxHandler ignore;
+    EXPECT_TRUE(json::parse_sax(deep, ignore, options));
+    options.engine = json::ParseEngine::StructuralIndex;
+    EXPECT_TRUE(json::parse_sax(deep, ignore, options));
+}
 
 // type access tets --------------------------------------------------------------
 /*
@@ -211,6 +380,26 @@ TEST(JsonParse, NumberDump){
     json::JsonValue val(42.0);
     EXPECT_EQ(val.dump(), "42");
 }
+TEST(JsonParse, DoubleDumpShortestRoundTrip){
+    EXPECT_EQ(json::JsonValue(0.1).dump(), "0.1");
+    EXPECT_EQ(json::JsonValue(3.141592653589793).dump(), "3.141592653589793");
+    EXPECT_EQ(json::JsonValue(-2.5).dump(), "-2.5");
+    EXPECT_EQ(json::JsonValue(1e300).dump(), "1e+300");
+    EXPECT_EQ(json::JsonValue(-0.0).dump(), "-0");
+    for(double d : {1.0 / 3.0, 2.2250738585072014e-308, 1.7976931348623157e308, 123456.789e-12}) {
+        EXPECT_EQ(json::parse(json::JsonValue(d).dump()).as_number(), d);
+    }
+}
+TEST(JsonParse, NonFiniteDumpsAsNull){
+    EXPECT_EQ(json::JsonValue(std::numeric_limits<double>::infinity()).dump(), "null");
+    EXPECT_EQ(json::JsonValue(std::numeric_limits<double>::quiet_NaN()).dump(), "null");
+}
+TEST(JsonParse, IntegerDump){
+    EXPECT_EQ(json::JsonValue(std::int64_t{-9223372036854775807 - 1}).dump(), "-9223372036854775808");
+    EXPECT_EQ(json::JsonValue(std::uint64_t{18446744073709551615u}).dump(), "18446744073709551615");
+    std::string ids = "[1700000000123456789,-5,0]";
+    EXPECT_EQ(json::parse(ids).dump(), ids);
+}
 TEST(JsonParse, StringDump){
     json::JsonValue val("hello");
     EXPECT_EQ(val.dump(), "\"hello\"");
@@ -219,6 +408,28 @@ TEST(JsonParse, StringWithEscapesDump){
     json::JsonValue val("line1\nline2");
     EXPECT_EQ(val.dump(), "\"line1\\nline2\"");
 }
+TEST(JsonParse, ControlCharactersDump){
+    json::JsonValue val(std::string("a\b\f\x01\x1f\x7f\"\\/", 9));
+    EXPECT_EQ(val.dump(), R"("a\b\f\u0001\u001f)" "\x7f" R"(\"\\/")");
+    EXPECT_EQ(json::parse(val.dump()).as_string(), val.as_string());
+}
+TEST(JsonParse, KeysEscapedDump){
+    json::JsonObject obj;
+    obj.insert_or_assign("say \"hi\"\n", json::JsonValue(1));
+    EXPECT_EQ(json::JsonValue(std::move(obj)).dump(), R"({"say \"hi\"\n":1})");
+}
+TEST(JsonParse, EscapeAtEveryOffsetDump){
+    //every escape at every position of a long string, so both the vector blocks and the tail see it
+    for(char c : {'"', '\\', '\n', '\x00', '\x1f'}) {
+        for(std::size_t at = 0; at < 70; ++at) {
+            std::string s(70, 'x');
+            s[at] = c;
+            s += "caf\xC3\xA9";
+            json::JsonValue val(s);
+            ASSERT_EQ(std::string_view(json::parse(val.dump()).as_string()), s) << "offset " << at;
+        }
+    }
+}
 TEST(JsonParse, EmptyArrayDump){
     json::JsonValue val(json::JsonArray{});
     EXPECT_EQ(val.dump(), "[]");
@@ -243,6 +454,16 @@ TEST(JsonParse, ConstructFromInt){
     EXPECT_TRUE(val.is_number());
     EXPECT_EQ(val.as_number(), 42.0);
 }
+TEST(JsonParse, ConstructFromIntegerTypes){
+    EXPECT_EQ(json::JsonValue(42).type(), json::JsonValue::Type::Int64);
+    EXPECT_EQ(json::JsonValue(42L).as_int64(), 42);
+    EXPECT_EQ(json::JsonValue(42LL).as_int64(), 42);
+    EXPECT_EQ(json::JsonValue(static_cast<short>(-3)).as_int64(), -3);
+    EXPECT_EQ(json::JsonValue(42u).type(), json::JsonValue::Type::Uint64);
+    EXPECT_EQ(json::JsonValue(42ull).as_uint64(), 42u);
+    EXPECT_EQ(json::JsonValue(42u).as_int64(), 42);
+    EXPECT_TRUE(json::JsonValue(true).is_bool());
+}
 TEST(JsonParse, ConstructFromString){
     json::JsonValue val("hello");
     EXPECT_TRUE(val.is_string());
@@ -259,3 +480,467 @@ TEST(JsonParse, MutableObjectAccess){
     EXPECT_EQ(val["b"].as_number(), 2.0);
 }
 
+
+// scanning tests ----------------------------------------------------------------
+/*
+    whitespace & string scanning work in 16/32 byte blocks with a scalar tail,
+    so these sweep run lengths across several block sizes to hit every split.
+*/
+TEST(JsonScan, WhitespaceRunsOfEveryLength){
+    const std::string ws = " \t\n\r";
+    for(std::size_t len = 0; len < 80; ++len) {
+        std::string pad;
+        for(std::size_t i = 0; i < len; ++i) pad += ws[i % ws.size()];
+        auto val = json::parse(pad + "[" + pad + "1" + pad + "," + pad + "2" + pad + "]" + pad);
+        ASSERT_EQ(val.size(), 2u) << "len " << len;
+        EXPECT_EQ(val[1].as_number(), 2.0);
+    }
+}
+TEST(JsonScan, ErrorPositionAfterLongWhitespace){
+    std::string input(70, ' ');
+    input += "x";
+    try {
+        (void)json::parse(input);
+        FAIL() << "expected ParseError";
+    } catch(const json::ParseError& e) {
+        EXPECT_EQ(e.position(), 70u);
+    }
+}
+TEST(JsonScan, OnlyJsonWhitespace){
+    // \v and \f are std::isspace but not json whitespace
+    EXPECT_THROW(json::parse("\v1"), json::ParseError);
+    EXPECT_THROW(json::parse("1\f"), json::ParseError);
+}
+TEST(JsonScan, LongStrings){
+    for(std::size_t len = 0; len < 80; ++len) {
+        std::string body;
+        for(std::size_t i = 0; i < len; ++i) body += static_cast<char>('a' + i % 26);
+        auto val = json::parse("\"" + body + "\"");
+        ASSERT_EQ(std::string_view(val.as_string()), body) << "len " << len;
+    }
+}
+TEST(JsonScan, EscapeAtEveryOffset){
+    for(std::size_t at = 0; at < 70; ++at) {
+        // escaped quote at offset 'at', escaped backslash at the end
+        std::string encoded = "\"";
+        encoded.append(at, 'x').append("\\\"").append(70 - at, 'x').append("\\\\\"");
+        std::string expected(at, 'x');
+        expected.append("\"").append(70 - at, 'x').append("\\");
+        ASSERT_EQ(std::string_view(json::parse(encoded).as_string()), expected) << "offset " << at;
+    }
+}
+TEST(JsonScan, LongUnterminatedString){
+    EXPECT_THROW(json::parse("\"" + std::string(100, 'a')), json::ParseError);
+    EXPECT_THROW(json::parse("\"" + std::string(100, 'a') + "\\"), json::ParseError);
+}
+TEST(JsonScan, NonAsciiBytesPassThrough){
+    auto val = json::parse("\"caf\xC3\xA9 \xE2\x82\xAC and a long enough tail to use the block scanner\"");
+    EXPECT_EQ(val.as_string(), "caf\xC3\xA9 \xE2\x82\xAC and a long enough tail to use the block scanner");
+}
+
+// layout tests ------------------------------------------------------------------
+TEST(JsonLayout, CompactNode){
+    EXPECT_LE(sizeof(json::JsonValue), 16u);
+}
+TEST(JsonLayout, TypeTag){
+    EXPECT_EQ(json::parse("null").type(), json::JsonValue::Type::Null);
+    EXPECT_EQ(json::parse("true").type(), json::JsonValue::Type::Bool);
+    EXPECT_EQ(json::parse("1.5").type(), json::JsonValue::Type::Number);
+    EXPECT_EQ(json::parse("\"s\"").type(), json::JsonValue::Type::String);
+    EXPECT_EQ(json::parse("[]").type(), json::JsonValue::Type::Array);
+    EXPECT_EQ(json::parse("{}").type(), json::JsonValue::Type::Object);
+}
+TEST(JsonLayout, MoveLeavesNull){
+    json::JsonValue a(json::JsonArray{1, 2});
+    json::JsonValue b(std::move(a));
+    EXPECT_TRUE(a.is_null());
+    EXPECT_EQ(b.size(), 2);
+    json::JsonValue c("text");
+    c = std::move(b);
+    EXPECT_TRUE(b.is_null());
+    EXPECT_EQ(c[1].as_number(), 2.0);
+}
+TEST(JsonLayout, CopyIsDeep){
+    auto a = json::parse(R"({"list": [1, "two", {"three": 3}]})");
+    json::JsonValue b = a;
+    b["list"][2]["three"] = 4;
+    b["list"].as_array().push_back(5);
+    EXPECT_EQ(a["list"][2]["three"].as_number(), 3.0);
+    EXPECT_EQ(a["list"].size(), 3);
+    EXPECT_EQ(b["list"].size(), 4);
+}
+TEST(JsonLayout, SelfAssignment){
+    json::JsonValue a(json::JsonArray{"x", "y"});
+    auto& ref = a;
+    a = ref;
+    a = std::move(ref);
+    EXPECT_EQ(a.size(), 2);
+    EXPECT_EQ(a[1].as_string(), "y");
+}
+TEST(JsonLayout, MoveChildIntoParent){
+    //the moved-from value lives inside the tree the assignment frees
+    auto v = json::parse(R"({"data": {"items": [1, "a string too long to be small"]}, "other": [true]})");
+    v = std::move(v["data"]);
+    EXPECT_EQ(v.dump(), R"({"items":[1,"a string too long to be small"]})");
+    v = std::move(v["items"]);
+    v = std::move(v[1]);
+    EXPECT_EQ(v.as_string(), "a string too long to be small");
+
+    auto a = json::parse(R"([[{"k": "v"}, 2], 3])");
+    a = std::move(a[0]);
+    a = std::move(a[0]);
+    EXPECT_EQ(a.dump(), R"({"k":"v"})");
+    a = a["k"];
+    EXPECT_EQ(a.as_string(), "v");
+}
+TEST(JsonLayout, ReassignAcrossTypes){
+    json::JsonValue v(json::JsonObject{{"k", "v"}});
+    v = 3.5;
+    EXPECT_EQ(v.as_number(), 3.5);
+    v = "str";
+    EXPECT_EQ(v.as_string(), "str");
+    v = json::JsonArray{true};
+    EXPECT_TRUE(v[0].as_bool());
+    v = nullptr;
+    EXPECT_TRUE(v.is_null());
+}
+
+// arena tests -------------------------------------------------------------------
+/*
+    note: swapping the default resource for null_memory_resource makes any allocation that escapes
+    the arena throw std::bad_alloc, so these tests catch strings/containers that miss the resource.
+*/
+struct NoDefaultResource {
+    std::pmr::memory_resource* prev;
+    NoDefaultResource() : prev(std::pmr::set_default_resource(std::pmr::null_memory_resource())) {}
+    ~NoDefaultResource() {std::pmr::set_default_resource(prev);}
+};
+
+TEST(JsonArena, ParseIntoArena){
+    json::Arena arena(64, std::pmr::new_delete_resource());
+    const std::string input = R"({"name": "a string longer than the small string buffer", "list": [1, [2, 3], {"k": "v"}]})";
+    NoDefaultResource guard;
+    auto val = json::parse(input, arena);
+    EXPECT_EQ(val["name"].as_string(), "a string longer than the small string buffer");
+    EXPECT_EQ(val["list"][1][1].as_number(), 3.0);
+    EXPECT_EQ(val["list"][2]["k"].as_string(), "v");
+    EXPECT_GT(arena.bytes_used(), 0u);
+    EXPECT_GT(arena.block_count(), 1u);
+}
+TEST(JsonArena, TreeUsesArenaResource){
+    json::Arena arena;
+    auto val = json::parse(R"({"a": ["x", "a string longer than the small string buffer"]})", arena);
+    EXPECT_EQ(val.as_object().get_allocator().resource(), &arena);
+    EXPECT_EQ(val["a"].as_array().get_allocator().resource(), &arena);
+    //strings are views now - a long one has to have been allocated from the arena
+    std::size_t used = arena.bytes_used();
+    auto more = json::parse(R"(["a string longer than the small string buffer"])", arena);
+    EXPECT_GE(arena.bytes_used() - used, std::string_view("a string longer than the small string buffer").size());
+}
+TEST(JsonArena, CopyOutlivesArena){
+    json::JsonValue copy;
+    {
+        json::Arena arena;
+        auto val = json::parse(R"({"a": ["a string longer than the small string buffer"]})", arena);
+        copy = val;
+    }
+    EXPECT_EQ(copy["a"][0].as_string(), "a string longer than the small string buffer");
+    EXPECT_EQ(copy.as_object().get_allocator().resource(), std::pmr::get_default_resource());
+}
+TEST(JsonArena, MixHeapValueIntoArenaTree){
+    json::Arena arena;
+    auto val = json::parse("[1, 2]", arena);
+    val.as_array().push_back(json::JsonValue(json::JsonArray{"heap", "values"}));
+    EXPECT_EQ(val[2][1].as_string(), "values");
+}
+TEST(JsonArena, ReleaseResetsArena){
+    json::Arena arena;
+    {
+        auto val = json::parse("[\"a string longer than the small string buffer\"]", arena);
+    }
+    arena.release();
+    EXPECT_EQ(arena.bytes_used(), 0u);
+    EXPECT_EQ(arena.block_count(), 0u);
+    auto val = json::parse("[true]", arena);
+    EXPECT_TRUE(val[0].as_bool());
+}
+TEST(JsonArena, ResetKeepsTheLargestBlock){
+    json::Arena arena(64);
+    for(int i = 0; i < 200; ++i) (void)arena.allocate(100, 8);
+    ASSERT_GT(arena.block_count(), 1u);
+    arena.reset();
+    EXPECT_EQ(arena.bytes_used(), 0u);
+    EXPECT_EQ(arena.block_count(), 1u);
+    //the same amount again mostly fits in the kept block
+    for(int i = 0; i < 100; ++i) (void)arena.allocate(100, 8);
+    EXPECT_EQ(arena.block_count(), 1u);
+    EXPECT_EQ(arena.bytes_used(), 10000u);
+}
+TEST(JsonArena, ParseErrorInArena){
+    json::Arena arena;
+    EXPECT_THROW(json::parse("[1, 2", arena), json::ParseError);
+}
+
+// object tests ------------------------------------------------------------------
+namespace {
+//{"k0": 0, "k1": 1, ...}
+std::string numbered_object(int n) {
+    std::string s = "{";
+    for(int i = 0; i < n; ++i) {
+        if(i) s += ",";
+        s += "\"k" + std::to_string(i) + "\":" + std::to_string(i);
+    }
+    return s + "}";
+}
+}
+
+TEST(JsonObject, DumpKeepsDocumentOrder){
+    const std::string input = R"({"z":1,"a":2,"m":{"y":true,"b":null},"c":[]})";
+    EXPECT_EQ(json::parse(input).dump(), input);
+}
+TEST(JsonObject, InsertionOrderAfterEdits){
+    json::JsonValue val(json::JsonObject{{"b", 1}, {"a", 2}});
+    val["c"] = 3;
+    val["b"] = 4;  //overwrite keeps the position
+    EXPECT_EQ(val.dump(), R"({"b":4,"a":2,"c":3})");
+}
+TEST(JsonObject, DuplicateKeyLastWinsAtFirstPosition){
+    auto val = json::parse(R"({"a": 1, "b": 2, "a": 3})");
+    EXPECT_EQ(val.as_object().size(), 2u);
+    EXPECT_EQ(val.dump(), R"({"a":3,"b":2})");
+}
+TEST(JsonObject, LookupAcrossIndexThreshold){
+    //below, at and well above the size where the hash index takes over
+    for(int n : {1, 15, 16, 17, 40, 1000}) {
+        auto val = json::parse(numbered_object(n));
+        const auto& obj = val.as_object();
+        ASSERT_EQ(obj.size(), static_cast<std::size_t>(n));
+        for(int i = 0; i < n; ++i) {
+            EXPECT_EQ(obj.at("k" + std::to_string(i)).as_int64(), i) << n;
+        }
+        EXPECT_FALSE(obj.contains("missing"));
+        EXPECT_EQ(val.dump(), numbered_object(n));
+    }
+}
+TEST(JsonObject, GrowsPastThresholdByInsert){
+    json::JsonObject obj;
+    for(int i = 0; i < 100; ++i) {
+        auto [it, inserted] = obj.insert_or_assign(json::JsonString("k" + std::to_string(i)), i);
+        EXPECT_TRUE(inserted);
+        EXPECT_EQ(it->second.as_int64(), i);
+    }
+    for(int i = 0; i < 100; ++i) EXPECT_EQ(obj.at("k" + std::to_string(i)).as_int64(), i);
+    EXPECT_FALSE(obj.emplace("k5", 0).second);
+    EXPECT_EQ(obj.at("k5").as_int64(), 5);
+}
+TEST(JsonObject, Erase){
+    for(int n : {5, 40}) {
+        auto val = json::parse(numbered_object(n));
+        auto& obj = val.as_object();
+        EXPECT_EQ(obj.erase("k3"), 1u);
+        EXPECT_EQ(obj.erase("k3"), 0u);
+        EXPECT_FALSE(obj.contains("k3"));
+        EXPECT_EQ(obj.size(), static_cast<std::size_t>(n - 1));
+        //the members after it moved down, lookups must still find them
+        for(int i = 4; i < n; ++i) EXPECT_EQ(obj.at("k" + std::to_string(i)).as_int64(), i);
+        auto next = obj.erase(obj.begin());
+        EXPECT_EQ(next->first, "k1");
+    }
+}
+TEST(JsonObject, MissingKey){
+    auto val = json::parse(R"({"a": 1})");
+    const auto& cval = val;
+    EXPECT_THROW((void)cval["b"], std::out_of_range);
+    EXPECT_EQ(val.as_object().find("b"), val.as_object().end());
+    EXPECT_TRUE(val["b"].is_null());  //non-const operator[] inserts
+    EXPECT_EQ(val.as_object().size(), 2u);
+}
+TEST(JsonObject, FindReturnsAPointer){
+    auto val = json::parse(R"({"a": 1, "n": null})");
+    const auto& cval = val;
+    ASSERT_NE(cval.find("a"), nullptr);
+    EXPECT_EQ(cval.find("a")->as_int64(), 1);
+    EXPECT_TRUE(cval.find("n")->is_null());  //present but null is not missing
+    EXPECT_EQ(cval.find("b"), nullptr);
+    //on a non object too, instead of throwing
+    EXPECT_EQ(json::JsonValue(1).find("a"), nullptr);
+    EXPECT_EQ(json::parse("[1]").find("a"), nullptr);
+    *val.find("a") = 2;
+    EXPECT_EQ(val["a"].as_int64(), 2);
+    EXPECT_EQ(val.as_object().size(), 2u);  //nothing inserted
+}
+TEST(JsonObject, LookupWithKey){
+    static const json::Key k7("k7");
+    static const json::Key kMissing("missing");
+    for(int n : {8, 16, 40}) {
+        auto val = json::parse(numbered_object(n));
+        const auto& cval = val;
+        SCOPED_TRACE(n);
+        EXPECT_EQ(k7.hash(), std::hash<std::string_view>{}("k7"));
+        EXPECT_EQ(cval[k7].as_int64(), 7);
+        EXPECT_EQ(cval.find(k7)->as_int64(), 7);
+        EXPECT_EQ(cval.find(kMissing), nullptr);
+        EXPECT_TRUE(cval.as_object().contains(k7));
+        EXPECT_EQ(cval.as_object().at(k7).as_int64(), 7);
+        EXPECT_THROW((void)cval[kMissing], std::out_of_range);
+        EXPECT_EQ(val.as_object().find(kMissing), val.as_object().end());
+        //mutable [] inserts, like with a string_view
+        val[kMissing] = 1;
+        EXPECT_EQ(val.as_object().size(), static_cast<std::size_t>(n + 1));
+        EXPECT_EQ(cval.find(kMissing)->as_int64(), 1);
+    }
+}
+TEST(JsonValue, DeepEquality){
+    EXPECT_TRUE(json::parse(R"({"a": [1, 2.5, "x", null, true], "b": {"c": {}}})") == json::parse(R"({"b": {"c": {}}, "a": [1, 2.5, "x", null, true]})"));
+    EXPECT_FALSE(json::parse(R"({"a": 1})") == json::parse(R"({"a": 1, "b": 2})"));
+    EXPECT_FALSE(json::parse("[1, 2]") == json::parse("[2, 1]"));
+    EXPECT_FALSE(json::parse("0") == json::parse("false"));
+    EXPECT_FALSE(json::parse("null") == json::parse("{}"));
+    //numbers by value, whatever their type
+    EXPECT_TRUE(json::JsonValue(1) == json::JsonValue(1.0));
+    EXPECT_TRUE(json::JsonValue(5) == json::JsonValue(5u));
+    EXPECT_FALSE(json::JsonValue(-1) == json::JsonValue(static_cast<std::uint64_t>(-1)));
+    EXPECT_TRUE(json::parse("18446744073709551615") == json::JsonValue(UINT64_MAX));
+    //shared and owned, long and small strings
+    json::JsonValue big = json::parse(numbered_object(40));
+    json::JsonValue shared = json::JsonValue(big).share();
+    EXPECT_TRUE(shared == big);
+    EXPECT_TRUE(json::JsonValue("a string that is not small") == json::JsonValue::borrowed("a string that is not small"));
+}
+TEST(JsonObject, LargeObjectInArena){
+    json::Arena arena;
+    const std::string input = numbered_object(100);
+    NoDefaultResource guard;
+    auto val = json::parse(input, arena);
+    EXPECT_EQ(val["k99"].as_int64(), 99);
+}
+TEST(JsonObject, LongKeys){
+    //keys over JsonKey::kInlineCapacity are allocated, shorter ones are stored in the key
+    const std::string long_key(40, 'x');
+    const std::string input = R"({")" + long_key + R"(": 1, "short": 2, "exactly_15_char": 3, "exactly_16_chars": 4})";
+    json::JsonValue copy;
+    {
+        json::Arena arena;
+        auto val = [&] {
+            NoDefaultResource guard;
+            return json::parse(input, arena);
+        }();
+        EXPECT_EQ(val[long_key].as_int64(), 1);
+        EXPECT_EQ(val["exactly_15_char"].as_int64(), 3);
+        EXPECT_EQ(val["exactly_16_chars"].as_int64(), 4);
+        EXPECT_EQ(val.dump(), json::parse(input).dump());
+        copy = val;
+    }
+    //the copy owns its keys, the arena is gone
+    EXPECT_EQ(copy.as_object().begin()->first, long_key);
+    EXPECT_EQ(copy[long_key].as_int64(), 1);
+}
+TEST(JsonObject, MoveAcrossResources){
+    json::Arena arena;
+    json::JsonObject heap{{std::string(30, 'a'), 1}, {"b", json::JsonArray{1, 2}}};
+    json::JsonObject in_arena(std::move(heap), json::JsonObject::allocator_type(&arena));
+    EXPECT_EQ(in_arena.get_allocator().resource(), &arena);
+    EXPECT_EQ(in_arena.at(std::string(30, 'a')).as_int64(), 1);
+    json::JsonObject back;
+    back = std::move(in_arena);
+    EXPECT_EQ(back.get_allocator().resource(), std::pmr::get_default_resource());
+    EXPECT_EQ(back.at("b")[1].as_int64(), 2);
+    const auto& self = back;
+    back = self;
+    EXPECT_EQ(back.size(), 2u);
+    back.clear();
+    EXPECT_TRUE(back.empty());
+}
+
+// string storage tests ----------------------------------------------------------
+namespace {
+//counts allocations that reach it (forwards to new/delete)
+struct CountingResource : std::pmr::memory_resource {
+    std::size_t allocations = 0;
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this == &other;}
+};
+
+bool points_into(std::string_view s, std::string_view buffer) {
+    std::less_equal<const char*> le;
+    return le(buffer.data(), s.data()) && le(s.data() + s.size(), buffer.data() + buffer.size());
+}
+
+json::ParseOptions in_situ() {
+    json::ParseOptions options;
+    options.in_situ_strings = true;
+    return options;
+}
+}
+
+TEST(JsonString, SmallStringsDoNotAllocate){
+    //up to kSmallString bytes the string lives in the value - a resource that cannot allocate is fine
+    for(std::string_view s : {"", "a", "12345678"}) {
+        auto val = json::parse("\"" + std::string(s) + "\"", *std::pmr::null_memory_resource());
+        EXPECT_EQ(val.as_string(), s);
+    }
+    EXPECT_THROW(json::parse(R"("123456789")", *std::pmr::null_memory_resource()), std::bad_alloc);
+    EXPECT_EQ(json::parse(R"("123456789")").as_string(), "123456789");
+}
+TEST(JsonString, ConstructAndCopyEveryKind){
+    json::JsonValue small("abc");
+    json::JsonValue owned(std::string(100, 'x'));
+    json::JsonValue pmr(json::JsonString("from a pmr string, not a short one"));
+    std::string buffer = "a borrowed string, also not short";
+    auto borrowed = json::JsonValue::borrowed(buffer);
+    EXPECT_EQ(borrowed.as_string().data(), buffer.data());
+    for(const auto* v : {&small, &owned, &pmr, &borrowed}) {
+        json::JsonValue copy(*v);
+        EXPECT_EQ(copy.as_string(), v->as_string());
+        json::JsonValue moved(std::move(copy));
+        EXPECT_EQ(moved.as_string(), v->as_string());
+        EXPECT_TRUE(copy.is_null());
+    }
+    //the copy of a borrowed string owns its characters
+    json::JsonValue copy = borrowed;
+    buffer.assign(buffer.size(), '-');
+    EXPECT_EQ(copy.as_string(), "a borrowed string, also not short");
+}
+TEST(JsonString, InSituPointsIntoInput){
+    const std::string input = R"({"plain": "no escapes in this one", "escaped": "tab\there and é", "short": "ok"})";
+    for(auto engine : {json::ParseEngine::RecursiveDescent, json::ParseEngine::StructuralIndex}) {
+        auto options = in_situ();
+        options.engine = engine;
+        auto val = json::parse(input, options);
+        EXPECT_TRUE(points_into(val["plain"].as_string(), input));
+        EXPECT_EQ(val["plain"].as_string(), "no escapes in this one");
+        //escapes have to be decoded, so that one is a copy
+        EXPECT_FALSE(points_into(val["escaped"].as_string(), input));
+        EXPECT_EQ(val["escaped"].as_string(), "tab\there and \xC3\xA9");
+        EXPECT_EQ(val["short"].as_string(), "ok");
+        EXPECT_EQ(val.dump(), json::parse(input).dump());
+    }
+}
+TEST(JsonString, InSituCopyOutlivesInput){
+    json::JsonValue copy;
+    {
+        std::string input = R"(["a string longer than the small string buffer"])";
+        auto val = json::parse(input, in_situ());
+        copy = val;
+        input.assign(input.size(), ' ');
+    }
+    EXPECT_EQ(copy[0].as_string(), "a string longer than the small string buffer");
+}
+TEST(JsonString, InSituHalvesAllocations){
+    std::string input = "[";
+    for(int i = 0; i < 100; ++i) input += (i ? ",\"" : "\"") + std::string("string value number ") + std::to_string(i) + "\"";
+    input += "]";
+    CountingResource copied, borrowed;
+    auto a = json::parse(input, copied, json::ParseOptions{});
+    auto b = json::parse(input, borrowed, in_situ());
+    EXPECT_EQ(a.dump(), b.dump());
+    //a copied string is a node + its characters. borrowing leaves only the array (storage + node)
+    EXPECT_EQ(copied.allocations, 202u);
+    EXPECT_EQ(borrowed.allocations, 2u);
+}
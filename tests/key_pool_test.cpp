@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "json_parser/key_pool.hpp"
+#include "json_parser/ndjson.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+//keys longer than JsonKey::kInlineCapacity are pooled, "ok" is short enough to stay inline
+const std::string kMessage = R"({"event_timestamp_ms": 1700000000, "originating_user_id": "u1", "ok": true, )"
+                             R"("nested_records_list": [1, {"originating_user_id": 2}]})";
+
+json::ParseOptions with_pool(json::KeyPool& pool) {
+    json::ParseOptions options;
+    options.key_pool = &pool;
+    return options;
+}
+
+}
+
+TEST(JsonKeyPool, InternReturnsOneCopy){
+    json::KeyPool pool;
+    auto a = pool.intern("timestamp");
+    auto b = pool.intern(std::string("times") + "tamp");
+    EXPECT_TRUE(a.is_pooled());
+    EXPECT_EQ(a.data(), b.data());
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a, "timestamp");
+    EXPECT_EQ(a.hash(), std::hash<std::string_view>{}("timestamp"));
+    EXPECT_NE(pool.intern("other").data(), a.data());
+    EXPECT_EQ(pool.size(), 2u);
+    EXPECT_EQ(pool.intern("").size(), 0u);
+    EXPECT_EQ(pool.size(), 3u);
+}
+TEST(JsonKeyPool, DocumentsShareKeys){
+    json::KeyPool pool;
+    auto first = json::parse(kMessage, with_pool(pool));
+    auto second = json::parse(kMessage, with_pool(pool));
+    auto it1 = first.as_object().begin();
+    auto it2 = second.as_object().begin();
+    for(; it1 != first.as_object().end(); ++it1, ++it2) {
+        bool long_key = it1->first.size() > json::JsonKey::kInlineCapacity;
+        EXPECT_EQ(it1->first.is_pooled(), long_key) << it1->first.view();
+        if(long_key) {
+            EXPECT_EQ(it1->first.data(), it2->first.data());
+        }
+    }
+    //the nested key is the same pooled string as the outer one
+    EXPECT_EQ(first["nested_records_list"][1].as_object().begin()->first.data(),
+              pool.intern("originating_user_id").data());
+    EXPECT_EQ(pool.size(), 3u);
+    EXPECT_EQ(first.dump(), json::parse(kMessage).dump());
+}
+TEST(JsonKeyPool, LookupWithPooledKey){
+    json::KeyPool pool;
+    static const std::string many = [] {
+        std::string s = "{";
+        for(int i = 0; i < 40; ++i) s += (i ? ",\"field" : "\"field") + std::to_string(i) + "\":" + std::to_string(i);
+        return s + "}";
+    }();
+    for(const std::string* input : {&kMessage, &many}) {
+        auto val = json::parse(*input, with_pool(pool));
+        auto key = pool.intern(input == &kMessage ? "originating_user_id" : "field31");
+        auto it = val.as_object().find(key);
+        ASSERT_NE(it, val.as_object().end());
+        EXPECT_EQ(it->first, key);
+        EXPECT_TRUE(val.as_object().contains(key));
+        EXPECT_FALSE(val.as_object().contains(pool.intern("missing")));
+    }
+    //pooled keys also find members whose keys are not pooled
+    auto plain = json::parse(kMessage);
+    EXPECT_TRUE(plain.as_object().contains(pool.intern("event_timestamp_ms")));
+    EXPECT_TRUE(plain.as_object().contains(pool.intern("ok")));
+}
+TEST(JsonKeyPool, InsertPooledKey){
+    json::KeyPool pool;
+    json::JsonObject obj;
+    auto key = pool.intern("a_key_longer_than_inline_storage");
+    EXPECT_TRUE(obj.insert_or_assign(key, 1).second);
+    EXPECT_FALSE(obj.insert_or_assign(key, 2).second);
+    EXPECT_EQ(obj.begin()->first.data(), key.data());
+    EXPECT_EQ(obj.at("a_key_longer_than_inline_storage").as_int64(), 2);
+    //copies share the pooled key
+    json::JsonObject copy(obj);
+    EXPECT_EQ(copy.begin()->first.data(), key.data());
+}
+TEST(JsonKeyPool, BothEngines){
+    json::KeyPool pool;
+    auto options = with_pool(pool);
+    options.engine = json::ParseEngine::StructuralIndex;
+    auto indexed = json::parse(kMessage, options);
+    EXPECT_EQ(indexed.as_object().begin()->first.data(), pool.intern("event_timestamp_ms").data());
+    EXPECT_EQ(indexed.dump(), json::parse(kMessage).dump());
+}
+TEST(JsonKeyPool, ArenaDocument){
+    json::KeyPool pool;
+    json::Arena arena;
+    auto val = json::parse(kMessage, arena, with_pool(pool));
+    EXPECT_EQ(val["originating_user_id"].as_string(), "u1");
+    EXPECT_EQ(val.as_object().get_allocator().resource(), &arena);
+}
+TEST(JsonKeyPool, Ndjson){
+    json::KeyPool pool;
+    std::string lines;
+    for(int i = 0; i < 1000; ++i) lines += kMessage + "\n";
+    json::NdjsonOptions options;
+    options.threads = 4;
+    options.batch_bytes = 4096;
+    options.key_pool = &pool;
+    auto records = json::parse_ndjson(lines, options);
+    ASSERT_EQ(records.size(), 1000u);
+    EXPECT_EQ(records.front().as_object().begin()->first.data(), records.back().as_object().begin()->first.data());
+    EXPECT_EQ(pool.size(), 3u);
+}
+TEST(JsonKeyPool, ConcurrentParsers){
+    json::KeyPool pool;
+    constexpr int kThreads = 4;
+    std::vector<std::thread> threads;
+    std::vector<const char*> seen(kThreads);
+    for(int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for(int i = 0; i < 200; ++i) {
+                //mix of keys shared by every thread and keys only this thread creates
+                std::string input = R"({"shared_by_all_threads": 1, "only_in_thread_)" + std::to_string(t) + "_" + std::to_string(i) + R"(": 2})";
+                auto val = json::parse(input, with_pool(pool));
+                seen[t] = val.as_object().begin()->first.data();
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+    for(const char* p : seen) EXPECT_EQ(p, pool.intern("shared_by_all_threads").data());
+    EXPECT_EQ(pool.size(), 1u + kThreads * 200);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "json_parser/ndjson.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+//n records: {"id": i, "name": "record i"}
+std::string make_lines(std::size_t n) {
+    std::string out;
+    for(std::size_t i = 0; i < n; ++i) {
+        out.append("{\"id\": ").append(std::to_string(i)).append(", \"name\": \"record ").append(std::to_string(i)).append("\"}\n");
+    }
+    return out;
+}
+
+}
+
+TEST(JsonNdjson, ParsesEveryLineInOrder){
+    auto records = json::parse_ndjson("{\"a\": 1}\n[1, 2]\n\"s\"\n42");
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[0]["a"].as_int64(), 1);
+    EXPECT_EQ(records[1].size(), 2u);
+    EXPECT_EQ(std::string_view(records[2].as_string()), "s");
+    EXPECT_EQ(records[3].as_int64(), 42);
+}
+TEST(JsonNdjson, SkipsBlankLinesAndHandlesCrlf){
+    std::vector<std::size_t> lines;
+    std::size_t count = json::parse_ndjson("1\r\n\r\n   \n2\r\n\n", [&](json::JsonValue&& v, std::size_t line) {
+        EXPECT_EQ(v.type(), json::JsonValue::Type::Int64);
+        lines.push_back(line);
+        return true;
+    });
+    EXPECT_EQ(count, 2u);
+    EXPECT_EQ(lines, (std::vector<std::size_t>{1, 4}));
+}
+TEST(JsonNdjson, EmptyInput){
+    EXPECT_TRUE(json::parse_ndjson("").empty());
+    EXPECT_TRUE(json::parse_ndjson("\n\n").empty());
+}
+TEST(JsonNdjson, ParallelResultsAreInOrder){
+    std::string input = make_lines(20000);
+    for(unsigned threads : {1u, 2u, 8u}) {
+        //small batches so the work really is spread over many tasks
+        json::NdjsonOptions options{threads, 1024};
+        std::size_t expected = 0;
+        std::size_t count = json::parse_ndjson(input, [&](json::JsonValue&& v, std::size_t line) {
+            EXPECT_EQ(v["id"].as_int64(), static_cast<std::int64_t>(expected));
+            EXPECT_EQ(line, expected + 1);
+            ++expected;
+            return true;
+        }, options);
+        EXPECT_EQ(count, 20000u) << threads << " threads";
+    }
+}
+TEST(JsonNdjson, CallbackCanStop){
+    std::string input = make_lines(5000);
+    std::size_t seen = 0;
+    std::size_t count = json::parse_ndjson(input, [&](json::JsonValue&&, std::size_t) {
+        return ++seen < 10;
+    }, json::NdjsonOptions{4, 256});
+    EXPECT_EQ(count, 10u);
+    EXPECT_EQ(seen, 10u);
+}
+TEST(JsonNdjson, ErrorReportsLineAndPositions){
+    std::string input = make_lines(3000);
+    std::size_t line_start = input.size();
+    input += "{\"id\": 3000, \"bad\": tru}\n";
+    input += make_lines(10);
+    for(unsigned threads : {1u, 4u}) {
+        std::size_t delivered = 0;
+        try {
+            json::parse_ndjson(input, [&](json::JsonValue&&, std::size_t) {++delivered; return true;},
+                               json::NdjsonOptions{threads, 512});
+            FAIL() << "expected NdjsonError";
+        } catch(const json::NdjsonError& e) {
+            EXPECT_EQ(e.line(), 3001u);
+            EXPECT_EQ(e.column(), 20u);
+            EXPECT_EQ(e.position(), line_start + 20);
+            EXPECT_EQ(std::string(e.what()).rfind("line 3001: ", 0), 0u) << e.what();
+        }
+        //every line before the bad one has been delivered
+        EXPECT_EQ(delivered, 3000u);
+    }
+}
+TEST(JsonNdjson, MaxDepthPerRecord){
+    json::NdjsonOptions options{1};
+    options.max_depth = 2;
+    EXPECT_EQ(json::parse_ndjson("[[1]]\n{\"a\": []}\n", [](json::JsonValue&&, std::size_t) {return true;}, options), 2u);
+    EXPECT_THROW(json::parse_ndjson("[[1]]\n[[[1]]]\n", [](json::JsonValue&&, std::size_t) {return true;}, options),
+                 json::NdjsonError);
+}
+TEST(JsonNdjson, ErrorIsAParseError){
+    EXPECT_THROW(json::parse_ndjson("1\n[\n"), json::ParseError);
+}
+TEST(JsonNdjson, ParsesFile){
+    std::string path = ::testing::TempDir() + "json_ndjson_test.jsonl";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << make_lines(1000);
+    }
+    std::int64_t sum = 0;
+    std::size_t count = json::parse_ndjson_file(path, [&](json::JsonValue&& v, std::size_t) {
+        sum += v["id"].as_int64();
+        return true;
+    });
+    std::remove(path.c_str());
+    EXPECT_EQ(count, 1000u);
+    EXPECT_EQ(sum, 999 * 1000 / 2);
+}
+TEST(JsonNdjson, MissingFileThrows){
+    EXPECT_THROW(json::parse_ndjson_file("/nonexistent/file.jsonl", [](json::JsonValue&&, std::size_t) {return true;}),
+                 std::runtime_error);
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include "json_parser/json.hpp"
+#include "json_parser/key_pool.hpp"
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+
+//a top-level array well above ParseOptions::kParallelMinBytes, with commas / brackets inside strings
+std::string make_records(std::size_t n) {
+    std::mt19937_64 rng(3);
+    std::string out = "[\n";
+    for(std::size_t i = 0; i < n; ++i) {
+        if(i) out += ",\n";
+        out.append(R"(  {"id": )").append(std::to_string(i))
+           .append(R"(, "name": "user, \"quoted\" ]}[{", "score": )").append(std::to_string(rng() % 10000 / 100.0))
+           .append(R"(, "originating_request_id": "request-)").append(std::to_string(rng() % 1000))
+           .append(R"(", "tags": [1, [2, [3]], {"x": null}], "ok": )").append(i % 2 ? "true" : "false").append("}");
+        //some elements are plain scalars
+        if(i % 97 == 0) out.append(", ").append(std::to_string(i));
+    }
+    return out + "\n]";
+}
+
+const std::string& records() {
+    static const std::string doc = make_records(8000);
+    return doc;
+}
+
+json::ParseOptions threaded(unsigned threads) {
+    json::ParseOptions options;
+    options.threads = threads;
+    return options;
+}
+
+//new_delete_resource, noting whether anything was allocated off the thread that made it
+class ThreadRecordingResource : public std::pmr::memory_resource {
+public:
+    bool used_off_thread() {
+        std::lock_guard lock(mutex_);
+        return off_thread_;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        {
+            std::lock_guard lock(mutex_);
+            off_thread_ |= std::this_thread::get_id() != owner_;
+        }
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this == &other;}
+
+    std::mutex mutex_;
+    std::thread::id owner_ = std::this_thread::get_id();
+    bool off_thread_ = false;
+};
+
+//message and position of the ParseError, or "" if it parses
+std::string error_of(const std::string& input, const json::ParseOptions& options) {
+    try {
+        (void)json::parse(input, options);
+    } catch(const json::ParseError& e) {
+        return e.what();
+    }
+    return "";
+}
+
+}
+
+TEST(JsonParallelParse, MatchesSerialParse){
+    ASSERT_GT(records().size(), json::ParseOptions::kParallelMinBytes);
+    std::string serial = json::parse(records()).dump();
+    for(unsigned threads : {2u, 4u, 0u}) {
+        EXPECT_EQ(json::parse(records(), threaded(threads)).dump(), serial) << threads << " threads";
+    }
+}
+TEST(JsonParallelParse, OtherRootsAndSmallInputs){
+    std::string object = "{\"data\": " + records() + "}";
+    EXPECT_EQ(json::parse(object, threaded(4)).dump(), json::parse(object).dump());
+    EXPECT_EQ(json::parse("[1, 2, [3]]", threaded(4)).dump(), "[1,2,[3]]");
+    std::string empty = "[" + std::string(2 << 20, ' ') + "]";
+    EXPECT_EQ(json::parse(empty, threaded(4)).size(), 0u);
+}
+TEST(JsonParallelParse, ErrorsMatchSerialParse){
+    const std::string& doc = records();
+    std::vector<std::string> broken = {
+        doc.substr(0, doc.size() - 1),                          //unterminated root
+        doc + " x",                                             //junk after the root
+        doc.substr(0, doc.size() - 2) + ",]",                   //trailing comma
+        [&] {std::string s = doc; s.replace(s.find("\"ok\": true", s.size() / 2), 10, "\"ok\": tru"); return s;}(),
+        "[1 2, " + doc.substr(1),                               //missing comma between elements
+        "[truex, " + doc.substr(1),
+        doc.substr(0, doc.size() - 2) + ", [1}]",               //mismatched brackets
+    };
+    for(const auto& input : broken) {
+        std::string serial = error_of(input, json::ParseOptions{});
+        EXPECT_FALSE(serial.empty());
+        EXPECT_EQ(error_of(input, threaded(4)), serial);
+    }
+}
+TEST(JsonParallelParse, MaxDepthCountsTheRoot){
+    json::ParseOptions options = threaded(4);
+    options.max_depth = 4;  //root, record, tags, [2, [3]], [3] is 5 levels
+    json::ParseOptions serial;
+    serial.max_depth = 4;
+    EXPECT_EQ(error_of(records(), options), error_of(records(), serial));
+    EXPECT_FALSE(error_of(records(), options).empty());
+    options.max_depth = 5;
+    EXPECT_NO_THROW(json::parse(records(), options));
+}
+TEST(JsonParallelParse, KeyPoolAndInSituStrings){
+    json::KeyPool pool;
+    json::ParseOptions options = threaded(4);
+    options.key_pool = &pool;
+    options.in_situ_strings = true;
+    auto v = json::parse(records(), options);
+    const auto& name = v[2]["name"].as_string();
+    EXPECT_EQ(name, "user, \"quoted\" ]}[{");
+    //"originating_request_id" is long enough to be pooled, once for all threads
+    EXPECT_EQ(pool.size(), 1u);
+    auto id = v[2]["originating_request_id"].as_string();
+    std::less_equal<const char*> le;
+    EXPECT_TRUE(le(records().data(), id.data()) && le(id.data() + id.size(), records().data() + records().size()));
+}
+TEST(JsonParallelParse, ArenaIsParsedSerially){
+    json::Arena arena;
+    auto v = json::parse(records(), arena, threaded(4));
+    EXPECT_EQ(v.as_array().get_allocator().resource(), &arena);
+    EXPECT_EQ(v.dump(), json::parse(records()).dump());
+}
+TEST(JsonParallelParse, UnsynchronizedResourcesAreParsedSerially){
+    std::pmr::monotonic_buffer_resource monotonic;
+    auto v = json::parse(records(), monotonic, threaded(4));
+    EXPECT_EQ(v.as_array().get_allocator().resource(), &monotonic);
+    EXPECT_EQ(v.dump(), json::parse(records()).dump());
+
+    std::pmr::unsynchronized_pool_resource pool;
+    EXPECT_EQ(json::parse(records(), pool, threaded(4)).dump(), v.dump());
+
+    //a resource of the caller's is only used from here, unless the caller says it is thread safe
+    ThreadRecordingResource mine;
+    EXPECT_EQ(json::parse(records(), mine, threaded(4)).dump(), v.dump());
+    EXPECT_FALSE(mine.used_off_thread());
+    json::ParseOptions safe = threaded(4);
+    safe.thread_safe_resource = true;
+    EXPECT_EQ(json::parse(records(), mine, safe).dump(), v.dump());
+    EXPECT_TRUE(mine.used_off_thread());
+}
+TEST(JsonParallelParse, SynchronizedPool){
+    std::pmr::synchronized_pool_resource pool;
+    auto v = json::parse(records(), pool, threaded(4));
+    EXPECT_EQ(v.as_array().get_allocator().resource(), &pool);
+    EXPECT_EQ(v.dump(), json::parse(records()).dump());
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "json_parser/json.hpp"
+#include "json_parser/key_pool.hpp"
+#include <memory_resource>
+#include <string>
+
+namespace {
+
+struct CountingResource : std::pmr::memory_resource {
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+    void* do_allocate(std::size_t n, std::size_t alignment) override {
+        ++allocations;
+        bytes += n;
+        return std::pmr::new_delete_resource()->allocate(n, alignment);
+    }
+    void do_deallocate(void* p, std::size_t n, std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, n, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this == &other;}
+};
+
+//a bit of everything that allocates: long / escaped strings, long keys, a duplicate, a large object
+std::string mixed_document() {
+    std::string json = R"({"id": 7, "name": "a name that is longer than sso", "short": "tiny", "esc": "line\nbreak and more text",)"
+                       R"( "a_key_longer_than_fifteen": [1, 2.5, -3, null, true, false, "mid-size-str"], "empty": [], "none": {},)"
+                       R"( "dup": 1, "dup": "the duplicate wins", "deep": [[[{"x": [[]]}]]], "wide": {)";
+    for(int i = 0; i < 40; ++i) {
+        if(i) json += ", ";
+        json += "\"member_with_a_long_name_" + std::to_string(i) + "\": " + std::to_string(i);
+    }
+    json += "}}";
+    return json;
+}
+
+json::ParseOptions with(json::ParseStats& stats) {
+    json::ParseOptions options;
+    options.stats = &stats;
+    return options;
+}
+
+}
+
+TEST(JsonParseStats, CountsEveryValue){
+    const std::string input = R"({"a": [1, -2, 18446744073709551615, 1.5, "s", null, true, false], "b": {"c": {}}, "a": 0})";
+    json::ParseStats stats;
+    json::JsonValue doc = json::parse(input, with(stats));
+    EXPECT_EQ(doc.dump(), json::parse(input).dump());
+    EXPECT_EQ(stats.bytes, input.size());
+    EXPECT_EQ(stats.integers, 4u);
+    EXPECT_EQ(stats.doubles, 1u);
+    EXPECT_EQ(stats.strings, 1u);
+    EXPECT_EQ(stats.nulls, 1u);
+    EXPECT_EQ(stats.bools, 2u);
+    EXPECT_EQ(stats.arrays, 1u);
+    EXPECT_EQ(stats.objects, 3u);
+    //the duplicate "a" is a key of the input too
+    EXPECT_EQ(stats.keys, 4u);
+    EXPECT_EQ(stats.values(), 13u);
+    EXPECT_EQ(stats.max_depth, 3u);
+    //not asked for
+    EXPECT_EQ(stats.time.total().count(), 0);
+
+    json::ParseStats scalar;
+    (void)json::parse("42", with(scalar));
+    EXPECT_EQ(scalar.max_depth, 0u);
+    EXPECT_EQ(scalar.integers, 1u);
+    EXPECT_EQ(scalar.allocations, 0u);
+}
+TEST(JsonParseStats, AllocationsAreWhatTheResourceSees){
+    const std::string input = mixed_document();
+    json::KeyPool pool;
+    for(json::ParseEngine engine : {json::ParseEngine::RecursiveDescent, json::ParseEngine::StructuralIndex}) {
+        for(int variant = 0; variant < 3; ++variant) {
+            json::ParseStats stats;
+            json::ParseOptions options = with(stats);
+            options.engine = engine;
+            options.in_situ_strings = variant == 1;
+            if(variant == 2) options.key_pool = &pool;
+            CountingResource resource;
+            json::JsonValue doc = json::parse(input, resource, options);
+            SCOPED_TRACE(variant);
+            EXPECT_EQ(stats.allocations, resource.allocations);
+            EXPECT_EQ(stats.bytes_allocated, resource.bytes);
+            EXPECT_EQ(doc["dup"].as_string(), "the duplicate wins");
+            EXPECT_EQ(stats.max_depth, 7u);
+        }
+    }
+}
+TEST(JsonParseStats, ResetPerParse){
+    json::ParseStats stats;
+    json::ParseOptions options = with(stats);
+    (void)json::parse("[1, 2, 3]", options);
+    (void)json::parse("[true]", options);
+    EXPECT_EQ(stats.integers, 0u);
+    EXPECT_EQ(stats.bools, 1u);
+    EXPECT_EQ(stats.bytes, 6u);
+}
+TEST(JsonParseStats, PhasesAddUp){
+    std::string input = "[";
+    for(int i = 0; i < 2000; ++i) {
+        if(i) input += ",\n  ";
+        input += R"({"name": "element number )" + std::to_string(i) + R"(", "value": )" + std::to_string(i * 0.5) + "}";
+    }
+    input += "]";
+    for(json::ParseEngine engine : {json::ParseEngine::RecursiveDescent, json::ParseEngine::StructuralIndex}) {
+        json::ParseStats stats;
+        json::ParseOptions options = with(stats);
+        options.engine = engine;
+        options.time_phases = true;
+        (void)json::parse(input, options);
+        EXPECT_EQ(stats.objects, 2000u);
+        EXPECT_GT(stats.time.build.count(), 0);
+        EXPECT_EQ(stats.time.total(), stats.time.whitespace + stats.time.strings + stats.time.numbers + stats.time.build +
+                                      stats.time.index + stats.time.other);
+        if(engine == json::ParseEngine::RecursiveDescent) {
+            EXPECT_GT(stats.time.whitespace.count(), 0);
+            EXPECT_GT(stats.time.strings.count(), 0);
+            EXPECT_GT(stats.time.numbers.count(), 0);
+            EXPECT_EQ(stats.time.index.count(), 0);
+        } else {
+            EXPECT_GT(stats.time.index.count(), 0);
+        }
+    }
+}
+TEST(JsonParseStats, ErrorsKeepWhatWasCounted){
+    json::ParseStats stats;
+    const std::string input = R"({"a": [1, 2, "three"], "b": tru})";
+    try {
+        (void)json::parse(input, with(stats));
+        FAIL() << "expected a ParseError";
+    } catch(const json::ParseError& e) {
+        EXPECT_EQ(stats.bytes, e.position());
+    }
+    EXPECT_EQ(stats.integers, 2u);
+    EXPECT_EQ(stats.strings, 1u);
+    EXPECT_EQ(stats.keys, 2u);
+}
+TEST(JsonParseStats, ParsesSeriallyWithThreads){
+    std::string input = "[";
+    for(int i = 0; i < 100; ++i) input += (i ? ",[" : "[") + std::to_string(i) + "]";
+    input += "]";
+    json::ParseStats stats;
+    json::ParseOptions options = with(stats);
+    options.threads = 4;
+    EXPECT_EQ(json::parse(input, options).dump(), json::parse(input).dump());
+    EXPECT_EQ(stats.arrays, 101u);
+    EXPECT_EQ(stats.integers, 100u);
+}
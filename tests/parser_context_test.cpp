@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "json_parser/parser_context.hpp"
+#include "json_parser/key_pool.hpp"
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+/*
+    global operator new counts its calls on this thread, so a test can see every heap allocation a
+    parse makes - also the ones outside any memory resource (scratch strings, vectors)
+*/
+namespace {
+thread_local std::size_t t_heap_allocations = 0;
+}
+
+void* operator new(std::size_t n) {
+    ++t_heap_allocations;
+    if(void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete(void* p, std::size_t) noexcept {std::free(p);}
+
+namespace {
+
+std::vector<std::string> messages() {
+    std::vector<std::string> out;
+    for(int i = 0; i < 50; ++i) {
+        out.push_back(R"({"jsonrpc": "2.0", "id": )" + std::to_string(i) + R"(, "method": "inventory.reserve_items",)"
+                      R"( "params": {"sku": "sku-)" + std::to_string(100000 + i) + R"(-standard", "quantity": )" +
+                      std::to_string(i % 9) + R"(, "warehouses": ["eu-central-1", "us-east-2"],)"
+                      R"( "note": "escaped \"quotes\" and a newline\n in a long string", "priority": true}})");
+    }
+    return out;
+}
+
+json::ParseOptions engine(json::ParseEngine e) {
+    json::ParseOptions options;
+    options.engine = e;
+    return options;
+}
+
+}
+
+TEST(JsonParserContext, SameDocumentsAsParse){
+    for(json::ParseEngine e : {json::ParseEngine::RecursiveDescent, json::ParseEngine::StructuralIndex}) {
+        json::ParserContext context(engine(e));
+        for(const std::string& m : messages()) {
+            EXPECT_EQ(context.parse(m).dump(), json::parse(m).dump());
+        }
+        EXPECT_EQ(context.parse("[]").dump(), "[]");
+        EXPECT_EQ(context.parse(" 42 ").as_int64(), 42);
+    }
+}
+TEST(JsonParserContext, NoAllocationsOnceWarm){
+    const std::vector<std::string> input = messages();
+    json::KeyPool pool;
+    for(int variant = 0; variant < 4; ++variant) {
+        json::ParseOptions options = engine(variant % 2 ? json::ParseEngine::StructuralIndex : json::ParseEngine::RecursiveDescent);
+        if(variant >= 2) {
+            options.in_situ_strings = true;
+            options.key_pool = &pool;
+        }
+        json::ParserContext context(options);
+        for(const std::string& m : input) (void)context.parse(m);
+        std::size_t before = t_heap_allocations;
+        std::size_t ids = 0;
+        for(int round = 0; round < 10; ++round) {
+            for(const std::string& m : input) ids += static_cast<std::size_t>(context.parse(m)["id"].as_int64());
+        }
+        std::size_t allocations = t_heap_allocations - before;
+        SCOPED_TRACE(variant);
+        EXPECT_EQ(allocations, 0u);
+        EXPECT_EQ(ids, 10u * (49 * 50 / 2));
+        EXPECT_EQ(context.arena().block_count(), 1u);
+    }
+    //json::parse() for comparison: a fresh parser, builder and document per call
+    std::size_t before = t_heap_allocations;
+    for(const std::string& m : input) (void)json::parse(m);
+    EXPECT_GT(t_heap_allocations - before, input.size() * 10);
+}
+TEST(JsonParserContext, DocumentLivesUntilTheNextParse){
+    json::ParserContext context;
+    json::JsonValue& first = context.parse(R"({"name": "a string too long to be small", "list": [1, 2, 3]})");
+    //a copy leaves the arena and outlives the next parse
+    json::JsonValue kept = first;
+    first["list"].as_array().push_back(4);
+    EXPECT_EQ(first["list"].size(), 4u);
+    (void)context.parse(R"(["something else entirely, to overwrite the arena"])");
+    EXPECT_EQ(kept["name"].as_string(), "a string too long to be small");
+    EXPECT_EQ(kept["list"].size(), 3u);
+}
+TEST(JsonParserContext, OwnResource){
+    json::ParserContext context;
+    json::Arena mine;
+    json::JsonValue doc = context.parse(R"({"name": "a string too long to be small"})", mine);
+    (void)context.parse("[1]");
+    EXPECT_EQ(doc["name"].as_string(), "a string too long to be small");
+    EXPECT_GT(mine.bytes_used(), 0u);
+}
+TEST(JsonParserContext, RecoversFromErrors){
+    for(json::ParseEngine e : {json::ParseEngine::RecursiveDescent, json::ParseEngine::StructuralIndex}) {
+        json::ParseOptions options = engine(e);
+        options.max_depth = 4;
+        json::ParserContext context(options);
+        EXPECT_THROW((void)context.parse(R"({"a": [1, 2, {"b": tru}]})"), json::ParseError);
+        EXPECT_THROW((void)context.parse("[[[[[1]]]]]"), json::ParseError);
+        EXPECT_THROW((void)context.parse(R"({"a": 1} x)"), json::ParseError);
+        EXPECT_EQ(context.parse(R"({"a": [1, {"b": true}]})").dump(), R"({"a":[1,{"b":true}]})");
+    }
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include "json_parser/patch.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string patched(const std::string& doc, const std::string& patch) {
+    json::JsonValue v = json::parse(doc);
+    json::apply_patch(v, json::parse(patch));
+    return v.dump();
+}
+
+std::string merged(const std::string& doc, const std::string& patch) {
+    json::JsonValue v = json::parse(doc);
+    json::apply_merge_patch(v, json::parse(patch));
+    return v.dump();
+}
+
+//the operation index of the PatchError, or npos if the patch applied
+std::size_t failing_operation(const std::string& doc, const std::string& patch) {
+    try {
+        (void)patched(doc, patch);
+        return std::string::npos;
+    } catch(const json::PatchError& e) {
+        return e.operation();
+    }
+}
+
+}
+
+//the examples of RFC 6902 appendix A
+TEST(JsonPatch, Rfc6902Examples){
+    EXPECT_EQ(patched(R"({"foo": "bar"})", R"([{"op": "add", "path": "/baz", "value": "qux"}])"), R"({"foo":"bar","baz":"qux"})");
+    EXPECT_EQ(patched(R"({"foo": ["bar", "baz"]})", R"([{"op": "add", "path": "/foo/1", "value": "qux"}])"), R"({"foo":["bar","qux","baz"]})");
+    EXPECT_EQ(patched(R"({"baz": "qux", "foo": "bar"})", R"([{"op": "remove", "path": "/baz"}])"), R"({"foo":"bar"})");
+    EXPECT_EQ(patched(R"({"foo": ["bar", "qux", "baz"]})", R"([{"op": "remove", "path": "/foo/1"}])"), R"({"foo":["bar","baz"]})");
+    EXPECT_EQ(patched(R"({"baz": "qux", "foo": "bar"})", R"([{"op": "replace", "path": "/baz", "value": "boo"}])"), R"({"baz":"boo","foo":"bar"})");
+    EXPECT_EQ(patched(R"({"foo": {"bar": "baz", "waldo": "fred"}, "qux": {"corge": "grault"}})",
+                      R"([{"op": "move", "from": "/foo/waldo", "path": "/qux/thud"}])"),
+              R"({"foo":{"bar":"baz"},"qux":{"corge":"grault","thud":"fred"}})");
+    EXPECT_EQ(patched(R"({"foo": ["all", "grass", "cows", "eat"]})", R"([{"op": "move", "from": "/foo/1", "path": "/foo/3"}])"),
+              R"({"foo":["all","cows","eat","grass"]})");
+    EXPECT_EQ(patched(R"({"baz": "qux", "foo": ["a", 2, "c"]})",
+                      R"([{"op": "test", "path": "/baz", "value": "qux"}, {"op": "test", "path": "/foo/1", "value": 2}])"),
+              R"({"baz":"qux","foo":["a",2,"c"]})");
+    EXPECT_EQ(failing_operation(R"({"baz": "qux"})", R"([{"op": "test", "path": "/baz", "value": "bar"}])"), 0u);
+    EXPECT_EQ(patched(R"({"foo": "bar"})", R"([{"op": "add", "path": "/child", "value": {"grandchild": {}}}])"), R"({"foo":"bar","child":{"grandchild":{}}})");
+    EXPECT_EQ(failing_operation(R"({"foo": "bar"})", R"([{"op": "add", "path": "/baz/bat", "value": "qux"}])"), 0u);
+    EXPECT_EQ(patched(R"({"/": 9, "~1": 10})", R"([{"op": "test", "path": "/~01", "value": 10}])"), R"({"/":9,"~1":10})");
+    EXPECT_EQ(failing_operation(R"({"/": 9, "~1": 10})", R"([{"op": "test", "path": "/~01", "value": "10"}])"), 0u);
+    EXPECT_EQ(patched(R"({"foo": ["bar"]})", R"([{"op": "add", "path": "/foo/-", "value": ["abc", "def"]}])"), R"({"foo":["bar",["abc","def"]]})");
+}
+TEST(JsonPatch, Operations){
+    //copy is a deep copy, the original stays
+    EXPECT_EQ(patched(R"({"a": {"b": [1, 2]}})", R"([{"op": "copy", "from": "/a", "path": "/c"}, {"op": "add", "path": "/c/b/-", "value": 3}])"),
+              R"({"a":{"b":[1,2]},"c":{"b":[1,2,3]}})");
+    //add onto an existing member replaces it in place
+    EXPECT_EQ(patched(R"({"a": 1, "b": 2})", R"([{"op": "add", "path": "/a", "value": [true]}])"), R"({"a":[true],"b":2})");
+    //the root
+    EXPECT_EQ(patched(R"({"a": 1})", R"([{"op": "replace", "path": "", "value": [1, 2]}])"), "[1,2]");
+    EXPECT_EQ(patched(R"([1])", R"([{"op": "add", "path": "", "value": null}])"), "null");
+    EXPECT_EQ(patched(R"({"a": {"b": 1}})", R"([{"op": "move", "from": "/a", "path": "/a"}])"), R"({"a":{"b":1}})");
+    //test compares numbers by value and objects regardless of order
+    EXPECT_EQ(failing_operation(R"({"n": 1.0, "o": {"x": 1, "y": [2]}})",
+                                R"([{"op": "test", "path": "/n", "value": 1}, {"op": "test", "path": "/o", "value": {"y": [2.0], "x": 1}}])"),
+              std::string::npos);
+    EXPECT_EQ(failing_operation(R"({"o": {"x": 1}})", R"([{"op": "test", "path": "/o", "value": {"x": 1, "y": null}}])"), 0u);
+}
+TEST(JsonPatch, Errors){
+    const std::string doc = R"({"a": [1, 2], "s": "x"})";
+    for(const std::string patch : {R"([{"op": "remove", "path": "/missing"}])", R"([{"op": "replace", "path": "/a/2", "value": 0}])",
+                                   R"([{"op": "add", "path": "/a/3", "value": 0}])", R"([{"op": "add", "path": "/a/01", "value": 0}])",
+                                   R"([{"op": "remove", "path": "/a/-"}])", R"([{"op": "add", "path": "/s/x", "value": 0}])",
+                                   R"([{"op": "move", "from": "/a", "path": "/a/0"}])", R"([{"op": "copy", "from": "/b", "path": "/c"}])",
+                                   R"([{"op": "add", "path": "/b"}])", R"([{"op": "frobnicate", "path": "/a"}])", R"([{"path": "/a"}])",
+                                   R"([{"op": "remove", "path": "a"}])", R"([{"op": "remove", "path": ""}])", R"([[]])"}) {
+        SCOPED_TRACE(patch);
+        EXPECT_EQ(failing_operation(doc, patch), 0u);
+    }
+    EXPECT_THROW((void)patched(doc, R"({"op": "remove", "path": "/a"})"), std::runtime_error);
+
+    //not atomic: the operations before the failing one stay applied
+    json::JsonValue v = json::parse(doc);
+    try {
+        json::apply_patch(v, json::parse(R"([{"op": "remove", "path": "/s"}, {"op": "add", "path": "/x", "value": 1}, {"op": "remove", "path": "/s"}])"));
+        FAIL() << "expected a PatchError";
+    } catch(const json::PatchError& e) {
+        EXPECT_EQ(e.operation(), 2u);
+        EXPECT_EQ(std::string(e.what()), "patch operation 2: no value at /s");
+    }
+    EXPECT_EQ(v.dump(), R"({"a":[1,2],"x":1})");
+}
+//the examples of RFC 7386 appendix A
+TEST(JsonPatch, Rfc7386Examples){
+    const std::vector<std::vector<std::string>> cases = {
+        {R"({"a":"b"})", R"({"a":"c"})", R"({"a":"c"})"},
+        {R"({"a":"b"})", R"({"b":"c"})", R"({"a":"b","b":"c"})"},
+        {R"({"a":"b"})", R"({"a":null})", R"({})"},
+        {R"({"a":"b","b":"c"})", R"({"a":null})", R"({"b":"c"})"},
+        {R"({"a":["b"]})", R"({"a":"c"})", R"({"a":"c"})"},
+        {R"({"a":"c"})", R"({"a":["b"]})", R"({"a":["b"]})"},
+        {R"({"a":{"b":"c"}})", R"({"a":{"b":"d","c":null}})", R"({"a":{"b":"d"}})"},
+        {R"({"a":[{"b":"c"}]})", R"({"a":[1]})", R"({"a":[1]})"},
+        {R"(["a","b"])", R"(["c","d"])", R"(["c","d"])"},
+        {R"({"a":"b"})", R"(["c"])", R"(["c"])"},
+        {R"({"a":"foo"})", R"(null)", R"(null)"},
+        {R"({"a":"foo"})", R"("bar")", R"("bar")"},
+        {R"({"e":null})", R"({"a":1})", R"({"e":null,"a":1})"},
+        {R"([1,2])", R"({"a":"b","c":null})", R"({"a":"b"})"},
+        {R"({})", R"({"a":{"bb":{"ccc":null}}})", R"({"a":{"bb":{}}})"},
+    };
+    for(const auto& c : cases) {
+        SCOPED_TRACE(c[1]);
+        EXPECT_EQ(merged(c[0], c[1]), c[2]);
+    }
+}
+
+namespace {
+
+//records big enough that several levels get fragments of their own
+std::string catalog() {
+    std::string json = R"({"version": 1, "items": [)";
+    for(int i = 0; i < 60; ++i) {
+        if(i) json += ", ";
+        json += R"({"id": )" + std::to_string(i) + R"(, "name": "item number )" + std::to_string(i) +
+                R"( with a name long enough", "stock": )" + std::to_string(i * 3) +
+                R"(, "tags": ["a", "b", "c"], "dims": {"w": 1.5, "h": 2, "notes": "some \"quoted\" text to make it bigger"}})";
+    }
+    return json + R"(], "meta": {"owner": "team", "flags": [true, false, null]}})";
+}
+
+}
+
+TEST(JsonDumpCache, SameBytesAsDump){
+    //64: every record has a fragment of its own. the default: records are written inline into the items array
+    for(std::size_t fragment_bytes : {std::size_t(64), json::DumpCache::kDefaultFragmentBytes}) {
+        json::DumpCache cache(json::parse(catalog()), fragment_bytes);
+        EXPECT_EQ(cache.dump(), cache.value().dump());
+        const std::size_t full = cache.serialized_bytes();
+        EXPECT_EQ(full, cache.dump().size());
+
+        //nothing changed, nothing serialized
+        (void)cache.dump();
+        EXPECT_EQ(cache.serialized_bytes(), 0u);
+
+        //one member of one record: only that record is written again, the rest is copied
+        cache.apply_patch(json::parse(R"([{"op": "replace", "path": "/items/17/stock", "value": 1000}])"));
+        EXPECT_EQ(cache.dump(), cache.value().dump());
+        EXPECT_NE(cache.dump().find(R"("id":17,"name":"item number 17 with a name long enough","stock":1000)"), std::string::npos);
+        EXPECT_LT(cache.serialized_bytes(), 250u);
+    }
+}
+TEST(JsonDumpCache, RandomPatches){
+    std::mt19937 rng(7);
+    for(std::size_t fragment_bytes : {std::size_t(1), std::size_t(64), std::size_t(512), json::DumpCache::kDefaultFragmentBytes * 100}) {
+        json::DumpCache cache(json::parse(catalog()), fragment_bytes);
+        (void)cache.dump();
+        for(int round = 0; round < 300; ++round) {
+            std::size_t items = cache.value()["items"].size();
+            std::string i = std::to_string(items ? rng() % items : 0);
+            std::string j = std::to_string(items ? rng() % items : 0);
+            std::string patch;
+            switch(rng() % 9) {
+                case 0: patch = R"([{"op": "replace", "path": "/items/)" + i + R"(/stock", "value": )" + std::to_string(round) + "}]"; break;
+                case 1: patch = R"([{"op": "add", "path": "/items/)" + i + R"(", "value": {"id": -1, "tags": []}}])"; break;
+                case 2: patch = R"([{"op": "remove", "path": "/items/)" + i + R"("}])"; break;
+                case 3: patch = R"([{"op": "move", "from": "/items/)" + i + R"(", "path": "/items/)" + j + R"("}])"; break;
+                case 4: patch = R"([{"op": "copy", "from": "/items/)" + i + R"(", "path": "/items/-"}])"; break;
+                case 5: patch = R"([{"op": "add", "path": "/items/)" + i + R"(/dims/extra", "value": [1, {"deep": true}]}])"; break;
+                case 6: patch = R"([{"op": "remove", "path": "/items/)" + i + R"(/name"}])"; break;
+                case 7: patch = R"([{"op": "move", "from": "/items/)" + i + R"(/tags", "path": "/meta/tags"}])"; break;
+                default: patch = R"([{"op": "replace", "path": "/version", "value": )" + std::to_string(round) + "}]"; break;
+            }
+            if(items == 0) patch = R"([{"op": "add", "path": "/items/-", "value": {"id": 0}}])";
+            try {
+                cache.apply_patch(json::parse(patch));
+            } catch(const json::PatchError&) {
+                //a member that an earlier round removed
+            }
+            if(rng() % 3 == 0) {
+                SCOPED_TRACE(patch);
+                ASSERT_EQ(cache.dump(), cache.value().dump());
+            }
+        }
+        EXPECT_EQ(cache.dump(), cache.value().dump());
+    }
+}
+TEST(JsonDumpCache, MergePatchAndEdit){
+    json::DumpCache cache(json::parse(catalog()), 64);
+    (void)cache.dump();
+    cache.apply_merge_patch(json::parse(R"({"meta": {"owner": null, "flags": "none", "new": {"x": null, "y": 1}}, "version": 2})"));
+    EXPECT_EQ(cache.dump(), cache.value().dump());
+    EXPECT_EQ(cache.value()["meta"].dump(), R"({"flags":"none","new":{"y":1}})");
+
+    json::JsonValue& item = cache.edit("/items/3");
+    item.as_object().erase("tags");
+    item["dims"]["w"] = 99;
+    EXPECT_EQ(cache.dump(), cache.value().dump());
+    EXPECT_EQ(cache.value()["items"][3]["dims"]["w"].as_int64(), 99);
+    EXPECT_THROW((void)cache.edit("/items/1000"), std::out_of_range);
+
+    cache.apply_merge_patch(json::parse("[1, 2]"));
+    EXPECT_EQ(cache.dump(), "[1,2]");
+    cache.edit("") = json::parse(R"({"fresh": true})");
+    EXPECT_EQ(cache.dump(), R"({"fresh":true})");
+}
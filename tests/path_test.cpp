@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "json_parser/path.hpp"
+#include <string>
+
+namespace {
+
+//the example document of RFC 6901 section 5
+const std::string kRfcDocument = R"({
+    "foo": ["bar", "baz"],
+    "": 0,
+    "a/b": 1,
+    "c%d": 2,
+    "e^f": 3,
+    "g|h": 4,
+    "i\\j": 5,
+    "k\"l": 6,
+    " ": 7,
+    "m~n": 8
+})";
+
+const std::string kMessage = R"({"payload": {"items": [{"price": 9.5, "sku": "a-1"}, {"price": 3, "sku": "b-2"}],)"
+                             R"( "meta": {"0": "zero key", "10": "ten"}}, "ok": true})";
+
+}
+
+TEST(JsonPath, RfcExamples){
+    auto doc = json::parse(kRfcDocument);
+    EXPECT_EQ(json::Path("").find(doc), &doc);
+    EXPECT_EQ(json::Path("/foo").find(doc)->dump(), R"(["bar","baz"])");
+    EXPECT_EQ(json::Path("/foo/0").find(doc)->as_string(), "bar");
+    EXPECT_EQ(json::Path("/").find(doc)->as_int64(), 0);
+    EXPECT_EQ(json::Path("/a~1b").find(doc)->as_int64(), 1);
+    EXPECT_EQ(json::Path("/c%d").find(doc)->as_int64(), 2);
+    EXPECT_EQ(json::Path("/e^f").find(doc)->as_int64(), 3);
+    EXPECT_EQ(json::Path("/g|h").find(doc)->as_int64(), 4);
+    EXPECT_EQ(json::Path("/i\\j").find(doc)->as_int64(), 5);
+    EXPECT_EQ(json::Path("/k\"l").find(doc)->as_int64(), 6);
+    EXPECT_EQ(json::Path("/ ").find(doc)->as_int64(), 7);
+    EXPECT_EQ(json::Path("/m~0n").find(doc)->as_int64(), 8);
+}
+TEST(JsonPath, MissesAreNull){
+    auto doc = json::parse(kMessage);
+    EXPECT_EQ(json::Path("/payload/items/1/price").find(doc)->as_int64(), 3);
+    EXPECT_EQ(json::Path("/payload/missing").find(doc), nullptr);
+    EXPECT_EQ(json::Path("/payload/items/2").find(doc), nullptr);
+    EXPECT_EQ(json::Path("/payload/items/-").find(doc), nullptr);
+    //not an index: leading zero, sign, letters, too big
+    EXPECT_EQ(json::Path("/payload/items/01").find(doc), nullptr);
+    EXPECT_EQ(json::Path("/payload/items/+1").find(doc), nullptr);
+    EXPECT_EQ(json::Path("/payload/items/x").find(doc), nullptr);
+    EXPECT_EQ(json::Path("/payload/items/99999999999999999999999").find(doc), nullptr);
+    //through a scalar
+    EXPECT_EQ(json::Path("/ok/x").find(doc), nullptr);
+    EXPECT_EQ(json::Path("/payload/items/0/price/0").find(doc), nullptr);
+    //digits are keys on objects
+    EXPECT_EQ(json::Path("/payload/meta/0").find(doc)->as_string(), "zero key");
+    EXPECT_EQ(json::Path("/payload/meta/10").find(doc)->as_string(), "ten");
+}
+TEST(JsonPath, MutableLookup){
+    auto doc = json::parse(kMessage);
+    json::Path sku("/payload/items/0/sku");
+    *sku.find(doc) = "changed";
+    EXPECT_EQ(doc["payload"]["items"][0]["sku"].as_string(), "changed");
+}
+TEST(JsonPath, LargeObjectsUseTheHash){
+    //above JsonObject::kIndexThreshold lookups go through the hash index with the precomputed hash
+    json::JsonObject obj;
+    for(int i = 0; i < 100; ++i) obj.insert_or_assign("key" + std::to_string(i), i);
+    json::JsonValue doc(std::move(obj));
+    for(int i = 0; i < 100; ++i) {
+        const json::JsonValue* v = json::Path("/key" + std::to_string(i)).find(doc);
+        ASSERT_NE(v, nullptr);
+        EXPECT_EQ(v->as_int64(), i);
+    }
+    EXPECT_EQ(json::Path("/key100").find(doc), nullptr);
+}
+TEST(JsonPath, InvalidPointersThrow){
+    auto position = [](std::string_view pointer) -> std::size_t {
+        try {
+            json::Path p(pointer);
+        } catch(const json::ParseError& e) {
+            return e.position();
+        }
+        return SIZE_MAX;
+    };
+    EXPECT_EQ(position("foo"), 0u);
+    EXPECT_EQ(position("/a~2"), 2u);
+    EXPECT_EQ(position("/a/b~"), 4u);
+    EXPECT_EQ(position("/~01"), SIZE_MAX);
+}
+TEST(JsonPath, Tokens){
+    json::Path p("/a~1b//m~0n/0");
+    EXPECT_EQ(p.str(), "/a~1b//m~0n/0");
+    ASSERT_EQ(p.size(), 4u);
+    EXPECT_EQ(p[0], "a/b");
+    EXPECT_EQ(p[1], "");
+    EXPECT_EQ(p[2], "m~n");
+    EXPECT_EQ(p[3], "0");
+    //~01 is "~1", not "/"
+    EXPECT_EQ(json::Path("/~01")[0], "~1");
+    EXPECT_EQ(json::Path("").size(), 0u);
+}
+TEST(JsonPath, LazyDocumentMatchesDom){
+    auto dom = json::parse(kMessage);
+    json::Document doc(kMessage);
+    for(const char* pointer : {"", "/payload/items/1/price", "/payload/items/0/sku", "/payload/meta/0", "/ok",
+                               "/payload/missing", "/payload/items/2", "/payload/items/-", "/ok/x"}) {
+        json::Path path(pointer);
+        const json::JsonValue* expected = path.find(dom);
+        auto lazy = path.find(doc);
+        ASSERT_EQ(lazy.has_value(), expected != nullptr) << pointer;
+        if(expected) {
+            EXPECT_EQ(lazy->materialize().dump(), expected->dump()) << pointer;
+        }
+    }
+    //the RFC document too (escaped keys in the text)
+    json::Document rfc(kRfcDocument);
+    EXPECT_EQ(json::Path("/k\"l").find(rfc)->as_int64(), 6);
+    EXPECT_EQ(json::Path("/i\\j").find(rfc)->as_int64(), 5);
+    EXPECT_EQ(json::Path("/foo/1").find(rfc)->as_string(), "baz");
+}
+TEST(JsonPath, LazySyntaxErrorsOnThePathThrow){
+    json::Document doc(R"({"skipped": [1, 2 3], "a": {"b": tru}})");
+    //the broken member is skipped
+    EXPECT_FALSE(json::Path("/a/c").find(doc).has_value());
+    EXPECT_THROW((void)json::Document(R"({"a": {"b" 1}})")["a"].find("b"), json::ParseError);
+}
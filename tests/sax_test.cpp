@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "json_parser/sax.hpp"
+#include <string>
+#include <vector>
+
+namespace {
+
+//records every event as a short string so whole streams can be compared at once
+struct Recorder : json::SaxHandler {
+    std::vector<std::string> events;
+
+    bool on_null() override {events.push_back("null"); return true;}
+    bool on_bool(bool b) override {events.push_back(b ? "true" : "false"); return true;}
+    bool on_number(double d) override {events.push_back("d:" + std::to_string(d)); return true;}
+    bool on_int64(std::int64_t i) override {events.push_back("i:" + std::to_string(i)); return true;}
+    bool on_uint64(std::uint64_t u) override {events.push_back("u:" + std::to_string(u)); return true;}
+    bool on_string(std::string_view s) override {events.push_back("s:" + std::string(s)); return true;}
+    bool on_start_object() override {events.push_back("{"); return true;}
+    bool on_key(std::string_view k) override {events.push_back("k:" + std::string(k)); return true;}
+    bool on_end_object() override {events.push_back("}"); return true;}
+    bool on_start_array() override {events.push_back("["); return true;}
+    bool on_end_array() override {events.push_back("]"); return true;}
+};
+
+}
+
+// event stream tests ------------------------------------------------------------
+TEST(JsonSax, Scalars){
+    Recorder r;
+    EXPECT_TRUE(json::parse_sax("[null, true, false, 1.5, -3, 18446744073709551615, \"s\"]", r));
+    std::vector<std::string> expected = {
+        "[", "null", "true", "false", "d:1.500000", "i:-3", "u:18446744073709551615", "s:s", "]"
+    };
+    EXPECT_EQ(r.events, expected);
+}
+TEST(JsonSax, NestedContainers){
+    Recorder r;
+    EXPECT_TRUE(json::parse_sax(R"({"a": {"b": [1, {}]}, "c": []})", r));
+    std::vector<std::string> expected = {
+        "{", "k:a", "{", "k:b", "[", "i:1", "{", "}", "]", "}", "k:c", "[", "]", "}"
+    };
+    EXPECT_EQ(r.events, expected);
+}
+TEST(JsonSax, EscapedStringsAndKeysAreDecoded){
+    Recorder r;
+    EXPECT_TRUE(json::parse_sax(R"({"k\"ey": "line\nbreak A"})", r));
+    std::vector<std::string> expected = {"{", "k:k\"ey", "s:line\nbreak A", "}"};
+    EXPECT_EQ(r.events, expected);
+}
+TEST(JsonSax, UnescapedStringsPointIntoInput){
+    struct ViewCheck : json::SaxHandler {
+        const char* begin;
+        const char* end;
+        bool all_inside = true;
+        bool on_string(std::string_view s) override {
+            all_inside = all_inside && s.data() >= begin && s.data() + s.size() <= end;
+            return true;
+        }
+    };
+    std::string input = R"(["alpha", "beta", "gamma"])";
+    ViewCheck h;
+    h.begin = input.data();
+    h.end = input.data() + input.size();
+    EXPECT_TRUE(json::parse_sax(input, h));
+    EXPECT_TRUE(h.all_inside);
+}
+TEST(JsonSax, DefaultIntegerEventsForwardToNumber){
+    struct Sum : json::SaxHandler {
+        double total = 0;
+        bool on_number(double d) override {total += d; return true;}
+    };
+    Sum h;
+    EXPECT_TRUE(json::parse_sax("[1, 2.5, 3]", h));
+    EXPECT_EQ(h.total, 6.5);
+}
+
+// early stop & errors -----------------------------------------------------------
+TEST(JsonSax, HandlerCanStopEarly){
+    //extract one field and stop - the rest of the document (even if broken) is never looked at
+    struct FindId : json::SaxHandler {
+        bool next_is_id = false;
+        std::int64_t id = -1;
+        bool on_key(std::string_view k) override {next_is_id = (k == "id"); return true;}
+        bool on_int64(std::int64_t v) override {
+            if(next_is_id) {id = v; return false;}
+            return true;
+        }
+    };
+    FindId h;
+    EXPECT_FALSE(json::parse_sax(R"({"name": "x", "id": 42, "rest": [1, 2, !!!)", h));
+    EXPECT_EQ(h.id, 42);
+}
+TEST(JsonSax, SyntaxErrorsThrow){
+    json::SaxHandler ignore;
+    EXPECT_THROW((void)json::parse_sax("[1, 2,]", ignore), json::ParseError);
+    EXPECT_THROW((void)json::parse_sax("{\"a\" 1}", ignore), json::ParseError);
+    EXPECT_THROW((void)json::parse_sax("[1] x", ignore), json::ParseError);
+}
+TEST(JsonSax, DefaultHandlerAcceptsEverything){
+    json::SaxHandler ignore;
+    EXPECT_TRUE(json::parse_sax(R"({"a": [1, "b", {"c": null}], "d": false})", ignore));
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "json_parser/json.hpp"
+#include "json_parser/path.hpp"
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const std::string kConfig = R"({"service": "billing-api", "replicas": 3, "limits": {"cpu": 2.5, "memory": "512Mi"},)"
+                            R"( "hosts": ["alpha.internal", "beta.internal", "gamma.internal"]})";
+
+}
+
+TEST(JsonShared, CopiesShareTheNode){
+    const json::JsonValue config = json::parse(kConfig).share();
+    ASSERT_TRUE(config.is_shared());
+    EXPECT_TRUE(config.is_object());
+
+    json::JsonValue copy = config;
+    json::JsonValue assigned;
+    assigned = copy;
+    EXPECT_TRUE(copy.is_shared());
+    EXPECT_TRUE(assigned.is_shared());
+    //the same tree, not a deep copy of it
+    EXPECT_EQ(&std::as_const(copy).as_object(), &config.as_object());
+    EXPECT_EQ(&std::as_const(assigned)["hosts"], &config["hosts"]);
+    EXPECT_EQ(copy.dump(), json::parse(kConfig).dump());
+    //non-const access to a non-const copy is a write as far as it knows
+    (void)copy.as_object();
+    EXPECT_FALSE(copy.is_shared());
+    EXPECT_EQ(config.size(), 4u);
+    EXPECT_EQ(config["limits"]["memory"].as_string(), "512Mi");
+}
+TEST(JsonShared, CopyOnWrite){
+    const json::JsonValue config = json::parse(kConfig).share();
+    json::JsonValue mine = config;
+    mine["replicas"] = 5;
+    mine["hosts"].as_array().emplace_back("delta.internal");
+    EXPECT_FALSE(mine.is_shared());
+    EXPECT_EQ(mine["replicas"].as_int64(), 5);
+    EXPECT_EQ(mine["hosts"].size(), 4u);
+    //the other copies never see it
+    EXPECT_TRUE(config.is_shared());
+    EXPECT_EQ(config["replicas"].as_int64(), 3);
+    EXPECT_EQ(config["hosts"].size(), 3u);
+}
+TEST(JsonShared, LastReferenceTakesTheNodeOver){
+    json::JsonValue v = json::parse("[1, 2, 3]").share();
+    const json::JsonArray* before = &std::as_const(v).as_array();
+    //nobody else holds the node, so writing moves the array out instead of copying it
+    v.as_array().push_back(4);
+    EXPECT_FALSE(v.is_shared());
+    EXPECT_EQ(&v.as_array(), before);
+    EXPECT_EQ(v.dump(), "[1,2,3,4]");
+}
+TEST(JsonShared, WhatGetsShared){
+    EXPECT_FALSE(json::JsonValue(1.5).share().is_shared());
+    EXPECT_FALSE(json::JsonValue(nullptr).share().is_shared());
+    EXPECT_FALSE(json::JsonValue("short").share().is_shared());
+
+    json::JsonValue text = json::JsonValue("a string too long to be small").share();
+    ASSERT_TRUE(text.is_shared());
+    EXPECT_TRUE(text.is_string());
+    EXPECT_EQ(json::JsonValue(text).as_string(), "a string too long to be small");
+
+    //a view is copied into the node, the shared value does not depend on the input
+    std::string input = "a borrowed string, too long to be small";
+    json::JsonValue view = json::JsonValue::borrowed(input);
+    json::JsonValue shared_view = std::move(view).share();
+    ASSERT_TRUE(shared_view.is_shared());
+    input.assign(input.size(), 'x');
+    EXPECT_EQ(shared_view.as_string(), "a borrowed string, too long to be small");
+    EXPECT_FALSE(json::JsonValue::borrowed("short").share().is_shared());
+
+    //const& leaves the original alone, sharing a shared value is a copy of the handle
+    json::JsonValue original = json::parse(kConfig);
+    json::JsonValue shared = original.share();
+    EXPECT_FALSE(original.is_shared());
+    EXPECT_TRUE(shared.is_shared());
+    const json::JsonValue again = shared.share();
+    EXPECT_EQ(&again.as_object(), &std::as_const(shared).as_object());
+
+    //moved from shared values are null like any other
+    json::JsonValue moved = std::move(shared);
+    EXPECT_TRUE(shared.is_null());
+    EXPECT_FALSE(shared.is_shared());
+    EXPECT_TRUE(moved.is_shared());
+}
+TEST(JsonShared, SharedSubtrees){
+    //a shared child stays shared when its parent is copied, or unshared, so only the top is copied
+    json::JsonValue hosts = json::parse(R"(["alpha.internal", "beta.internal"])").share();
+    json::JsonObject obj;
+    obj.insert_or_assign("hosts", hosts);
+    obj.insert_or_assign("replicas", 3);
+    json::JsonValue root = json::JsonValue(std::move(obj)).share();
+
+    json::JsonValue copy = root;
+    copy["replicas"] = 4;
+    EXPECT_TRUE(std::as_const(copy)["hosts"].is_shared());
+    EXPECT_EQ(&std::as_const(copy)["hosts"].as_array(), &std::as_const(hosts).as_array());
+    EXPECT_EQ(root["replicas"].as_int64(), 3);
+}
+TEST(JsonShared, PathWritesUnshare){
+    const json::JsonValue config = json::parse(kConfig).share();
+    json::Path memory("/limits/memory");
+    json::JsonValue mine = config;
+    //const lookups read the shared tree
+    EXPECT_EQ(memory.find(config), &config["limits"]["memory"]);
+    *memory.find(mine) = "1Gi";
+    EXPECT_EQ(mine["limits"]["memory"].as_string(), "1Gi");
+    EXPECT_EQ(config["limits"]["memory"].as_string(), "512Mi");
+}
+TEST(JsonShared, ThreadsCopyAndRead){
+    const json::JsonValue config = json::parse(kConfig).share();
+    const std::string expected = config.dump();
+    std::vector<std::string> dumps(8);
+    std::vector<std::thread> workers;
+    for(std::size_t t = 0; t < dumps.size(); ++t) {
+        workers.emplace_back([&, t] {
+            for(int i = 0; i < 1000; ++i) {
+                json::JsonValue mine = config;
+                if(i % 100 == 0) mine["replicas"] = i;  //copy on write on this thread only
+                (void)std::as_const(mine)["hosts"].size();
+            }
+            dumps[t] = json::JsonValue(config).dump();
+        });
+    }
+    for(auto& w : workers) w.join();
+    for(const auto& d : dumps) EXPECT_EQ(d, expected);
+    EXPECT_EQ(json::from_cbor(config.to_cbor()).dump(), expected);
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "json_parser/json.hpp"
+#include "json_parser/sax.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const json::ParseOptions kIndexed{json::ParseEngine::StructuralIndex};
+
+//the inputs of tests/json_test.cpp (valid and invalid), plus the block boundary cases of this file
+const std::vector<std::string> kCorpus = {
+    "null", "true", "false", "0", "-0", "42", "-17", "-1", "3.14", "1e10", "5e-3", "1e2", "-2.5E+3",
+    "0.1", "0.5", "1.0", "1.5", "3.141592653589793", "1.7976931348623157e308", "5e-324",
+    "9007199254740992", "9007199254740993", "999999999999999", "-123456789012345",
+    "18446744073709551615", "18446744073709551616", "-9223372036854775809",
+    "123456789012345678901234567890", "[0, 42, -17, 1700000000123456789, 9223372036854775807, -9223372036854775808]",
+    "[0,-1,2.5,1e2,12345678901234567]", "\"\"", "\"hello\"", "\"hello\\nworld\"", "\"say\\\"hi\\\"\"",
+    "\"path\\\\to\\\\file\"", "\"\\u0041\"", "\"caf\xC3\xA9 \xE2\x82\xAC and a long enough tail to use the block scanner\"",
+    "[]", "[1,2]", "[1, 2, 3]", "[1, \"two\", true, null]", "[[1,2],[3,4]]", "{}", "{\"a\":1}",
+    "{\"name\": \"Alice\", \"age\": 30}", "{\"person\": {\"name\": \"Bob\"}}", "{\"nums\": [1,2,3]}",
+    R"({"list": [1, "two", {"three": 3}]})", "    {     \"a\"    :  1   }    ",
+    //invalid
+    "", "   ", "+5", "-", "-.5", ".5", "007", "5.", "1e", "1e+", "1e400", "[-1e400]", "123abc", "1\f", "\v1",
+    "undefined", "\"hello", "[1,2", "[1,2,]", "{\"a\": 1", "{\"a\":1,}", "[1 2]", "{\"a\" 1}", "{1:2}",
+    "truex", "nul", "[true false]", "\"a\"b", "[\"a\"\"b\"]", "\"\\x\"", "\"\\u12g4\"", "1 2", "]", "[}",
+    "{\"a\":}", "[,1]", "{,}", "\"\\\"", "\\\"\"",
+};
+
+//same outcome from both engines: both throw, or both build the same value
+void expect_same(const std::string& input) {
+    std::string recursive;
+    std::string indexed;
+    bool recursive_threw = false;
+    bool indexed_threw = false;
+    try {recursive = json::parse(input).dump();} catch(const json::ParseError&) {recursive_threw = true;}
+    try {indexed = json::parse(input, kIndexed).dump();} catch(const json::ParseError&) {indexed_threw = true;}
+    EXPECT_EQ(recursive_threw, indexed_threw) << "input: " << input;
+    EXPECT_EQ(recursive, indexed) << "input: " << input;
+}
+
+}
+
+TEST(JsonStructuralIndex, CorpusMatchesRecursiveEngine){
+    for(const auto& input : kCorpus) {
+        expect_same(input);
+    }
+}
+TEST(JsonStructuralIndex, CorpusInsideArraysMatches){
+    //same cases as elements, so they also show up after and before structural characters
+    for(const auto& input : kCorpus) {
+        expect_same("[" + input + "]");
+        expect_same("{\"k\":" + input + ",\"z\":[" + input + "," + input + "]}");
+    }
+}
+TEST(JsonStructuralIndex, TokensAtEveryBlockOffset){
+    //slide every kind of token across the 64 byte block boundaries
+    std::vector<std::string> tokens = {
+        "\"ab\\\"c\"", "\"\\\\\"", "\"\\\\\\\\\\\"\"", "\"x\\u00e9y\"", "-12.5e3", "true", "null", "{\"k\":[1]}", "[]",
+    };
+    for(const auto& token : tokens) {
+        for(std::size_t pad = 0; pad < 130; ++pad) {
+            std::string input = "[" + std::string(pad, ' ') + token + "," + std::string(pad % 7, '\n') + token + "]";
+            expect_same(input);
+        }
+    }
+}
+TEST(JsonStructuralIndex, BackslashRunsAcrossBlocks){
+    //strings made of backslash runs of every length, starting at every offset - the escape carry
+    for(std::size_t offset = 0; offset < 70; ++offset) {
+        for(std::size_t run = 1; run < 70; ++run) {
+            std::string body(offset, 'a');
+            body.append(run, '\\');
+            if(run % 2) body += '"'; //odd run: the quote is escaped and the string continues
+            body += "tail";
+            expect_same("[\"" + body + "\", 1]");
+        }
+    }
+}
+TEST(JsonStructuralIndex, StructuralCharsInsideStringsAreIgnored){
+    std::string input = R"({"a": "{[:,]}", "b": ["]", "}"], "c\"{": "\\"})";
+    auto value = json::parse(input, kIndexed);
+    EXPECT_EQ(std::string_view(value["a"].as_string()), "{[:,]}");
+    EXPECT_EQ(value["b"].size(), 2u);
+    EXPECT_EQ(std::string_view(value["c\"{"].as_string()), "\\");
+}
+TEST(JsonStructuralIndex, RandomMutationsMatchRecursiveEngine){
+    //flip bytes of a valid document to punctuation / quotes / backslashes; both engines must agree
+    const std::string base =
+        R"({"id": 12345, "name": "caf\u00e9 \"quoted\" \\ path", "tags": ["a", "b\\", "c\"d"], )"
+        R"("nested": {"x": [1.5, -2e-3, true, false, null], "y": {"z": "}{]["}}, "long": ")" +
+        std::string(100, 'q') + R"("})";
+    const char replacements[] = {'"', '\\', '{', '}', '[', ']', ':', ',', ' ', 'a', '1', '-', '.', 'e', 'n'};
+    std::mt19937 rng(1234);
+    for(int i = 0; i < 3000; ++i) {
+        std::string input = base;
+        int flips = 1 + static_cast<int>(rng() % 3);
+        for(int f = 0; f < flips; ++f) {
+            input[rng() % input.size()] = replacements[rng() % sizeof replacements];
+        }
+        expect_same(input);
+    }
+}
+TEST(JsonStructuralIndex, LargeDocumentMatches){
+    std::string input = "[";
+    for(int i = 0; i < 5000; ++i) {
+        if(i) input += ",\n  ";
+        input += R"({"i": )" + std::to_string(i) + R"(, "s": "item \")" + std::to_string(i) + R"(\" \\", "f": )" +
+                 std::to_string(i * 0.25) + R"(, "b": [true, false, null]})";
+    }
+    input += "]";
+    EXPECT_EQ(json::parse(input, kIndexed).dump(), json::parse(input).dump());
+}
+TEST(JsonStructuralIndex, UsesResource){
+    json::Arena arena;
+    auto value = json::parse(R"({"a": ["a string that is too long for sso"]})", arena, kIndexed);
+    EXPECT_EQ(value["a"].as_array().get_allocator().resource(), &arena);
+}
+TEST(JsonStructuralIndex, Sax){
+    struct Counter : json::SaxHandler {
+        int strings = 0;
+        int keys = 0;
+        bool on_string(std::string_view) override {++strings; return true;}
+        bool on_key(std::string_view) override {++keys; return keys < 2;}
+    } counter;
+    EXPECT_FALSE(json::parse_sax(R"({"a": "x", "b": "y", "c": "z"})", counter, kIndexed));
+    EXPECT_EQ(counter.keys, 2);
+    EXPECT_EQ(counter.strings, 1);
+}
+TEST(JsonStructuralIndex, ErrorPositionsMatch){
+    for(std::string input : {"[1, 2, x]", "{\"a\": tru}", "[1,2,]", "\"abc"}) {
+        std::size_t expected = 0;
+        std::size_t actual = 1;
+        try {(void)json::parse(input);} catch(const json::ParseError& e) {expected = e.position();}
+        try {(void)json::parse(input, kIndexed);} catch(const json::ParseError& e) {actual = e.position();}
+        EXPECT_EQ(actual, expected) << input;
+    }
+}
+TEST(JsonStructuralIndex, MaxDepthMatches){
+    json::ParseOptions options = kIndexed;
+    options.max_depth = 2;
+    EXPECT_NO_THROW(json::parse(R"([{"a": 1}, [], {"b": 2}])", options));
+    try {
+        (void)json::parse(R"([{"a": [1]}])", options);
+        FAIL() << "expected ParseError";
+    } catch(const json::ParseError& e) {
+        EXPECT_EQ(e.position(), 7u);
+    }
+    std::size_t limit = json::ParseOptions::kDefaultMaxDepth;
+    expect_same(std::string(limit, '{') + std::string(limit, '}'));
+    expect_same(std::string(limit, '[') + std::string(limit, ']'));
+    expect_same(std::string(limit + 1, '[') + std::string(limit + 1, ']'));
+}
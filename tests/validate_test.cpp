@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "json_parser/validate.hpp"
+#include <string>
+#include <vector>
+
+namespace {
+
+//the position parse() reports for input, or npos when it parses
+std::size_t parse_error_at(const std::string& input) {
+    try {
+        (void)json::parse(input);
+        return std::string::npos;
+    } catch(const json::ParseError& e) {
+        return e.position();
+    }
+}
+
+std::size_t validate_error_at(const std::string& input, const json::ValidationLimits& limits = {}) {
+    try {
+        json::validate(input, limits);
+        return std::string::npos;
+    } catch(const json::ParseError& e) {
+        return e.position();
+    }
+}
+
+}
+
+TEST(JsonValidate, AgreesWithParse){
+    const std::vector<std::string> inputs = {
+        //valid
+        "null", " true ", "false", "0", "-0", "-12.5e+3", "1E40", "18446744073709551616", "\"\"",
+        R"({"a": [1, 2.5, "x\n\u00e9\"", {}, []], "a": null})", "[[[[]]]]", R"({"k":{"k":{"k":[1,{"z":0}]}}})",
+        R"("\/\\\b\f\n\r\t\u0041\uFFFF")", "  [ 1 , 2 ]\n",
+        //grammar errors
+        "", " ", "nul", "tru", "[1,]", "[1 2]", "{\"a\" 1}", "{\"a\":}", "{1:2}", "{\"a\":1,}", "[", "{", "]", "[1]]",
+        "01", "1.", ".5", "-", "+1", "1e", "1e+", "0x1F", "NaN", "\"abc", "\"a\\", "\"\\x\"", "\"\\u12\"", "\"\\u12G4\"",
+        "[1] x", "{\"a\": tru}", "\"unterminated \\\"",
+        //only the conversion fails
+        "1e400", "-1e400", "[0, 1.5e99999]", std::string(400, '9'), "0." + std::string(400, '0') + "1",
+    };
+    for(const std::string& input : inputs) {
+        SCOPED_TRACE(input);
+        EXPECT_EQ(validate_error_at(input), parse_error_at(input));
+        EXPECT_EQ(json::is_valid(input), parse_error_at(input) == std::string::npos);
+    }
+}
+TEST(JsonValidate, SameMessagesAsParse){
+    for(const std::string input : {"[1, 2", "{\"a\": 1e400}", "\"\\q\""}) {
+        std::string parse_what, validate_what;
+        try {(void)json::parse(input);} catch(const json::ParseError& e) {parse_what = e.what();}
+        try {json::validate(input);} catch(const json::ParseError& e) {validate_what = e.what();}
+        EXPECT_FALSE(parse_what.empty());
+        EXPECT_EQ(validate_what, parse_what);
+    }
+}
+TEST(JsonValidate, ControlCharacters){
+    //a raw newline / tab / NUL inside a string is malformed (RFC 8259), as it is for parse()
+    EXPECT_FALSE(json::is_valid("\"a\nb\""));
+    EXPECT_FALSE(json::is_valid("{\"key\twith tab\": 1}"));
+    EXPECT_FALSE(json::is_valid(std::string("[\"nul\0\"]", 7)));
+    EXPECT_TRUE(json::is_valid("{\"a\":\n\t\"b\\n\"}"));
+    for(int c = 0; c < 0x20; ++c) {
+        std::string input = "[\"" + std::string(40, 'x') + "\\\"" + std::string(1, static_cast<char>(c)) + "\"]";
+        SCOPED_TRACE(c);
+        EXPECT_EQ(validate_error_at(input), 44u);
+        EXPECT_EQ(parse_error_at(input), 44u);
+    }
+    std::string what;
+    try {json::validate("\"a\nb\"");} catch(const json::ParseError& e) {what = e.what();}
+    EXPECT_EQ(what, "control character in string at position 2");
+}
+TEST(JsonValidate, Utf8){
+    auto quoted = [](const std::string& bytes) {return "[\"ok\", \"" + bytes + "\"]";};
+    //valid sequences of every length, at the edges of their ranges
+    for(const std::string s : {"\x7F", "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF", "\xEE\x80\x80", "\xEF\xBF\xBF",
+                               "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF", "h\xC3\xA9llo w\xC3\xB6rld \xE2\x82\xAC \xF0\x9F\x98\x80"}) {
+        SCOPED_TRACE(s);
+        EXPECT_TRUE(json::is_valid(quoted(s)));
+    }
+    const std::size_t at = quoted("").size() - 2;
+    for(const std::string s : {"\x80", "\xBF", "\xC0\xAF", "\xC1\xBF", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xED\xBF\xBF",
+                               "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xFF", "\xC3", "\xE2\x82", "\xF0\x9F\x98",
+                               "\xC3\x28", "\xE2\x28\xA1"}) {
+        SCOPED_TRACE(s);
+        std::string input = quoted(s);
+        EXPECT_EQ(validate_error_at(input), at);
+        //parse() takes the bytes as they are
+        EXPECT_EQ(parse_error_at(input), std::string::npos);
+        json::ValidationLimits bytes_only;
+        bytes_only.utf8 = false;
+        EXPECT_TRUE(json::is_valid(input, bytes_only));
+    }
+    //truncated at the very end of the input
+    EXPECT_EQ(validate_error_at("\"\xE2\x82"), 1u);
+}
+TEST(JsonValidate, Utf8EveryOffset){
+    //one bad byte at every position of a long mostly ascii string, so each block kernel and the tail see it
+    const std::string text = std::string(37, 'a') + "\xC3\xA9" + std::string(70, 'b') + "\xF0\x9F\x98\x80" + std::string(20, 'c');
+    ASSERT_TRUE(json::is_valid("\"" + text + "\""));
+    for(std::size_t i = 0; i < text.size(); ++i) {
+        std::string broken = text;
+        broken[i] = '\xFE';
+        std::string input = "\"" + broken + "\"";
+        SCOPED_TRACE(i);
+        //a bad byte in the middle of a sequence makes its lead the first invalid byte
+        std::size_t lead = i;
+        if(i == 38) lead = 37;
+        if(i >= 110 && i < 113) lead = 109;
+        EXPECT_EQ(validate_error_at(input), lead + 1);
+    }
+}
+TEST(JsonValidate, FirstErrorWins){
+    //the utf-8 error comes first
+    EXPECT_EQ(validate_error_at("[\"\xC0\", tru]"), 2u);
+    //the grammar error comes first
+    EXPECT_EQ(validate_error_at("[tru, \"\xC0\"]"), 1u);
+    //a bad byte outside of a string is a grammar error at the same place
+    std::string what;
+    try {json::validate("[\xFF]");} catch(const json::ParseError& e) {what = e.what();}
+    EXPECT_EQ(what, "unexpected character at position 1");
+}
+TEST(JsonValidate, Limits){
+    json::ValidationLimits limits;
+    limits.max_depth = 3;
+    EXPECT_TRUE(json::is_valid("[[[1]]]", limits));
+    EXPECT_EQ(validate_error_at("[[[[1]]]]", limits), 3u);
+    //far past the default: no recursion, so no stack to overflow
+    EXPECT_FALSE(json::is_valid(std::string(100000, '[') + std::string(100000, ']')));
+
+    limits = {};
+    limits.max_bytes = 8;
+    EXPECT_TRUE(json::is_valid("[1,2,3]", limits));
+    EXPECT_EQ(validate_error_at("[1, 2, 3]", limits), 8u);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "json_parser/writer.hpp"
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+const std::string kInput = R"({"name": "line\nbreak \"quoted\"", "ratio": 0.1, "ids": [1, -2, 18446744073709551615],)"
+                           R"( "nested": {"deep": {"deeper": [true, false, null, {}, []]}}, "empty": ""})";
+
+}
+
+TEST(JsonWriter, StringWriterMatchesDump){
+    auto value = json::parse(kInput);
+    for(int indent : {-1, 0, 2, 4}) {
+        std::string out;
+        json::StringWriter writer(out);
+        value.dump_to(writer, indent);
+        writer.flush();
+        EXPECT_EQ(out, value.dump(indent));
+    }
+}
+TEST(JsonWriter, StringWriterAppends){
+    std::string out = "prefix:";
+    {
+        json::StringWriter writer(out);
+        json::parse("[1, 2]").dump_to(writer);
+    }
+    EXPECT_EQ(out, "prefix:[1,2]");
+}
+TEST(JsonWriter, TinyBufferSameOutput){
+    //every token and every indentation run crosses buffer boundaries
+    auto value = json::parse(kInput);
+    for(int indent : {-1, 2, 9}) {
+        std::ostringstream os;
+        json::StreamWriter writer(os, 7);
+        value.dump_to(writer, indent);
+        writer.flush();
+        EXPECT_EQ(os.str(), value.dump(indent));
+    }
+}
+TEST(JsonWriter, CallbackGetsFullBuffers){
+    auto value = json::parse(kInput);
+    std::vector<std::string> chunks;
+    {
+        json::CallbackWriter writer([&](std::string_view s) {chunks.emplace_back(s);}, 16);
+        value.dump_to(writer, 2);
+        EXPECT_TRUE(chunks.size() > 1);
+        //nothing below the buffer size is handed out before the flush
+        for(const auto& chunk : chunks) EXPECT_EQ(chunk.size(), 16u);
+    }
+    std::string joined;
+    for(const auto& chunk : chunks) joined += chunk;
+    EXPECT_EQ(joined, value.dump(2));
+    EXPECT_LE(chunks.back().size(), 16u);
+}
+TEST(JsonWriter, FillAndWriteLongerThanBuffer){
+    std::string out;
+    json::CallbackWriter writer([&](std::string_view s) {out += s;}, 4);
+    writer.fill(' ', 10);
+    writer.write("abcdefghij");
+    writer.put('!');
+    writer.flush();
+    EXPECT_EQ(out, std::string(10, ' ') + "abcdefghij!");
+    //flushing twice hands out nothing new
+    writer.flush();
+    EXPECT_EQ(out.size(), 21u);
+}
+TEST(JsonWriter, FdWriterToPipe){
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    auto value = json::parse(kInput);
+    {
+        json::FdWriter writer(fds[1], 32);
+        value.dump_to(writer);
+    }
+    ::close(fds[1]);
+    std::string read_back;
+    char buf[256];
+    ssize_t n;
+    while((n = ::read(fds[0], buf, sizeof(buf))) > 0) read_back.append(buf, static_cast<std::size_t>(n));
+    ::close(fds[0]);
+    EXPECT_EQ(read_back, value.dump());
+}
+TEST(JsonWriter, WriteErrorsThrowOnFlush){
+    json::FdWriter bad_fd(-1, 8);
+    bad_fd.write("abc");
+    EXPECT_THROW(bad_fd.flush(), std::system_error);
+
+    std::ostringstream os;
+    os.setstate(std::ios_base::badbit);
+    json::StreamWriter bad_stream(os, 8);
+    bad_stream.write("abc");
+    EXPECT_THROW(bad_stream.flush(), std::ios_base::failure);
+}